@@ -14,65 +14,152 @@
 
 #define TAG "UAD Actions"
 
-bool UADRuntime::ExecuteAction(ActionInfo* actionInfo, cb0r_t actionData, ActionEvent* actionEvent)
+template <typename T>
+static void StoreOperands(UADOperands* operands, const T& data)
 {
-    if(actionInfo->depth > 5)
-    {
-        MLOGE(TAG, "Action depth exceeded");
-        return false;
-    }
+    static_assert(sizeof(T) <= UAD_OPERAND_SIZE && std::is_trivially_copyable_v<T>, "Action data does not fit in UADOperands");
+    memcpy(operands->data, &data, sizeof(T));
+}
 
-    cb0r_s action_index;
+template <typename T>
+static T LoadOperands(const UADOperands* operands)
+{
+    T data;
+    memcpy(&data, operands->data, sizeof(T));
+    return data;
+}
 
-    if (!cb0r_get_check_type(actionData, 0, &action_index, CB0R_INT))
+template <typename T>
+static bool DecodeAction(cb0r_t actionData, UADOperands* operands, bool (*loadData)(cb0r_t, T*))
+{
+    T data;
+    if (!loadData(actionData, &data))
     {
-        MLOGE(TAG, "Failed to get action index");
         return false;
     }
+    StoreOperands(operands, data);
+    return true;
+}
 
-    uint32_t action_signature = 0;
+bool UADRuntime::CompileAction(ActionType actionType, cb0r_t actionData, UADActionTable* table)
+{
+    UADOpcode opcode = UADOpcode::NONE;
+    UADOperands operands = {};
 
-    if(actionInfo->actionType == ActionType::ACTION)
+    cb0r_s action_index;
+    bool decoded = false;
+    if (!cb0r_get_check_type(actionData, 0, &action_index, CB0R_INT))
     {
-        action_signature = actionList[action_index.value];
-        MLOGV(TAG, "Executing action - %d", action_signature);
+        MLOGE(TAG, "Failed to get action index");
     }
-    else if(actionInfo->actionType == ActionType::EFFECT)
+    else
     {
-        action_signature = effectList[action_index.value];
-        MLOGV(TAG, "Executing effect - %d", action_signature);
-    }
-
+        vector<uint32_t>& list = actionType == ActionType::ACTION ? actionList : effectList;
+        uint32_t action_signature = action_index.value < list.size() ? list[action_index.value] : 0;
 
-    if(actionEvent->type == ActionEventType::KEYEVENT)
-    {
         switch (action_signature)
         {
             case MidiAction::signature:
-                return MidiAction::KeyEvent(this, actionInfo, actionData, actionEvent->keyInfo);
+                opcode = UADOpcode::MIDI;
+                decoded = DecodeAction(actionData, &operands, MidiAction::LoadData);
+                break;
             case KeyboardAction::signature:
-                return KeyboardAction::KeyEvent(this, actionInfo, actionData, actionEvent->keyInfo);
+                opcode = UADOpcode::KEYBOARD;
+                decoded = DecodeAction(actionData, &operands, KeyboardAction::LoadData);
+                break;
             case GamepadAction::signature:
-                return GamepadAction::KeyEvent(this, actionInfo, actionData, actionEvent->keyInfo);
+                opcode = UADOpcode::GAMEPAD;
+                decoded = DecodeAction(actionData, &operands, GamepadAction::LoadData);
+                break;
             case LayerAction::signature:
-                return LayerAction::KeyEvent(this, actionInfo, actionData, actionEvent->keyInfo);
+                opcode = UADOpcode::LAYER;
+                decoded = DecodeAction(actionData, &operands, LayerAction::LoadData);
+                break;
             case WrapAction::signature:
-                return WrapAction::KeyEvent(this, actionInfo, actionData, actionEvent->keyInfo);
+                opcode = UADOpcode::WRAP;
+                decoded = DecodeAction(actionData, &operands, WrapAction::LoadData);
+                break;
             case ColorEffect::signature:
-                return ColorEffect::KeyEvent(this, actionInfo, actionData, actionEvent->keyInfo);
+                opcode = UADOpcode::COLOR;
+                decoded = DecodeAction(actionData, &operands, ColorEffect::LoadData);
+                break;
             case ActionColorEffect::signature:
-                return ActionColorEffect::KeyEvent(this, actionInfo, actionData, actionEvent->keyInfo);
+            {
+                opcode = UADOpcode::ACTIONCOLOR;
+                ActionColorEffect::ActionColorData data;
+                decoded = ActionColorEffect::LoadData(actionData, &data, &operandPool);
+                StoreOperands(&operands, data);
+                break;
+            }
+            default:
+                MLOGW(TAG, "Unknown action %d", action_index.value);
+                break;
+        }
+    }
+
+    if (!decoded && opcode != UADOpcode::NONE)
+    {
+        MLOGE(TAG, "Failed to load action");
+        opcode = UADOpcode::NONE;
+    }
+    table->opcodes.push_back(opcode);
+    table->operands.push_back(operands);
+    return decoded;
+}
+
+bool UADRuntime::ExecuteAction(ActionInfo* actionInfo, UADOpcode opcode, const UADOperands* operands, ActionEvent* actionEvent)
+{
+    if(actionInfo->depth > 5)
+    {
+        MLOGE(TAG, "Action depth exceeded");
+        return false;
+    }
+
+    MLOGV(TAG, "Executing %s - %d", actionInfo->actionType == ActionType::ACTION ? "action" : "effect", opcode);
+
+    if(actionEvent->type == ActionEventType::KEYEVENT)
+    {
+        switch (opcode)
+        {
+            case UADOpcode::NONE:
+                return false;
+            case UADOpcode::MIDI:
+                return MidiAction::KeyEvent(this, actionInfo, LoadOperands<MidiAction::MidiAction>(operands), actionEvent->keyInfo);
+            case UADOpcode::KEYBOARD:
+                return KeyboardAction::KeyEvent(this, actionInfo, LoadOperands<KeyboardAction::KeyboardAction>(operands), actionEvent->keyInfo);
+            case UADOpcode::GAMEPAD:
+                return GamepadAction::KeyEvent(this, actionInfo, LoadOperands<GamepadAction::GamepadAction>(operands), actionEvent->keyInfo);
+            case UADOpcode::LAYER:
+                return LayerAction::KeyEvent(this, actionInfo, LoadOperands<LayerAction::LayerAction>(operands), actionEvent->keyInfo);
+            case UADOpcode::WRAP:
+                return WrapAction::KeyEvent(this, actionInfo, LoadOperands<WrapAction::WrapAction>(operands), actionEvent->keyInfo);
+            case UADOpcode::COLOR:
+                return ColorEffect::KeyEvent(this, actionInfo, LoadOperands<ColorEffect::ColorEffectData>(operands), actionEvent->keyInfo);
+            case UADOpcode::ACTIONCOLOR:
+                return ActionColorEffect::KeyEvent(this, actionInfo, LoadOperands<ActionColorEffect::ActionColorData>(operands), actionEvent->keyInfo);
         }
     }
     else if(actionEvent->type == ActionEventType::INITIALIZATION)
     {
-        switch (action_signature)
+        switch (opcode)
         {
-            case ColorEffect::signature:
-                return ColorEffect::Initialization(this, actionInfo, actionData);
-            case ActionColorEffect::signature:
-                return ActionColorEffect::Initialization(this, actionInfo, actionData);
+            case UADOpcode::COLOR:
+                return ColorEffect::Initialization(this, actionInfo, LoadOperands<ColorEffect::ColorEffectData>(operands));
+            case UADOpcode::ACTIONCOLOR:
+                return ActionColorEffect::Initialization(this, actionInfo, LoadOperands<ActionColorEffect::ActionColorData>(operands));
+            default:
+                break;
+        }
+    }
+    else if(actionEvent->type == ActionEventType::UPDATE)
+    {
+        switch (opcode)
+        {
+            case UADOpcode::ACTIONCOLOR:
+                return ActionColorEffect::Update(this, actionInfo, LoadOperands<ActionColorEffect::ActionColorData>(operands));
+            default:
+                break;
         }
     }
     return false;
-}
\ No newline at end of file
+}
@@ -6,19 +6,38 @@ namespace ActionColorEffect
 
   constexpr uint32_t signature = StaticHash("actioncolor");
 
-  static bool KeyEvent(UADRuntime* uadRT, ActionInfo* actionInfo, cb0r_t actionData, KeyInfo* keyInfo) {
-    if (keyInfo->State() != KeyState::PRESSED && keyInfo->State() != KeyState::RELEASED)
-    {
-      return false;
-    }
+  struct ActionColorData {
+    uint16_t enabled; // Bitmap of the group register values that have a color
+    uint8_t colorCount;
+    uint16_t colors;  // First color in the operand pool, one for each bit set in enabled
+  };
 
+  static bool LoadData(cb0r_t actionData, ActionColorData* data, vector<uint32_t>* pool) {
     cb0r_s cbor_data;
     if (!cb0r_get_check_type(actionData, 1, &cbor_data, CB0R_INT))
     {
       MLOGE(TAG, "Failed to get enabled bitmap");
       return false;
     }
-    
+    data->enabled = cbor_data.value;
+    data->colorCount = 0;
+    data->colors = pool->size();
+
+    for (size_t i = 2; i < actionData->length && data->colorCount < 16; i++)
+    {
+      if (!cb0r_next_check_type(actionData, &cbor_data, &cbor_data, CB0R_INT))
+      {
+        MLOGE(TAG, "Failed to get color");
+        return false;
+      }
+      pool->push_back(cbor_data.value);
+      data->colorCount++;
+    }
+    return true;
+  }
+
+  // Shows the color for the current value of the group register
+  static bool Update(UADRuntime* uadRT, ActionInfo* actionInfo, const ActionColorData& data) {
     ActionInfo groupActionInfo = *actionInfo;
     groupActionInfo.index = 255;
 
@@ -28,21 +47,15 @@ namespace ActionColorEffect
 
     groupRegister &= 0x0F;
 
-    int8_t index = UADRuntime::IndexInBitmap(cbor_data.value, groupRegister);
+    int8_t index = UADRuntime::IndexInBitmap(data.enabled, groupRegister);
 
-    if (index == -1)
+    if (index == -1 || index > data.colorCount)
     {
       return false;
     }
     else
     {
-      Color color;
-      if (!cb0r_get_check_type(actionData, index + 1, &cbor_data, CB0R_INT))
-      {
-        MLOGE(TAG, "Failed to get color");
-        return false;
-      }
-      color = Color(cbor_data.value);
+      Color color = Color(uadRT->GetOperandPool(data.colors)[index - 1]);
       if (actionInfo->indexType == ActionIndexType::COORD)
       {
         MatrixOS::LED::SetColor(actionInfo->coord, color, 0);
@@ -55,32 +68,18 @@ namespace ActionColorEffect
     }
   }
 
-  static bool Initialization(UADRuntime* uadRT, ActionInfo* actionInfo, cb0r_t actionData) {
-    cb0r_s cbor_data;
-    if (!cb0r_get_check_type(actionData, 1, &cbor_data, CB0R_INT))
+  static bool KeyEvent(UADRuntime* uadRT, ActionInfo* actionInfo, const ActionColorData& data, KeyInfo* keyInfo) {
+    if (keyInfo->State() != KeyState::PRESSED && keyInfo->State() != KeyState::RELEASED)
     {
-      MLOGE(TAG, "Failed to get enabled bitmap");
       return false;
     }
-    
+    return Update(uadRT, actionInfo, data);
+  }
 
-    if (IsBitSet(cbor_data.value, 0))
+  static bool Initialization(UADRuntime* uadRT, ActionInfo* actionInfo, const ActionColorData& data) {
+    if (IsBitSet(data.enabled, 0) && data.colorCount > 0)
     {
-      Color color;
-      if (!cb0r_get_check_type(actionData, 2, &cbor_data, CB0R_INT))
-      {
-        MLOGE(TAG, "Failed to get color");
-        return false;
-      }
-      color = Color(cbor_data.value);
-      if (actionInfo->indexType == ActionIndexType::COORD)
-      {
-        MatrixOS::LED::SetColor(actionInfo->coord, color, 0);
-      }
-      else if (actionInfo->indexType == ActionIndexType::ID)
-      {
-        MatrixOS::LED::SetColor(actionInfo->id, color, 0);
-      }
+      uadRT->SetEffectColor(actionInfo, Color(uadRT->GetOperandPool(data.colors)[0]));
     }
     return true;
   }
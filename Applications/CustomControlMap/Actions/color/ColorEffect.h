@@ -53,18 +53,10 @@ namespace ColorEffect
     return true;
   }
 
-  static bool KeyEvent(UADRuntime* uadRT, ActionInfo* actionInfo, cb0r_t actionData, KeyInfo* keyInfo) {
+  static bool KeyEvent(UADRuntime* uadRT, ActionInfo* actionInfo, const ColorEffectData& data, KeyInfo* keyInfo) {
     if (keyInfo->State() != KeyState::PRESSED && keyInfo->State() != KeyState::RELEASED)
       return false;
 
-    struct ColorEffectData data;
-
-    if (!LoadData(actionData, &data))
-    {
-      MLOGE(TAG, "Failed to load data");
-      return false;
-    }
-
     // if(data.hasActivated == false)
     // {
     //     return true;
@@ -97,25 +89,10 @@ namespace ColorEffect
     return false;
   }
 
-  static bool Initialization(UADRuntime* uadRT, ActionInfo* actionInfo, cb0r_t actionData) {
-    struct ColorEffectData data;
-
-    if (!LoadData(actionData, &data))
-    {
-      MLOGE(TAG, "Failed to load data");
-      return false;
-    }
-
+  static bool Initialization(UADRuntime* uadRT, ActionInfo* actionInfo, const ColorEffectData& data) {
     // if(data.hasDefault)
     // {
-    if (actionInfo->indexType == ActionIndexType::COORD)
-    {
-      MatrixOS::LED::SetColor(actionInfo->coord, Color(data.defaultColor), 0);
-    }
-    else if (actionInfo->indexType == ActionIndexType::ID)
-    {
-      MatrixOS::LED::SetColor(actionInfo->id, Color(data.defaultColor), 0);
-    }
+    uadRT->SetEffectColor(actionInfo, Color(data.defaultColor));
     // }
 
     return true;
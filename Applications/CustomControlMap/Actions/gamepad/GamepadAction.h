@@ -126,19 +126,11 @@ namespace GamepadAction
     return true;
   }
 
-  static bool KeyEvent(UADRuntime* uadRT, ActionInfo* actionInfo, cb0r_t actionData, KeyInfo* keyInfo) {
+  static bool KeyEvent(UADRuntime* uadRT, ActionInfo* actionInfo, const GamepadAction& data, KeyInfo* keyInfo) {
     MLOGV(TAG, "KeyEvent");
     if (keyInfo->State() != KeyState::PRESSED && keyInfo->State() != KeyState::RELEASED && keyInfo->State() != KeyState::AFTERTOUCH)
       return false;
 
-    struct GamepadAction data;
-
-    if (!LoadData(actionData, &data))
-    {
-      MLOGE(TAG, "Failed to load action");
-      return false;
-    }
-
     if(data.source != AnalogSource::KeyForce && keyInfo->State() == KeyState::AFTERTOUCH)
     {
       return false;
@@ -34,19 +34,11 @@ namespace KeyboardAction
     }
     
 
-    static bool KeyEvent(UADRuntime* uadRT, ActionInfo* actionInfo, cb0r_t actionData, KeyInfo* keyInfo)
+    static bool KeyEvent(UADRuntime* uadRT, ActionInfo* actionInfo, const KeyboardAction& action, KeyInfo* keyInfo)
     {
         MLOGV(TAG, "KeyEvent");
         if(keyInfo->State() != KeyState::PRESSED && keyInfo->State() != KeyState::RELEASED) return false;
 
-        struct KeyboardAction action;
-
-        if(!LoadData(actionData, &action))
-        {
-            MLOGE(TAG, "Failed to load action");
-            return false;
-        }
-
         uint8_t keycode = action.key;
 
         if(action.key == 0)
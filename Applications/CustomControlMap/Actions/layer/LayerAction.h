@@ -54,17 +54,10 @@ namespace LayerAction
     }
     
 
-    static bool KeyEvent(UADRuntime* uadRT, ActionInfo* actionInfo, cb0r_t actionData, KeyInfo* keyInfo)
+    static bool KeyEvent(UADRuntime* uadRT, ActionInfo* actionInfo, const LayerAction& data, KeyInfo* keyInfo)
     {
         if(keyInfo->State() != KeyState::PRESSED && keyInfo->State() != KeyState::RELEASED) return false;
 
-        struct LayerAction data;
-        if(!LoadData(actionData, &data))
-        {
-            MLOGE(TAG, "Failed to load action");
-            return false;
-        }
-
         // Process Layer Action
         int8_t targetLayer = data.layer;
         if(data.relative)
@@ -141,9 +134,7 @@ namespace LayerAction
             else if(data.option == LayerActionOption::TOGGLE)
             {   
                 // Load Toggle State from register
-                uint32_t registerValue;
-                uadRT->GetRegister(actionInfo, &registerValue);
-                targetLayerState = !(bool)registerValue;
+                targetLayerState = uadRT->RegisterCompare(actionInfo, UADRuntime::EQUAL, 0);
             }
             else
             {
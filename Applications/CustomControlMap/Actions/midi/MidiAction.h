@@ -14,7 +14,7 @@ namespace MidiAction
     Invalid = 0xFF
   };
 
-  enum class MidiType {
+  enum class MidiType : uint8_t {
     Note = 0x90,
     ControlChange = 0xB0,
     ProgramChange = 0xC0,
@@ -202,19 +202,12 @@ namespace MidiAction
       return true;
   }
 
-  static bool KeyEvent(UADRuntime* uadRT, ActionInfo* actionInfo, cb0r_t actionData, KeyInfo* keyInfo) {
+  static bool KeyEvent(UADRuntime* uadRT, ActionInfo* actionInfo, const MidiAction& data, KeyInfo* keyInfo) {
     if (keyInfo->State() != PRESSED && keyInfo->State() != RELEASED && keyInfo->State() != AFTERTOUCH)
     {
       return false;
     }
 
-    MidiAction data;
-    if (!LoadData(actionData, &data))
-    {
-      MLOGE(TAG, "Failed to load action");
-      return false;
-    }
-
     uint16_t output_value = 0;
     switch (data.source)
     {
@@ -257,13 +250,8 @@ namespace MidiAction
         groupActionInfo.actionType = ActionType::EFFECT;
         if (keyInfo->State() == PRESSED)
         {
-          uint32_t registerValue;
-          if(!uadRT->GetRegister(actionInfo, &registerValue))
-          {
-            MLOGD(TAG, "Failed to get register. Creating new register");
-          }
+          uint32_t registerValue = uadRT->RegisterToggle(actionInfo);
           MLOGD(TAG, "Register Value: %d", registerValue);
-          registerValue ^= 1;
           if(registerValue & 1)
           {
             MLOGD(TAG, "Toggled On");
@@ -274,15 +262,11 @@ namespace MidiAction
             MLOGD(TAG, "Toggled Off");
             output_value = data.begin;
           }
-          if(!uadRT->SetRegister(actionInfo, registerValue))
-          {
-            MLOGE(TAG, "Failed to set register");
-          }
 
           uint32_t groupRegister;
           if(!uadRT->GetRegister(&groupActionInfo, &groupRegister))
           {
-            MLOGD(TAG, "Failed to get group register. Creating new group register");
+            MLOGE(TAG, "Failed to get group register");
           }
           groupRegister = (groupRegister & 0xFFFFFFF0) + (registerValue & 1); // We use the lower 4 bits for the group register as the LED index for the action driven LED
           if(!uadRT->SetRegister(&groupActionInfo, groupRegister))
@@ -76,15 +76,8 @@ namespace WrapAction
         return true;
     }
 
-    static bool KeyEvent(UADRuntime* uadRT, ActionInfo* actionInfo, cb0r_t actionData, KeyInfo* keyInfo)
+    static bool KeyEvent(UADRuntime* uadRT, ActionInfo* actionInfo, const WrapAction& data, KeyInfo* keyInfo)
     {
-        WrapAction data;
-        if(!LoadData(actionData, &data))
-        {
-            MLOGE(TAG, "Failed to load action");
-            return false;
-        }
-        
 
         // If index type is via ID. Only different layer of same ID is supported! No relative position!
         if(actionInfo->indexType == ActionIndexType::ID && data.relativePos == true && data.x == 0 && data.y == 0)
@@ -10,6 +10,7 @@ void CustomControlMap::Loop() {
   while (MatrixOS::KeyPad::Get(&keyEvent))
   { KeyEventHandler(keyEvent); }
 
+  uadRT.Render();
   HIDReportHandler();
 }
 
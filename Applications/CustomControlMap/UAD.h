@@ -6,6 +6,34 @@
 #include "Action.h"
 
 #define UAD_VERSION 0
+#define UAD_OPERAND_SIZE 16 // Bytes of decoded data each action gets, every action data struct has to fit
+
+// Action signatures resolved at load
+enum class UADOpcode : uint8_t
+{
+  NONE, // Unknown or malformed, does nothing. Kept so the other actions keep their index
+  MIDI,
+  KEYBOARD,
+  GAMEPAD,
+  LAYER,
+  WRAP,
+  COLOR,
+  ACTIONCOLOR,
+};
+
+struct UADOperands
+{
+  alignas(void*) uint8_t data[UAD_OPERAND_SIZE];
+};
+
+// Compiled actions or effects. Every list (one per key and layer) is a range of the flat opcode and operand arrays
+struct UADActionTable
+{
+  vector<UADOpcode> opcodes;
+  vector<UADOperands> operands;
+  vector<uint16_t> listStart;
+  vector<uint8_t> listLength;
+};
 
 // Universal Action Descriptor
 class UADRuntime
@@ -16,7 +44,6 @@ class UADRuntime
 
   UADRuntime();
   UADRuntime(uint8_t* uad, size_t size);
-  ~UADRuntime();
 
   bool LoadUAD(uint8_t* uad, size_t size);
   void UnloadUAD();
@@ -36,22 +63,35 @@ class UADRuntime
 
   bool ExecuteActions(ActionInfo* actionInfo, ActionEvent* actionEvent); //WIll pick a layer and index for Action
   bool ExecuteEffects(ActionInfo* effectInfo, ActionEvent* effectEvent); //WIll pick a layer and index for Effect
-  bool ExecuteAction(ActionInfo* actionInfo, cb0r_t actionData, ActionEvent* actionEvent); //Not intended for direct use
-  // bool GetActionsFromOffset(uint16_t offset, cb0r_t result);
-  void InitializeLayer(uint8_t layer = 255); // 255 means top layer
+  bool ExecuteAction(ActionInfo* actionInfo, UADOpcode opcode, const UADOperands* operands, ActionEvent* actionEvent); //Not intended for direct use
+  void InitializeLayer(uint8_t layer = 255); // 255 means top layer. Shows the layer's effects, drawing its cache first if needed
   void DeinitializeLayer(uint8_t layer = 255);
+  void ExecuteLayerEffects(uint8_t layer, ActionEvent* effectEvent); // Every effect of the layer, for INITIALIZATION and DEINITIALIZATION
+  void Render(); // Call every loop. Redraws the top layer's effects whose registers changed, nothing otherwise
+  void SetEffectColor(ActionInfo* effectInfo, Color color); // For effect INITIALIZATION, draws into the layer's cache
 
   // Action API
+  // Every action and effect has a register, and every key on every layer has a group register (index 255) its actions and effects share.
+  // They get slots in a flat array at load, so none of these allocate. Registers start at 0
+  static const uint16_t INVALID_REGISTER = UINT16_MAX;
+  enum CompareType { EQUAL, NOT_EQUAL, LESS, LESS_EQUAL, GREATER, GREATER_EQUAL };
+  uint16_t RegisterSlot(ActionInfo* actionInfo);
   bool SetRegister(ActionInfo* actionInfo, uint32_t value);
   bool GetRegister(ActionInfo* actionInfo, uint32_t* value);
   bool ClearRegister(ActionInfo* actionInfo);
+  uint32_t RegisterAdd(ActionInfo* actionInfo, int32_t delta); // These return the new value
+  uint32_t RegisterToggle(ActionInfo* actionInfo, uint32_t bits = 1);
+  uint32_t RegisterClamp(ActionInfo* actionInfo, uint32_t min, uint32_t max);
+  bool RegisterCompare(ActionInfo* actionInfo, CompareType type, uint32_t operand); // Register <type> operand, for the action to branch on
   enum LayerInfoType { ACTIVE, PASSTHROUGH };
   void SetLayerState(uint8_t layer, LayerInfoType type, bool state);
   bool GetLayerState(uint8_t layer, LayerInfoType type);
 
   // Helpers
   static int8_t IndexInBitmap(uint64_t bitmap, uint8_t index);  // Note this one has +1 offset (Because usually used in array index look up)
+  static int8_t IndexInBitmapReference(uint64_t bitmap, uint8_t index); // Bit by bit, to check IndexInBitmap against
   uint8_t GetTopLayer();
+  const uint32_t* GetOperandPool(uint16_t offset) { return operandPool.data() + offset; }
 
   bool loaded = false;
   Dimension mapSize;
@@ -64,19 +104,40 @@ class UADRuntime
   private:
   vector<uint32_t> actionList;
   vector<uint32_t> effectList;
-  uint16_t** actionLUT;
-  uint16_t* effectLUT;
 
-  std::map<uint32_t, uint32_t> registers;
+  // The UAD compiled at load, so key events don't parse any CBOR
+  UADActionTable actions; // Lists in x, y, layer order
+  UADActionTable effects; // Lists in layer, x, y order
+  vector<uint16_t> actionLayers; // Per key, bitmap of the layers that have an action list
+  vector<uint32_t> operandPool;  // Operands that don't fit in UADOperands, like action colors
+
+  vector<uint32_t> registers; // Action registers, then effect registers, then group registers in effect list order
+  void WriteRegister(uint16_t slot, uint32_t value);
+
+  // Effect rendering - Each layer's INITIALIZATION pass is drawn once into its cache and copied out when the layer is shown.
+  // Effects driven by a group register are marked dirty when it changes and redrawn by Render
+  vector<Color> layerCache;    // One color per key, in effect list order
+  vector<uint8_t> effectDirty;
+  uint16_t layerCached = 0;    // Layers whose cache is drawn
+  uint16_t layerDirty = 0;     // Layers with dirty effects
+  void RenderLayerCache(uint8_t layer);
+  void UpdateEffects(uint8_t layer, bool dirtyOnly);
+  void RegisterChanged(uint16_t slot);
 
   // UAD Loader
   bool CheckVersion(cb0r_t uadMap);
   bool LoadActionList(cb0r_t uadMap);
   bool LoadEffectList(cb0r_t uadMap);
   bool CreateHashList(cb0r_t cborArray, vector<uint32_t>* list); // Used to generate hash for action names
-  bool CreateActionLUT(cb0r_t actionMatrix, uint16_t*** lut, Dimension lutSize);
-  bool CreateEffectLUT(cb0r_t effectMatrix, uint16_t** lut, uint8_t lutSize);
+  bool CompileActions(cb0r_t actionMatrix);
+  bool CompileEffects(cb0r_t effectMatrix);
+  bool CompileActionList(ActionType actionType, cb0r_t actionArray, UADActionTable* table, uint16_t list);
+  bool CompileAction(ActionType actionType, cb0r_t actionData, UADActionTable* table); // Resolves and decodes one action
   bool LoadDevice(cb0r_t uadMap);
+  bool CreateRegisters();
+
+  uint16_t ActionListIndex(uint8_t x, uint8_t y, uint8_t layer) { return (x * mapSize.y + y) * layerCount + layer; }
+  uint16_t EffectListIndex(uint8_t layer, uint8_t x, uint8_t y) { return (layer * mapSize.x + x) * mapSize.y + y; }
 };
 
 #define IsBitSet(byte, bit) ((byte & (1 << bit)) != 0)
\ No newline at end of file
@@ -1,28 +1,112 @@
 #include "UAD.h"
+#include <algorithm>
+
+uint16_t UADRuntime::RegisterSlot(ActionInfo* actionInfo)
+{
+    if (registers.empty() || actionInfo->indexType != ActionIndexType::COORD)
+    {
+        return INVALID_REGISTER;
+    }
+
+    Point xy = actionInfo->coord;
+    if (actionInfo->layer >= layerCount || xy.x < 0 || xy.y < 0 || xy.x >= mapSize.x || xy.y >= mapSize.y)
+    {
+        return INVALID_REGISTER;
+    }
+
+    uint16_t groupList = EffectListIndex(actionInfo->layer, xy.x, xy.y);
+    if (actionInfo->index == 255)
+    {
+        return actions.opcodes.size() + effects.opcodes.size() + groupList;
+    }
+
+    if (actionInfo->actionType == ActionType::ACTION)
+    {
+        uint16_t list = ActionListIndex(xy.x, xy.y, actionInfo->layer);
+        if (actionInfo->index >= actions.listLength[list]) return INVALID_REGISTER;
+        return actions.listStart[list] + actionInfo->index;
+    }
+
+    if (actionInfo->index >= effects.listLength[groupList]) return INVALID_REGISTER;
+    return actions.opcodes.size() + effects.listStart[groupList] + actionInfo->index;
+}
+
+void UADRuntime::WriteRegister(uint16_t slot, uint32_t value)
+{
+    if (registers[slot] == value)
+    {
+        return;
+    }
+    registers[slot] = value;
+    RegisterChanged(slot);
+}
 
 bool UADRuntime::SetRegister(ActionInfo* actionInfo, uint32_t value)
 {
-    return registers.insert_or_assign(actionInfo->Hash(), value).second;
+    uint16_t slot = RegisterSlot(actionInfo);
+    if (slot == INVALID_REGISTER)
+    {
+        return false;
+    }
+    WriteRegister(slot, value);
+    return true;
 }
 
 bool UADRuntime::GetRegister(ActionInfo* actionInfo, uint32_t* value)
 {   
-    std::map<uint32_t, uint32_t>::iterator it = registers.find(actionInfo->Hash());
-
-    if(it == registers.end())
+    uint16_t slot = RegisterSlot(actionInfo);
+    if (slot == INVALID_REGISTER)
     {
-        SetRegister(actionInfo, 0);
         *value = 0;
         return false;
     }
-
-    *value = it->second;
+    *value = registers[slot];
     return true;
 }
 
 bool UADRuntime::ClearRegister(ActionInfo* actionInfo)
 {
-    return registers.erase(actionInfo->Hash()) > 0;
+    return SetRegister(actionInfo, 0);
+}
+
+uint32_t UADRuntime::RegisterAdd(ActionInfo* actionInfo, int32_t delta)
+{
+    uint16_t slot = RegisterSlot(actionInfo);
+    if (slot == INVALID_REGISTER) return 0;
+    WriteRegister(slot, registers[slot] + delta);
+    return registers[slot];
+}
+
+uint32_t UADRuntime::RegisterToggle(ActionInfo* actionInfo, uint32_t bits)
+{
+    uint16_t slot = RegisterSlot(actionInfo);
+    if (slot == INVALID_REGISTER) return 0;
+    WriteRegister(slot, registers[slot] ^ bits);
+    return registers[slot];
+}
+
+uint32_t UADRuntime::RegisterClamp(ActionInfo* actionInfo, uint32_t min, uint32_t max)
+{
+    uint16_t slot = RegisterSlot(actionInfo);
+    if (slot == INVALID_REGISTER) return 0;
+    WriteRegister(slot, std::clamp(registers[slot], min, max));
+    return registers[slot];
+}
+
+bool UADRuntime::RegisterCompare(ActionInfo* actionInfo, CompareType type, uint32_t operand)
+{
+    uint32_t value;
+    GetRegister(actionInfo, &value);
+    switch (type)
+    {
+        case EQUAL: return value == operand;
+        case NOT_EQUAL: return value != operand;
+        case LESS: return value < operand;
+        case LESS_EQUAL: return value <= operand;
+        case GREATER: return value > operand;
+        case GREATER_EQUAL: return value >= operand;
+    }
+    return false;
 }
 
   void UADRuntime::SetLayerState(uint8_t layer, LayerInfoType type, bool state)
@@ -8,23 +8,6 @@ UADRuntime::UADRuntime(uint8_t* uad, size_t size) {
   LoadUAD(uad, size);
 }
 
-UADRuntime::~UADRuntime() {
-  // Free LUTs
-  if (actionLUT != NULL)
-  {
-    for (uint16_t x = 0; x < mapSize.x; x++)
-    {
-      free(actionLUT[x]);
-    }
-    free(actionLUT);
-  }
-
-  if (effectLUT != NULL)
-  {
-    free(effectLUT);
-  }
-}
-
 bool UADRuntime::CheckVersion(cb0r_t uadMap) {
   cb0r_s uad_section;
 
@@ -85,7 +68,35 @@ bool UADRuntime::CreateHashList(cb0r_t cborArray, vector<uint32_t>* list) {
   return true;
 }
 
-bool UADRuntime::CreateActionLUT(cb0r_t actionMatrix, uint16_t*** lut, Dimension lutSize) {
+bool UADRuntime::CompileActionList(ActionType actionType, cb0r_t actionArray, UADActionTable* table, uint16_t list) {
+  if (actionArray->length > UINT8_MAX || table->opcodes.size() + actionArray->length > UINT16_MAX)
+  {
+    MLOGE(TAG, "Too many actions\n");
+    return false;
+  }
+
+  table->listStart[list] = table->opcodes.size();
+  table->listLength[list] = actionArray->length;
+
+  cb0r_s actionData = *actionArray;
+  for (uint8_t action_index = 0; action_index < actionArray->length; action_index++)
+  {
+    if (!cb0r_next_check_type(actionArray, &actionData, &actionData, CB0R_ARRAY))
+    {
+      MLOGE(TAG, "Failed to get action %d from action list\n", action_index);
+      return false;
+    }
+    CompileAction(actionType, &actionData, table);
+  }
+  return true;
+}
+
+bool UADRuntime::CompileActions(cb0r_t actionMatrix) {
+  uint16_t lists = mapSize.x * mapSize.y * layerCount;
+  actions.listStart.assign(lists, 0);
+  actions.listLength.assign(lists, 0);
+  actionLayers.assign(mapSize.x * mapSize.y, 0);
+
   cb0r_s x_bitmap;
   if(!cb0r_get_check_type(actionMatrix, 0, &x_bitmap, CB0R_INT))
   {
@@ -93,19 +104,10 @@ bool UADRuntime::CreateActionLUT(cb0r_t actionMatrix, uint16_t*** lut, Dimension
     return false;
   }
 
-  *lut = (uint16_t**)pvPortMalloc(lutSize.x * sizeof(uint16_t*));
-
   // Layer 1
   cb0r_s y_array = x_bitmap;
-  for (uint8_t x = 0; x < lutSize.x; x++)
+  for (uint8_t x = 0; x < mapSize.x; x++)
   {
-    (*lut)[x] = (uint16_t*)pvPortMalloc(lutSize.y * sizeof(uint16_t*));
-
-    for (uint8_t y = 0; y < lutSize.y; y++)
-    {
-      (*lut)[x][y] = 0;
-    }
-
     if(!IsBitSet(x_bitmap.value, x))
     {
       continue;
@@ -126,7 +128,7 @@ bool UADRuntime::CreateActionLUT(cb0r_t actionMatrix, uint16_t*** lut, Dimension
 
     // Layer 2
     cb0r_s layer_array = y_bitmap;
-    for (uint8_t y = 0; y < lutSize.y; y++)
+    for (uint8_t y = 0; y < mapSize.y; y++)
     {
       if(!IsBitSet(y_bitmap.value, y))
       {
@@ -139,20 +141,44 @@ bool UADRuntime::CreateActionLUT(cb0r_t actionMatrix, uint16_t*** lut, Dimension
         return false;
       }
 
-      uint32_t offset = layer_array.start - uad;
-      if (offset > UINT16_MAX)
+      cb0r_s layer_bitmap;
+      if (!cb0r_get_check_type(&layer_array, 0, &layer_bitmap, CB0R_INT))
       {
-        MLOGE(TAG, "Action Y Offset is too large\n");
+        MLOGE(TAG, "Failed to get Action Layer Bitmap\n");
         return false;
       }
+      actionLayers[x * mapSize.y + y] = layer_bitmap.value & ((1 << layerCount) - 1);
 
-      (*lut)[x][y] = (uint16_t)offset;
+      // Layer 3 - Action lists are stored from the bottom layer up
+      cb0r_s action_array = layer_bitmap;
+      for (uint8_t layer = 0; layer < layerCount; layer++)
+      {
+        if (!IsBitSet(layer_bitmap.value, layer))
+        {
+          continue;
+        }
+
+        if (!cb0r_next_check_type(&layer_array, &action_array, &action_array, CB0R_ARRAY))
+        {
+          MLOGE(TAG, "Failed to get Action Array\n");
+          return false;
+        }
+
+        if (!CompileActionList(ActionType::ACTION, &action_array, &actions, ActionListIndex(x, y, layer)))
+        {
+          return false;
+        }
+      }
     }
   }
   return true;
 }
 
-bool UADRuntime::CreateEffectLUT(cb0r_t effectMatrix, uint16_t** lut, uint8_t lutSize) {
+bool UADRuntime::CompileEffects(cb0r_t effectMatrix) {
+  uint16_t lists = layerCount * mapSize.x * mapSize.y;
+  effects.listStart.assign(lists, 0);
+  effects.listLength.assign(lists, 0);
+
   cb0r_s layer_bitmap;
   if (!cb0r_get_check_type(effectMatrix, 0, &layer_bitmap, CB0R_INT))
   {
@@ -160,15 +186,12 @@ bool UADRuntime::CreateEffectLUT(cb0r_t effectMatrix, uint16_t** lut, uint8_t lu
     return false;
   }
 
-  *lut = (uint16_t*)pvPortMalloc(lutSize * sizeof(uint16_t));
-
   // Layer List
   cb0r_s x_array = layer_bitmap;
-  for (uint8_t layer = 0; layer < lutSize; layer++)
+  for (uint8_t layer = 0; layer < layerCount; layer++)
   {
     if (!IsBitSet(layer_bitmap.value, layer))
     {
-      (*lut)[layer] = 0;
       continue;
     }
 
@@ -178,14 +201,54 @@ bool UADRuntime::CreateEffectLUT(cb0r_t effectMatrix, uint16_t** lut, uint8_t lu
       return false;
     }
 
-    uint32_t offset = x_array.start - uad;
-    if (offset > UINT16_MAX)
+    cb0r_s x_bitmap;
+    if (!cb0r_get_check_type(&x_array, 0, &x_bitmap, CB0R_INT))
     {
-      MLOGE(TAG, "Effect X Offset is too large\n");
+      MLOGE(TAG, "Failed to get Effect X Bitmap\n");
       return false;
     }
 
-    (*lut)[layer] = (uint16_t)offset;
+    cb0r_s y_array = x_bitmap;
+    for (uint8_t x = 0; x < mapSize.x; x++)
+    {
+      if (!IsBitSet(x_bitmap.value, x))
+      {
+        continue;
+      }
+
+      if (!cb0r_next_check_type(&x_array, &y_array, &y_array, CB0R_ARRAY))
+      {
+        MLOGE(TAG, "Failed to get Effect Y Array\n");
+        return false;
+      }
+
+      cb0r_s y_bitmap;
+      if (!cb0r_get_check_type(&y_array, 0, &y_bitmap, CB0R_INT))
+      {
+        MLOGE(TAG, "Failed to get Effect Y Bitmap\n");
+        return false;
+      }
+
+      cb0r_s effect_array = y_bitmap;
+      for (uint8_t y = 0; y < mapSize.y; y++)
+      {
+        if (!IsBitSet(y_bitmap.value, y))
+        {
+          continue;
+        }
+
+        if (!cb0r_next_check_type(&y_array, &effect_array, &effect_array, CB0R_ARRAY))
+        {
+          MLOGE(TAG, "Failed to get Effect Array\n");
+          return false;
+        }
+
+        if (!CompileActionList(ActionType::EFFECT, &effect_array, &effects, EffectListIndex(layer, x, y)))
+        {
+          return false;
+        }
+      }
+    }
   }
   return true;
 }
@@ -272,6 +335,12 @@ bool UADRuntime::LoadDevice(cb0r_t uadMap) {
     }
   }
 
+  if (mapSize.x <= 0 || mapSize.y <= 0 || mapSize.x > 32 || mapSize.y > 32)
+  {
+    MLOGE(TAG, "Unsupported Device Size");
+    return false;
+  }
+
   // Get Layer Count
   if (!cb0r_find(&device, CB0R_UTF8, 6, (uint8_t*)"layers", &device_data) || device_data.type != CB0R_INT)
   {
@@ -279,6 +348,11 @@ bool UADRuntime::LoadDevice(cb0r_t uadMap) {
     return false;
   }
   layerCount = device_data.value;
+  if (layerCount == 0 || layerCount > 16)
+  {
+    MLOGE(TAG, "Unsupported Device Layer Count");
+    return false;
+  }
 
   // Get Device Actions
   if (!cb0r_find(&device, CB0R_UTF8, 7, (uint8_t*)"actions", &device_data) || device_data.type != CB0R_ARRAY)
@@ -286,7 +360,11 @@ bool UADRuntime::LoadDevice(cb0r_t uadMap) {
     MLOGE(TAG, "Failed to get Device Actions");
     return false;
   }
-  CreateActionLUT(&device_data, &actionLUT, mapSize);
+  if (!CompileActions(&device_data))
+  {
+    MLOGE(TAG, "Failed to compile Device Actions");
+    return false;
+  }
 
   // Get Device Effects
   if (!cb0r_find(&device, CB0R_UTF8, 7, (uint8_t*)"effects", &device_data) || device_data.type != CB0R_ARRAY)
@@ -294,11 +372,33 @@ bool UADRuntime::LoadDevice(cb0r_t uadMap) {
     MLOGE(TAG, "Failed to get Device Effects");
     return false;
   }
-  CreateEffectLUT(&device_data, &effectLUT, layerCount);
+  if (!CompileEffects(&device_data))
+  {
+    MLOGE(TAG, "Failed to compile Device Effects");
+    return false;
+  }
   return device_found;
 }
 
+bool UADRuntime::CreateRegisters() {
+  size_t count = actions.opcodes.size() + effects.opcodes.size() + effects.listLength.size();
+  if (count >= INVALID_REGISTER)
+  {
+    MLOGE(TAG, "Too many registers");
+    return false;
+  }
+  registers.assign(count, 0);
+
+  // Effects start out clean, every layer's cache is drawn the first time it is shown
+  layerCache.assign(effects.listLength.size(), Color(0));
+  effectDirty.assign(effects.opcodes.size(), 0);
+  layerCached = 0;
+  layerDirty = 0;
+  return true;
+}
+
 bool UADRuntime::LoadUAD(uint8_t* uad, size_t size) {
+  UnloadUAD();
   this->uad = uad;
   this->uadSize = size;
   MLOGI(TAG, "Loading UAD");
@@ -332,6 +432,11 @@ bool UADRuntime::LoadUAD(uint8_t* uad, size_t size) {
     return false;
   }
 
+  if (!CreateRegisters()) { // Give every action, effect and key group a register slot, and the effects their cache
+    MLOGE(TAG, "Failed to create registers");
+    return false;
+  }
+
   loaded = true;
 
   MLOGI(TAG, "Done parsing UAD");
@@ -342,4 +447,11 @@ bool UADRuntime::LoadUAD(uint8_t* uad, size_t size) {
 
 void UADRuntime::UnloadUAD() {
   loaded = false;
+  actions = UADActionTable();
+  effects = UADActionTable();
+  vector<uint16_t>().swap(actionLayers);
+  vector<uint32_t>().swap(operandPool);
+  vector<uint32_t>().swap(registers);
+  vector<Color>().swap(layerCache);
+  vector<uint8_t>().swap(effectDirty);
 }
@@ -1,19 +1,28 @@
-#include <cmath>
+#include <algorithm>
 #include "UAD.h"
 
 #define TAG "UAD Runtime"
 
 int8_t UADRuntime::IndexInBitmap(uint64_t bitmap, uint8_t index) {
-  if (!IsBitSet(bitmap, index))
+  if (index >= 64 || !((bitmap >> index) & 1))
+  {
+    return -1;
+  }
+
+  // Rank of the bit, the count of bits set below it
+  return __builtin_popcountll(bitmap & ((1ULL << index) - 1)) + 1;
+}
+
+int8_t UADRuntime::IndexInBitmapReference(uint64_t bitmap, uint8_t index) {
+  if (index >= 64 || !((bitmap >> index) & 1))
   {
     return -1;
   }
 
-  // Find nums of bits set before index - TODO: This can probably be optimized by a lot
   uint8_t count = 0;
   for (uint8_t i = 0; i < index; i++)
   {
-    count += IsBitSet(bitmap, i);
+    count += (bitmap >> i) & 1;
   }
   return count + 1;
 }
@@ -49,107 +58,64 @@ void UADRuntime::KeyEvent(uint16_t keyID, KeyInfo* keyInfo) {
 }
 
 bool UADRuntime::ExecuteActions(ActionInfo* actionInfo, ActionEvent* actionEvent) {
-  // Get Offset based on index type
-  uint16_t offset;
   ActionInfo newActionInfo = *actionInfo;
   newActionInfo.actionType = ActionType::ACTION;
   
-  if (actionInfo->indexType == ActionIndexType::COORD)
-  {
-    // MLOGV(TAG, "Executing actions for key %d,%d", actionInfo->coord.x, actionInfo->coord.y);
-    offset = actionLUT[actionInfo->coord.x][actionInfo->coord.y];
-  }
-  else
+  if (actionInfo->indexType != ActionIndexType::COORD)
   {
     MLOGV(TAG, "Executing actions for key %d ( Doesn't not support off grid keys yet)", actionInfo->id);
     return false;  // Doesn't not support off grid keys yet
   }
 
-  // If the offset is 0, there are no actions to execute
-  if (offset == 0)
+  Point xy = actionInfo->coord;
+  if (xy.x < 0 || xy.y < 0 || xy.x >= mapSize.x || xy.y >= mapSize.y)
   {
-    MLOGV(TAG, "No actions to execute");
     return false;
   }
 
-  // Get Action Layer Array
-  cb0r_s layer_array;
-  if (!cb0r((uint8_t*)uad + offset, (uint8_t*)uad + uadSize, 0, &layer_array) || layer_array.type != CB0R_ARRAY)
+  // If no layer has a list here, there are no actions to execute
+  uint16_t bitmap = actionLayers[xy.x * mapSize.y + xy.y];
+  if (bitmap == 0)
   {
-    MLOGE(TAG, "Failed to get Action Layer Array");
+    MLOGV(TAG, "No actions to execute");
     return false;
   }
 
-  // Get Action Layer Bitmap
-  cb0r_s bitmap;
-  if (!cb0r_get_check_type(&layer_array, 0, &bitmap, CB0R_INT))
+  // Resolve the layer - From the top, the first layer that is enabled and has actions here runs them.
+  // Layers without actions here pass through to the ones below only if set to passthrough
+  MLOGD(TAG, "Layer Enabled: %d", layerEnabled);
+  uint16_t layers = (1 << layerCount) - 1;
+  uint16_t hit = bitmap & layerEnabled & layers;
+  uint16_t stop = ~bitmap & ~layerPassthrough & layers;
+  uint16_t found = hit | stop;
+  if (found == 0)
   {
-    MLOGE(TAG, "Failed to get Action Layer Bitmap");
-    return false;
+    return true;
   }
 
-  // Execute Actions - Iterate through layers and pass through layers based on configs
-  // TODO: Because the we are reading layers from back of the array to front of the array, we need to iterate from back to front. That means we can't do serial reading. 
-  // I will get this fixed. 
-  cb0r_s actions = bitmap;
-  MLOGD(TAG, "Layer Enabled: %d", layerEnabled);
-  for (int8_t layer = layerCount - 1; layer >= 0; layer--)
+  uint8_t layer = 31 - __builtin_clz(found);
+  if (!IsBitSet(hit, layer))
   {
-    // If the layer has no action.
-    if (!IsBitSet(bitmap.value, layer))
-    {
-      if (IsBitSet(layerPassthrough, layer))
-      {
-        MLOGV(TAG, "Layer %d is set to passthrough", layer);
-        // If the layer is set to passthrough, Load next layer action
-        continue;
-      }
-      else
-      {
-        MLOGV(TAG, "Layer %d is not set to passthrough", layer);
-        // If the layer is not set to passthrough, stop executing actions
-        return true;
-      }
-    }
-
-    // Get the actions array
-    if (!cb0r_next_check_type(&layer_array, &actions, &actions, CB0R_ARRAY))
-    {
-      MLOGE(TAG, "Failed to get Action Array");
-      return false;
-    }
-
-    // If the layer is not enabled, skip it
-    MLOGV(TAG, "Checking Layer: %d", layer);
-    if (!IsBitSet(layerEnabled, layer))
-    {
-      MLOGV(TAG, "Layer %d is not enabled", layer);
-      continue;
-    }
+    MLOGV(TAG, "Layer %d is not set to passthrough", layer);
+    return true;
+  }
 
-    // Reassign the actions's layer to the one that is actually triggered
-    newActionInfo.layer = layer;
+  // Reassign the actions's layer to the one that is actually triggered
+  newActionInfo.layer = layer;
 
-    // Execute the actions
-    cb0r_s actionData = actions;
-    MLOGV(TAG, "Action Length: %d", actions.length);
-    for (uint8_t action_index = 0; action_index < actions.length; action_index++)
-    {
-      newActionInfo.index = action_index;
-      if (!cb0r_next_check_type(&actions, &actionData, &actionData, CB0R_ARRAY))
-      {
-        MLOGE(TAG, "Failed to get action %d from action list", action_index);
-      }
-      ExecuteAction(&newActionInfo, &actionData, actionEvent);
-    }
-    break; // Action on top layer executed, stop executing following layers
+  // Execute the actions
+  uint16_t list = ActionListIndex(xy.x, xy.y, layer);
+  uint16_t first = actions.listStart[list];
+  MLOGV(TAG, "Action Length: %d", actions.listLength[list]);
+  for (uint8_t action_index = 0; action_index < actions.listLength[list]; action_index++)
+  {
+    newActionInfo.index = action_index;
+    ExecuteAction(&newActionInfo, actions.opcodes[first + action_index], &actions.operands[first + action_index], actionEvent);
   }
   return true;
 }
 
 bool UADRuntime::ExecuteEffects(ActionInfo* effectInfo, ActionEvent* effectEvent) {
-  // Get Offset based on index type
-  uint16_t offset = effectLUT[effectInfo->layer];
   ActionInfo newEffectInfo = *effectInfo;
   newEffectInfo.actionType = ActionType::EFFECT;
 
@@ -163,85 +129,36 @@ bool UADRuntime::ExecuteEffects(ActionInfo* effectInfo, ActionEvent* effectEvent
     return false;  // Doesn't not support off grid keys yet
   }
 
-  // If the offset is 0, there are no effects to execute
-  if (offset == 0)
-  {
-    MLOGV(TAG, "No effects to execute");
-    return false;
-  }
-
-  // Get X Array
-  cb0r_s x_array;
-  if (!cb0r((uint8_t*)uad + offset, (uint8_t*)uad + uadSize, 0, &x_array) || x_array.type != CB0R_ARRAY)
-  {
-    MLOGE(TAG, "Failed to get Effect X Array");
-    return false;
-  }
-
-  // Get x Layer Bitmap
-  cb0r_s x_bitmap;
-  if (!cb0r_get_check_type(&x_array, 0, &x_bitmap, CB0R_INT))
-  {
-    MLOGE(TAG, "Failed to get Effect X Bitmap");
-    return false;
-  }
-
-  int8_t x_index = IndexInBitmap(x_bitmap.value, effectInfo->coord.x);
-
-  if(x_index == -1)
+  Point xy = effectInfo->coord;
+  if (effectInfo->layer >= layerCount || xy.x < 0 || xy.y < 0 || xy.x >= mapSize.x || xy.y >= mapSize.y)
   {
-    MLOGV(TAG, "No effects to execute");
     return false;
   }
 
-  // Get Y Array
-  cb0r_s y_array;
-  if (!cb0r_get_check_type(&x_array, x_index, &y_array, CB0R_ARRAY))
-  {
-    MLOGE(TAG, "Failed to get Effect Y Array");
-    return false;
-  }
-
-  // Get y Layer Bitmap
-  cb0r_s y_bitmap;
-  if (!cb0r_get_check_type(&y_array, 0, &y_bitmap, CB0R_INT))
-  {
-    MLOGE(TAG, "Failed to get Effect Y Bitmap");
-    return false;
-  }
-
-  int8_t y_index = IndexInBitmap(y_bitmap.value, effectInfo->coord.y);
-
-  if(y_index == -1)
+  // If the list is empty, there are no effects to execute
+  uint16_t list = EffectListIndex(effectInfo->layer, xy.x, xy.y);
+  if (effects.listLength[list] == 0)
   {
     MLOGV(TAG, "No effects to execute");
     return false;
   }
 
-  // Get the effects array
-  cb0r_s effects;
-  if (!cb0r_get_check_type(&y_array, y_index, &effects, CB0R_ARRAY))
-  {
-    MLOGE(TAG, "Failed to get Effect Array");
-    return false;
-  }
-
   // Execute the effects
-  cb0r_s effectData = effects;
-  for (uint8_t effect_index = 0; effect_index < effects.length; effect_index++)
+  uint16_t first = effects.listStart[list];
+  for (uint8_t effect_index = 0; effect_index < effects.listLength[list]; effect_index++)
   {
     newEffectInfo.index = effect_index;
-    if(!cb0r_next_check_type(&effects, &effectData, &effectData, CB0R_ARRAY))
-    {
-      MLOGE(TAG, "Failed to get effect %d from effect list", effect_index);
-    }
-    ExecuteAction(&newEffectInfo, &effectData, effectEvent);
+    ExecuteAction(&newEffectInfo, effects.opcodes[first + effect_index], &effects.operands[first + effect_index], effectEvent);
   }
   return true;
 }
 
 uint8_t UADRuntime::GetTopLayer() {
-  return std::log2(layerEnabled);
+  if (layerEnabled == 0)
+  {
+    return 0;
+  }
+  return 31 - __builtin_clz(layerEnabled);
 }
 
 void UADRuntime::InitializeLayer(uint8_t layer) {
@@ -250,94 +167,30 @@ void UADRuntime::InitializeLayer(uint8_t layer) {
     layer = GetTopLayer();
   }
 
-  MLOGI(TAG, "Initializing layer %d", layer);
-
-  uint16_t offset = effectLUT[layer];
-
-  // Nothing in this layer
-  if (offset == 0)
+  if (!loaded || layer >= layerCount)
   {
     MLOGI(TAG, "Nothing in the effect layer");
     return;
   }
 
-  ActionEvent actionEvent = {.type = ActionEventType::INITIALIZATION, .data = NULL};
-
-  ActionInfo effectInfo;
-  effectInfo.actionType = ActionType::EFFECT;
-  effectInfo.indexType = ActionIndexType::COORD;
-
-  // Iterating
-  cb0r_s x_array;
-  if (!cb0r((uint8_t*)uad + offset, (uint8_t*)uad + uadSize, 0, &x_array) || x_array.type != CB0R_ARRAY)
-  {
-    MLOGE(TAG, "Failed to get Effect X Array");
-    return;
-  }
-
-  // Get X Bitmap
-  cb0r_s x_bitmap;
-  if (!cb0r_get_check_type(&x_array, 0, &x_bitmap, CB0R_INT))
+  MLOGI(TAG, "Initializing layer %d", layer);
+  if (!IsBitSet(layerCached, layer))
   {
-    MLOGE(TAG, "Failed to get Effect X Bitmap");
-    return;
+    RenderLayerCache(layer);
   }
 
-  // Get Y Array
-  cb0r_s y_array = x_bitmap;
   for (uint8_t x = 0; x < mapSize.x; x++)
   {
-    if (!IsBitSet(x_bitmap.value, x))
-    {
-      continue;
-    }
-
-    if (!cb0r_next_check_type(&x_array, &y_array, &y_array, CB0R_ARRAY))
-    {
-      MLOGE(TAG, "Failed to get Effect Y Array");
-      return;
-    }
-
-    // Get Y Bitmap
-    cb0r_s y_bitmap;
-    if (!cb0r_get_check_type(&y_array, 0, &y_bitmap, CB0R_INT))
-    {
-      MLOGE(TAG, "Failed to get Effect Y Bitmap");
-      return;
-    }
-
-    // Get Y Array
-    cb0r_s effects = y_bitmap;
     for (uint8_t y = 0; y < mapSize.y; y++)
     {
-      if (!IsBitSet(y_bitmap.value, y))
+      uint16_t list = EffectListIndex(layer, x, y);
+      if (effects.listLength[list] > 0)
       {
-        continue;
-      }
-
-      if (!cb0r_next_check_type(&y_array, &effects, &effects, CB0R_ARRAY))
-      {
-        MLOGE(TAG, "Failed to get Effect Effect Array\n");
-        return;
-      }
-
-      // Execute the effects
-      cb0r_s effectData = effects;
-      for (uint8_t effect_index = 0; effect_index < effects.length; effect_index++)
-      {
-        effectInfo.coord = Point(x, y);
-        effectInfo.layer = layer;
-        effectInfo.index = effect_index;
-
-        if (!cb0r_next_check_type(&effects, &effectData, &effectData, CB0R_ARRAY))
-        {
-          MLOGE(TAG, "Failed to get effect %d from effect list", effect_index);
-          continue;
-        }
-        ExecuteAction(&effectInfo, &effectData, &actionEvent);
+        MatrixOS::LED::SetColor(Point(x, y), layerCache[list], 0);
       }
     }
   }
+  UpdateEffects(layer, false);
   MLOGI(TAG, "Layer %d initialized", layer);
 }
 
@@ -348,93 +201,128 @@ void UADRuntime::DeinitializeLayer(uint8_t layer) {
   }
 
   MLOGI(TAG, "Deinitializing layer %d", layer);
+  ActionEvent actionEvent = {.type = ActionEventType::DEINITIALIZATION, .data = NULL};
+  ExecuteLayerEffects(layer, &actionEvent);
+  MLOGI(TAG, "Layer %d deinitialized", layer);
+}
 
-  uint16_t offset = effectLUT[layer];
-
-  // Nothing in this layer
-  if (offset == 0)
+void UADRuntime::ExecuteLayerEffects(uint8_t layer, ActionEvent* effectEvent) {
+  if (!loaded || layer >= layerCount)
   {
     MLOGI(TAG, "Nothing in the effect layer");
     return;
   }
 
-  ActionEvent actionEvent = {.type = ActionEventType::DEINITIALIZATION, .data = NULL};
-
-  
   ActionInfo effectInfo;
   effectInfo.actionType = ActionType::EFFECT;
   effectInfo.indexType = ActionIndexType::COORD;
+  effectInfo.layer = layer;
 
-  // Iterating
-  cb0r_s x_array;
-  if (!cb0r((uint8_t*)uad + offset, (uint8_t*)uad + uadSize, 0, &x_array) || x_array.type != CB0R_ARRAY)
+  for (uint8_t x = 0; x < mapSize.x; x++)
   {
-    MLOGE(TAG, "Failed to get Effect X Array");
-    return;
+    for (uint8_t y = 0; y < mapSize.y; y++)
+    {
+      uint16_t list = EffectListIndex(layer, x, y);
+      uint16_t first = effects.listStart[list];
+      effectInfo.coord = Point(x, y);
+      for (uint8_t effect_index = 0; effect_index < effects.listLength[list]; effect_index++)
+      {
+        effectInfo.index = effect_index;
+        ExecuteAction(&effectInfo, effects.opcodes[first + effect_index], &effects.operands[first + effect_index], effectEvent);
+      }
+    }
   }
+}
+
+// Effects whose output follows a group register rather than the layer alone
+static bool RegisterDriven(UADOpcode opcode) {
+  return opcode == UADOpcode::ACTIONCOLOR;
+}
+
+void UADRuntime::RenderLayerCache(uint8_t layer) {
+  uint16_t first = EffectListIndex(layer, 0, 0);
+  std::fill(layerCache.begin() + first, layerCache.begin() + first + mapSize.x * mapSize.y, Color(0));
+
+  ActionEvent actionEvent = {.type = ActionEventType::INITIALIZATION, .data = NULL};
+  ExecuteLayerEffects(layer, &actionEvent);
+  layerCached |= 1 << layer;
+}
 
-  // Get X Bitmap
-  cb0r_s x_bitmap;
-  if (!cb0r_get_check_type(&x_array, 0, &x_bitmap, CB0R_INT))
+void UADRuntime::SetEffectColor(ActionInfo* effectInfo, Color color) {
+  if (effectInfo->indexType == ActionIndexType::ID)
   {
-    MLOGE(TAG, "Failed to get Effect X Bitmap");
+    MatrixOS::LED::SetColor(effectInfo->id, color, 0);
     return;
   }
 
-  // Get Y Array
-  cb0r_s y_array = x_bitmap;
-  for (uint8_t x = 0; x < mapSize.x; x++)
+  Point xy = effectInfo->coord;
+  if (effectInfo->layer >= layerCount || xy.x < 0 || xy.y < 0 || xy.x >= mapSize.x || xy.y >= mapSize.y)
   {
-    if (!IsBitSet(x_bitmap.value, x))
-    {
-      continue;
-    }
+    return;
+  }
+  layerCache[EffectListIndex(effectInfo->layer, xy.x, xy.y)] = color;
+}
 
-    if (!cb0r_next_check_type(&x_array, &y_array, &y_array, CB0R_ARRAY))
-    {
-      MLOGE(TAG, "Failed to get Effect Y Array");
-      return;
-    }
+void UADRuntime::UpdateEffects(uint8_t layer, bool dirtyOnly) {
+  ActionEvent actionEvent = {.type = ActionEventType::UPDATE, .data = NULL};
 
-    // Get Y Bitmap
-    cb0r_s y_bitmap;
-    if (!cb0r_get_check_type(&y_array, 0, &y_bitmap, CB0R_INT))
-    {
-      MLOGE(TAG, "Failed to get Effect Y Bitmap");
-      return;
-    }
+  ActionInfo effectInfo;
+  effectInfo.actionType = ActionType::EFFECT;
+  effectInfo.indexType = ActionIndexType::COORD;
+  effectInfo.layer = layer;
 
-    // Get Y Array
-    cb0r_s effects = y_bitmap;
+  for (uint8_t x = 0; x < mapSize.x; x++)
+  {
     for (uint8_t y = 0; y < mapSize.y; y++)
     {
-      if (!IsBitSet(y_bitmap.value, y))
-      {
-        continue;
-      }
-
-      if (!cb0r_next_check_type(&y_array, &effects, &effects, CB0R_ARRAY))
+      uint16_t list = EffectListIndex(layer, x, y);
+      uint16_t first = effects.listStart[list];
+      effectInfo.coord = Point(x, y);
+      for (uint8_t effect_index = 0; effect_index < effects.listLength[list]; effect_index++)
       {
-        MLOGE(TAG, "Failed to get Effect Effect Array\n");
-        return;
-      }
-
-      // Execute the effects
-      cb0r_s effectData = effects;
-      for (uint8_t effect_index = 0; effect_index < effects.length; effect_index++)
-      {
-        effectInfo.coord = Point(x, y);
-        effectInfo.layer = layer;
-        effectInfo.index = effect_index;
-
-        if (!cb0r_next_check_type(&effects, &effectData, &effectData, CB0R_ARRAY))
+        uint16_t effect = first + effect_index;
+        if (!RegisterDriven(effects.opcodes[effect]) || (dirtyOnly && !effectDirty[effect]))
         {
-          MLOGE(TAG, "Failed to get effect %d from effect list", effect_index);
           continue;
         }
-        ExecuteAction(&effectInfo, &effectData, &actionEvent);
+        effectDirty[effect] = 0;
+        effectInfo.index = effect_index;
+        ExecuteAction(&effectInfo, effects.opcodes[effect], &effects.operands[effect], &actionEvent);
       }
     }
   }
-  MLOGI(TAG, "Layer %d deinitialized", layer);
+  layerDirty &= ~(1 << layer);
+}
+
+void UADRuntime::Render() {
+  if (!loaded || layerDirty == 0)
+  {
+    return;
+  }
+
+  uint8_t layer = GetTopLayer();
+  if (IsBitSet(layerDirty, layer))
+  {
+    UpdateEffects(layer, true);
+  }
+}
+
+void UADRuntime::RegisterChanged(uint16_t slot) {
+  // Only group registers drive effects
+  uint16_t groupBase = actions.opcodes.size() + effects.opcodes.size();
+  if (slot < groupBase)
+  {
+    return;
+  }
+
+  uint16_t list = slot - groupBase;
+  uint16_t first = effects.listStart[list];
+  for (uint8_t effect_index = 0; effect_index < effects.listLength[list]; effect_index++)
+  {
+    if (RegisterDriven(effects.opcodes[first + effect_index]))
+    {
+      effectDirty[first + effect_index] = 1;
+      layerDirty |= 1 << (list / (mapSize.x * mapSize.y));
+    }
+  }
 }
@@ -50,6 +50,12 @@ void Note::Setup(const vector<string>& args) {
     runtimes[i].midiPipeline.AddEffect("Arpeggiator", &runtimes[i].arpeggiator);
   }
 
+  // Clock
+  MatrixOS::Clock::SetBPM(bpm);
+  ApplyClockMode();
+  clockHandle = MatrixOS::Clock::Subscribe(EFFECT_TPQN);
+  MatrixOS::Clock::SetSkipLate(clockHandle, true); // A stalled loop shouldn't come back to a burst of arpeggio steps
+
   int32_t octaveAbs = (int32_t)abs(notePadConfigs[activeConfig].octave);
 
   // Set up the Action Menu UI ---------------------------------------------------------------------
@@ -1087,7 +1093,7 @@ void Note::ArpConfigMenu() {
   bpmTapper.OnChange([&](uint16_t tappedBPM) -> void {
     bpmValue = tappedBPM;
     bpm = tappedBPM;
-    midiClock.SetBPM(tappedBPM);
+    MatrixOS::Clock::SetBPM(tappedBPM);
     bpmTextDisplay.Disable();
   });
   bpmTapper.SetEnableFunc([&]() -> bool { return arpMenuPage == ARP_BPM; });
@@ -1105,7 +1111,7 @@ void Note::ArpConfigMenu() {
   bpmNumberModifier.OnChange([&](int32_t val) -> void {
     bpmValue = val;
     bpm = (uint16_t)val;
-    midiClock.SetBPM((uint16_t)val);
+    MatrixOS::Clock::SetBPM((uint16_t)val);
     bpmTextDisplay.Disable();
   });
   arpConfigMenu.AddUIComponent(bpmNumberModifier, Point(0, 7));
@@ -1134,6 +1140,7 @@ void Note::ArpConfigMenu() {
     } else {
       clockMode = CLOCK_INTERNAL;
     }
+    ApplyClockMode();
   });
   arpConfigMenu.AddUIComponent(clockOutBtn, Point(0, 6));
 
@@ -1676,7 +1683,7 @@ void Note::ArpConfigMenu() {
       case ARP_BPM:
         bpmValue = 120;
         bpm = 120;
-        midiClock.SetBPM(120);
+        MatrixOS::Clock::SetBPM(120);
         break;
       case ARP_SWING:
         swingValue = 50;
@@ -1759,13 +1766,22 @@ void Note::SaveConfigs() {
 }
 
 void Note::Tick() {
-  if(midiClock.Tick())
+  // The OS clock keeps time, we just catch up on the ticks that passed since the last loop
+  for (uint32_t ticks = MatrixOS::Clock::Ticks(clockHandle); ticks > 0; ticks--)
   {
-    if(clockMode == CLOCK_INTERNAL_CLOCKOUT && midiClock.TickCount() % (EFFECT_TPQN / 24) == 0)
-    {
-      MatrixOS::MIDI::Send(MidiPacket::Clock(), MIDI_PORT_ALL);
-    }
     runtimes[0].Tick();
     runtimes[1].Tick();
   }
 }
+
+void Note::ApplyClockMode() {
+  MatrixOS::Clock::SetSource(clockMode == CLOCK_EXTERNAL ? MatrixOS::Clock::CLOCK_SOURCE_EXTERNAL : MatrixOS::Clock::CLOCK_SOURCE_INTERNAL);
+  MatrixOS::Clock::EnableOutput(clockMode == CLOCK_INTERNAL_CLOCKOUT);
+}
+
+void Note::End() {
+  MatrixOS::Clock::Unsubscribe(clockHandle);
+  clockHandle = -1;
+  MatrixOS::Clock::EnableOutput(false);
+  MatrixOS::Clock::SetSource(MatrixOS::Clock::CLOCK_SOURCE_INTERNAL); // Don't leave the next app waiting on a clock that isn't coming
+}
@@ -5,7 +5,6 @@
 #include "Scales.h"
 #include "UI/UI.h"
 #include "Application.h"
-#include "MidiClock.h"
 
 #define NOTE_APP_VERSION 2
 
@@ -37,9 +36,10 @@ class Note : public Application {
   CreateSavedVar("Note", bpm, uint16_t, 120);
   CreateSavedVar("Note", clockMode, MidiClockMode, CLOCK_INTERNAL);
 
-  MidiClock midiClock = MidiClock(bpm, EFFECT_TPQN);
+  int8_t clockHandle = -1; // EFFECT_TPQN ticks from the OS clock
 
   void Setup(const vector<string>& args) override;
+  void End() override;
 
   void KeyEventHandler(KeyEvent& keyEvent);
 
@@ -55,6 +55,7 @@ class Note : public Application {
   void ArpConfigMenu();
 
   void Tick();
+  void ApplyClockMode();
 
   void SaveConfigs();
 
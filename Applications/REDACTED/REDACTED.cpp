@@ -61,7 +61,7 @@ void REDACTED::Task2() {
       for (uint8_t i = 0; i <= (data2[offset2] >> 5); i++)
       {
         uint8_t v = 80 * (data2[offset2 + bufferOffset] >> 7);
-        MatrixOS::MIDI::Send(MidiPacket( v > 0 ? EMidiStatus::NoteOn : EMidiStatus::NoteOff, 0, data2[offset2 + bufferOffset] & 0x7F, v));
+        MatrixOS::MIDI::Send(v > 0 ? MidiPacket::NoteOn(0, data2[offset2 + bufferOffset] & 0x7F, v) : MidiPacket::NoteOff(0, data2[offset2 + bufferOffset] & 0x7F, v));
 
         bufferOffset++;
       }
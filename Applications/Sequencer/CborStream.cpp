@@ -0,0 +1,186 @@
+#include "CborStream.h"
+#include <cstring>
+#include <algorithm>
+
+void CborWriter::Put(const void* data, size_t length)
+{
+    const uint8_t* bytes = (const uint8_t*)data;
+    while (length > 0)
+    {
+        if (used == sizeof(buffer))
+        {
+            Flush();
+        }
+        size_t chunk = std::min(length, sizeof(buffer) - used);
+        memcpy(buffer + used, bytes, chunk);
+        used += chunk;
+        written += chunk;
+        bytes += chunk;
+        length -= chunk;
+    }
+}
+
+void CborWriter::Head(cb0r_e type, uint64_t value)
+{
+    uint8_t head[9];
+    uint8_t length = cb0r_write(head, type, value);
+    Put(head, length);
+}
+
+void CborWriter::FixedUInt(uint32_t value)
+{
+    uint8_t head[5] = {0x1A, (uint8_t)(value >> 24), (uint8_t)(value >> 16), (uint8_t)(value >> 8), (uint8_t)value};
+    Put(head, sizeof(head));
+}
+
+void CborWriter::Bool(bool value)
+{
+    uint8_t byte = value ? 0xF5 : 0xF4; // CBOR true/false
+    Put(&byte, 1);
+}
+
+void CborWriter::Text(const char* text, size_t length)
+{
+    Head(CB0R_UTF8, length);
+    Put(text, length);
+}
+
+void CborWriter::Bytes(const void* data, size_t length)
+{
+    Head(CB0R_BYTE, length);
+    Put(data, length);
+}
+
+bool CborWriter::Flush()
+{
+    if (used > 0)
+    {
+        if (file.Write(buffer, used) != used) { ok = false; }
+        used = 0;
+    }
+    return ok;
+}
+
+bool CborReader::Fill()
+{
+    pos = 0;
+    length = file.Read(buffer, sizeof(buffer));
+    return length > 0;
+}
+
+bool CborReader::Byte(uint8_t& byte)
+{
+    if (pos == length && !Fill()) return false;
+    byte = buffer[pos++];
+    consumed++;
+    return true;
+}
+
+bool CborReader::Read(void* data, size_t size)
+{
+    uint8_t* out = (uint8_t*)data;
+    while (size > 0)
+    {
+        if (pos == length && !Fill()) return false;
+        size_t chunk = std::min(size, (size_t)(length - pos));
+        if (out)
+        {
+            memcpy(out, buffer + pos, chunk);
+            out += chunk;
+        }
+        pos += chunk;
+        consumed += chunk;
+        size -= chunk;
+    }
+    return true;
+}
+
+bool CborReader::AtEnd()
+{
+    return pos == length && !Fill();
+}
+
+size_t CborReader::Remaining()
+{
+    size_t size = file.Size();
+    size_t position = file.Position();
+    return (size > position ? size - position : 0) + (length - pos);
+}
+
+bool CborReader::Head(cb0r_e& type, uint64_t& value)
+{
+    uint8_t initial;
+    if (!Byte(initial)) return false;
+
+    uint8_t major = initial >> 5;
+    uint8_t info = initial & 0x1F;
+
+    value = info;
+    if (info >= 24)
+    {
+        if (info > 27) return false; // Indefinite length or reserved
+        uint8_t size = 1 << (info - 24);
+        value = 0;
+        for (uint8_t i = 0; i < size; i++)
+        {
+            uint8_t byte;
+            if (!Byte(byte)) return false;
+            value = (value << 8) | byte;
+        }
+    }
+
+    if (major != 7)
+    {
+        type = (cb0r_e)(CB0R_INT + major);
+        return true;
+    }
+
+    switch (info)
+    {
+        case 20: type = CB0R_FALSE; break;
+        case 21: type = CB0R_TRUE; break;
+        case 22: type = CB0R_NULL; break;
+        case 23: type = CB0R_UNDEF; break;
+        case 25:
+        case 26:
+        case 27: type = CB0R_FLOAT; break;
+        default: type = CB0R_SIMPLE; break;
+    }
+    return true;
+}
+
+bool CborReader::UInt(uint64_t& value)
+{
+    cb0r_e type;
+    return Head(type, value) && type == CB0R_INT;
+}
+
+bool CborReader::Skip(cb0r_e type, uint64_t value)
+{
+    // Count of items still owed, walked flat so corrupt nesting can't run the stack out
+    uint64_t remaining = 0;
+    while (true)
+    {
+        switch (type)
+        {
+            case CB0R_BYTE:
+            case CB0R_UTF8:
+                if (!Read(nullptr, value)) return false;
+                break;
+            case CB0R_ARRAY: remaining += value; break;
+            case CB0R_MAP: remaining += value * 2; break;
+            case CB0R_TAG: remaining += 1; break;
+            default: break;
+        }
+        if (remaining == 0) return true;
+        remaining--;
+        if (!Head(type, value)) return false;
+    }
+}
+
+bool CborReader::SkipItem()
+{
+    cb0r_e type;
+    uint64_t value;
+    return Head(type, value) && Skip(type, value);
+}
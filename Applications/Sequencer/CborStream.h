@@ -0,0 +1,61 @@
+#pragma once
+
+#include "MatrixOS.h"
+#include "cb0r.h"
+
+#define CBOR_STREAM_BUFFER 512
+
+// Writes CBOR straight to a File through a fixed buffer, no per-item staging
+class CborWriter
+{
+public:
+    CborWriter(File& file) : file(file) {}
+
+    void Head(cb0r_e type, uint64_t value); // CB0R_INT, CB0R_NEG, CB0R_BYTE, CB0R_UTF8, CB0R_ARRAY, CB0R_MAP or CB0R_TAG
+    void UInt(uint64_t value) { Head(CB0R_INT, value); }
+    void FixedUInt(uint32_t value); // Always 5 bytes, for fields patched in place later
+    void Bool(bool value);
+    void Text(const char* text, size_t length);
+    void Bytes(const void* data, size_t length);
+    void Raw(const void* data, size_t length) { Put(data, length); } // Already encoded CBOR
+
+    bool Flush(); // False if any write so far came up short
+    size_t Position() { return written; } // Bytes written through this writer, flushed or not
+
+private:
+    File& file;
+    uint8_t buffer[CBOR_STREAM_BUFFER];
+    uint16_t used = 0;
+    size_t written = 0;
+    bool ok = true;
+
+    void Put(const void* data, size_t length);
+};
+
+// Pulls CBOR items off a File one head at a time through a fixed buffer, items can be any size
+// Definite lengths only, which is all CborWriter produces
+class CborReader
+{
+public:
+    CborReader(File& file) : file(file) {}
+
+    // Reads the next head. Major type 7 comes back as CB0R_FALSE, CB0R_TRUE, CB0R_NULL, CB0R_UNDEF, CB0R_FLOAT (value is the raw bits) or CB0R_SIMPLE
+    bool Head(cb0r_e& type, uint64_t& value);
+    bool UInt(uint64_t& value); // Next item must be an unsigned integer
+    bool Skip(cb0r_e type, uint64_t value); // Skips whatever belongs to the head just read, nested items included
+    bool SkipItem();
+    bool Read(void* data, size_t length); // Raw body bytes after a CB0R_BYTE or CB0R_UTF8 head, data may be nullptr to discard
+    bool AtEnd();
+    size_t Position() { return consumed; }
+    size_t Remaining(); // Bytes left in the file after the current position, to sanity check counts read from it
+
+private:
+    File& file;
+    uint8_t buffer[CBOR_STREAM_BUFFER];
+    uint16_t pos = 0;
+    uint16_t length = 0;
+    size_t consumed = 0;
+
+    bool Fill();
+    bool Byte(uint8_t& byte);
+};
@@ -252,9 +252,12 @@ bool SequencerControlBar::HandleRecordKey(KeyInfo *keyInfo)
 {
   if (keyInfo->state == HOLD)
   {
-    sequencer->SetMessage(sequencer->ClearActive() ? SequencerMessage::UNDO : SequencerMessage::RECORD, true);
+    SequencerMessage message = SequencerMessage::RECORD;
+    if (sequencer->ClearActive()) { message = SequencerMessage::UNDO; }
+    else if (sequencer->CopyActive()) { message = SequencerMessage::REDO; }
+    sequencer->SetMessage(message, true);
   }
-  else if (keyInfo->state == RELEASED && (sequencer->lastMessage == SequencerMessage::RECORD || sequencer->lastMessage == SequencerMessage::UNDO))
+  else if (keyInfo->state == RELEASED && (sequencer->lastMessage == SequencerMessage::RECORD || sequencer->lastMessage == SequencerMessage::UNDO || sequencer->lastMessage == SequencerMessage::REDO))
   {
     sequencer->SetMessage(SequencerMessage::NONE);
   }
@@ -262,11 +265,23 @@ bool SequencerControlBar::HandleRecordKey(KeyInfo *keyInfo)
   {
     if (sequencer->ClearActive())
     {
+      // Takes back the last recording first, then edits
       if(!sequencer->sequence.Playing() && sequencer->sequence.CanUndoLastRecord())
       {
         sequencer->sequence.UndoLastRecorded();
         sequencer->SetMessage(SequencerMessage::UNDONE);
       }
+      else if(sequencer->sequence.Undo())
+      {
+        sequencer->SetMessage(SequencerMessage::UNDONE);
+      }
+    }
+    else if (sequencer->CopyActive())
+    {
+      if(sequencer->sequence.Redo())
+      {
+        sequencer->SetMessage(SequencerMessage::REDONE);
+      }
     }
     else
     { 
@@ -359,6 +374,7 @@ bool SequencerControlBar::HandleClearKey(KeyInfo *keyInfo)
         uint16_t startTime = step * pulsesPerStep;
         uint16_t endTime = startTime + pulsesPerStep - 1;
         uint8_t channel = sequencer->sequence.GetChannel(track);
+        SequenceLock lock(sequencer->sequence);
         auto it = pattern->events.lower_bound(startTime);
         while (it != pattern->events.end() && it->first <= endTime)
         {
@@ -542,6 +558,7 @@ bool SequencerControlBar::HandleStepOctaveOffsetKey(bool positive, KeyInfo* keyI
         uint16_t endTime = startTime + pulsesPerStep - 1;
 
         uint8_t channel = sequencer->sequence.GetChannel(track);
+        SequenceLock lock(sequencer->sequence);
 
         // Send note-off for all notes in this step before transposing and remove from noteActive
         for (auto it = targetPattern->events.lower_bound(startTime); it != targetPattern->events.end() && it->first <= endTime; ++it)
@@ -1016,8 +1033,14 @@ bool SequencerControlBar::Render(Point origin)
     }
     else if (sequencer->ClearActive())
     {
-      // Undo record
-      MatrixOS::LED::SetColor(point, Color(0xFF0020).DimIfNot(sequencer->sequence.CanUndoLastRecord() && !sequencer->sequence.Playing()));
+      // Undo record, then edits
+      bool canUndo = (sequencer->sequence.CanUndoLastRecord() && !sequencer->sequence.Playing()) || sequencer->sequence.CanUndo();
+      MatrixOS::LED::SetColor(point, Color(0xFF0020).DimIfNot(canUndo));
+    }
+    else if (sequencer->CopyActive())
+    {
+      // Redo
+      MatrixOS::LED::SetColor(point, Color(0x0080FF).DimIfNot(sequencer->sequence.CanRedo()));
     }
     else if (sequencer->sequence.RecordEnabled())
     {
@@ -51,6 +51,7 @@ void EventDetailView::RebuildEventList()
         sequencer->SetView(Sequencer::ViewMode::Sequencer);
         return;
     }
+    eventRevision = pattern->events.Revision();
     
     uint16_t pulsesPerStep = sequencer->sequence.GetPulsesPerStep();
     uint16_t startTime = position.step * pulsesPerStep;
@@ -83,33 +84,56 @@ bool EventDetailView::KeyEvent(Point xy, KeyInfo* keyInfo)
 {
     bool handled = false;
 
-    // Route to appropriate handler based on Y position
-    if (xy.y == 0)
     {
-        handled = EventSelectorKeyHandler(xy, keyInfo);
-    }
-    else if (xy.y == 1)
-    {
-        if (xy.x < 6)
+        // The references below stay good only while recording can't insert into the pattern
+        SequenceLock lock(sequencer->sequence);
+
+        // Events moved since the list was built (recorded into, edited elsewhere), references are stale
+        if (pattern && pattern->events.Revision() != eventRevision)
         {
-            handled = MicroStepSelectorKeyHandler(xy, keyInfo);
+            RebuildEventList();
         }
-        else if (xy.x == 7)
+        if (eventRefs.empty())
         {
-            handled = DeleteEventKeyHandler(xy, keyInfo);
+            return false;
         }
-    }
-    else
-    {
-        auto& event = selectedEventIter->second;
-        if (event.eventType == SequenceEventType::NoteEvent)
+
+        // Route to appropriate handler based on Y position
+        if (xy.y == 0)
         {
-            handled = NoteConfigKeyHandler(xy - Point(0, 2), keyInfo);
+            handled = EventSelectorKeyHandler(xy, keyInfo);
         }
-        else if (event.eventType == SequenceEventType::ControlChangeEvent)
+        else if (xy.y == 1)
         {
-            handled = CCConfigKeyHandler(xy, keyInfo);
+            if (xy.x < 6)
+            {
+                handled = MicroStepSelectorKeyHandler(xy, keyInfo);
+            }
+            else if (xy.x == 7)
+            {
+                handled = DeleteEventKeyHandler(xy, keyInfo);
+            }
         }
+        else
+        {
+            auto& event = selectedEventIter->second;
+            if (event.eventType == SequenceEventType::NoteEvent)
+            {
+                handled = NoteConfigKeyHandler(xy - Point(0, 2), keyInfo);
+            }
+            else if (event.eventType == SequenceEventType::ControlChangeEvent)
+            {
+                handled = CCConfigKeyHandler(xy, keyInfo);
+            }
+        }
+    }
+
+    // Scrolling blocks, so it waits until the lock is given back
+    if (!scrollText.empty())
+    {
+        string text;
+        text.swap(scrollText);
+        MatrixOS::UIUtility::TextScroll(text, scrollColor);
     }
 
     if (!handled && keyInfo->State() == HOLD)
@@ -121,8 +145,24 @@ bool EventDetailView::KeyEvent(Point xy, KeyInfo* keyInfo)
     return handled;
 }
 
+void EventDetailView::ScrollAfter(const string& text, Color color)
+{
+    scrollText = text;
+    scrollColor = color;
+}
+
 bool EventDetailView::Render(Point origin)
 {
+    SequenceLock lock(sequencer->sequence);
+    if (pattern && pattern->events.Revision() != eventRevision)
+    {
+        RebuildEventList();
+    }
+    if (eventRefs.empty())
+    {
+        return true;
+    }
+
     RenderEventSelector(origin);
     RenderMicroStepSelector(origin + Point(0, 1));
 
@@ -230,11 +270,11 @@ bool EventDetailView::EventSelectorKeyHandler(Point xy, KeyInfo* keyInfo)
                     const SequenceEventNote& noteData = std::get<SequenceEventNote>(event.data);
                     if (noteData.aftertouch)
                     {
-                        MatrixOS::UIUtility::TextScroll("Aftertouch Event", aftertouchColor);
+                        ScrollAfter("Aftertouch Event", aftertouchColor);
                     }
                     else
                     {
-                        MatrixOS::UIUtility::TextScroll("Note Event", noteColor);
+                        ScrollAfter("Note Event", noteColor);
                     }
                 }
             }
@@ -257,7 +297,7 @@ void EventDetailView::RenderMicroStepSelector(Point origin)
         Color color = Color(0x404040); // Default: dark gray (empty)
 
         // Check if selected event is in this micro step slot
-        if (selectedEventIter != std::multimap<uint16_t, SequenceEvent>::iterator())
+        if (selectedEventIter != SequenceEventStore::iterator())
         {
             uint16_t eventTime = selectedEventIter->first;
             uint16_t relativeTime = eventTime - stepStartTime; // Time within the current step
@@ -304,18 +344,14 @@ bool EventDetailView::MicroStepSelectorKeyHandler(Point xy, KeyInfo* keyInfo)
 
         if (oldTime != targetTime)
         {
-            SequenceEvent eventData = eventIter->second;
-            pattern->events.erase(eventIter);
-            auto insertedIter = pattern->events.insert({targetTime, eventData});
-            sequencer->sequence.SetDirty();
-            selectedEventIter = insertedIter;
+            selectedEventIter = sequencer->sequence.PatternMoveEvent(pattern, eventIter, targetTime);
             RebuildEventList();
         }
         return true;
     }
     else if (keyInfo->State() == HOLD)
     {
-        MatrixOS::UIUtility::TextScroll("Microstep " + std::to_string(xy.x), Color::White);
+        ScrollAfter("Microstep " + std::to_string(xy.x), Color::White);
         return true;
     }
 
@@ -326,7 +362,7 @@ bool EventDetailView::DeleteEventKeyHandler(Point xy, KeyInfo* keyInfo)
 {
     if (keyInfo->State() == HOLD)
     {
-        MatrixOS::UIUtility::TextScroll("Delete Event", Color(0xFF0000));
+        ScrollAfter("Delete Event", Color(0xFF0000));
         return true;
     }
     else if (keyInfo->State() == RELEASED)
@@ -347,8 +383,7 @@ bool EventDetailView::DeleteEventKeyHandler(Point xy, KeyInfo* keyInfo)
             }
         }
 
-        pattern->events.erase(eventIter);
-        sequencer->sequence.SetDirty();
+        sequencer->sequence.PatternRemoveEvent(pattern, eventIter);
 
         RebuildEventList();
 
@@ -377,13 +412,14 @@ bool EventDetailView::NoteConfigKeyHandler(Point xy, KeyInfo* keyInfo)
         if (keyInfo->State() == HOLD)
         {
             Color modeColor = noteData.aftertouch ? aftertouchColor : noteColor;
-            MatrixOS::UIUtility::TextScroll(noteData.aftertouch ? "Aftertouch Event" : "Note On Event", modeColor);
+            ScrollAfter(noteData.aftertouch ? "Aftertouch Event" : "Note On Event", modeColor);
             return true;
         }
         else if (keyInfo->State() == RELEASED)
         {
+            SequenceEvent before = selectedEventIter->second;
             noteData.aftertouch = !noteData.aftertouch;
-            sequencer->sequence.SetDirty();
+            sequencer->sequence.PatternEventChanged(pattern, selectedEventIter->first, before, selectedEventIter->second);
             return true;
         }
     }
@@ -433,6 +469,7 @@ bool EventDetailView::LengthSelectorKeyHandler(Point xy, KeyInfo* keyInfo)
 
     if (keyInfo->State() == PRESSED)
     {
+        SequenceEvent before = selectedEventIter->second;
         uint16_t currentLength = noteData.length;
         uint16_t pulsesPerStep = sequencer->sequence.GetPulsesPerStep();
         uint16_t slotStart = lengthIdx * pulsesPerStep;
@@ -465,12 +502,12 @@ bool EventDetailView::LengthSelectorKeyHandler(Point xy, KeyInfo* keyInfo)
             noteData.length = std::min<uint16_t>(16, lengthPulses) * pulsesPerStep;
         }
 
-        sequencer->sequence.SetDirty();
+        sequencer->sequence.PatternEventChanged(pattern, selectedEventIter->first, before, selectedEventIter->second);
         return true;
     }
     else if (keyInfo->State() == HOLD)
     {
-        MatrixOS::UIUtility::TextScroll("Length " + std::to_string(lengthPulses), Color(0xA000FF));
+        ScrollAfter("Length " + std::to_string(lengthPulses), Color(0xA000FF));
         return true;
     }
 
@@ -513,6 +550,7 @@ bool EventDetailView::VelocitySelectorKeyHandler(Point xy, KeyInfo* keyInfo)
 
     if (keyInfo->State() == PRESSED)
     {
+        SequenceEvent before = selectedEventIter->second;
         uint8_t currentVelocity = noteData.velocity;
         if (currentVelocity >= slotMin && currentVelocity <= slotMax)
         {
@@ -536,13 +574,13 @@ bool EventDetailView::VelocitySelectorKeyHandler(Point xy, KeyInfo* keyInfo)
             noteData.velocity = std::clamp<uint8_t>(slotMin + 7, 1, 127);
         }
 
-        sequencer->sequence.SetDirty();
+        sequencer->sequence.PatternEventChanged(pattern, selectedEventIter->first, before, selectedEventIter->second);
         return true;
     }
     else if (keyInfo->State() == HOLD)
     {
         Color velocityColor = noteData.aftertouch ? aftertouchColor : noteColor;
-        MatrixOS::UIUtility::TextScroll("Velocity " + std::to_string(noteData.velocity), velocityColor);
+        ScrollAfter("Velocity " + std::to_string(noteData.velocity), velocityColor);
         return true;
     }
 
@@ -12,12 +12,15 @@ class EventDetailView : public UIComponent {
 
     bool wasEnabled = false;
 
-    vector<std::multimap<uint16_t, SequenceEvent>::iterator> eventRefs;
-    std::multimap<uint16_t, SequenceEvent>::iterator selectedEventIter;
+    vector<SequenceEventStore::iterator> eventRefs;
+    SequenceEventStore::iterator selectedEventIter;
     SequencePosition position;
     SequencePattern* pattern = nullptr;
+    uint16_t eventRevision = 0; // Pattern revision eventRefs were taken at
 
     uint32_t lastOnTime = 0;
+    string scrollText; // Text a key handler shows once KeyEvent has let go of the sequence
+    Color scrollColor;
 
     // UI parameters for displaying/editing event properties
     uint8_t selectedField = 0; // Which field is being edited
@@ -35,6 +38,7 @@ public:
 
 private:
     void RebuildEventList();
+    void ScrollAfter(const string& text, Color color);
 
     // Event selector (Y=0 row)
     void RenderEventSelector(Point origin);
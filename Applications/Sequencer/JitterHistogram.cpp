@@ -0,0 +1,54 @@
+#include "JitterHistogram.h"
+
+void JitterHistogram::Record(uint32_t lateness)
+{
+    // Bucket n holds [2^(n-1), 2^n) us
+    uint8_t bucket = lateness == 0 ? 0 : 32 - __builtin_clz(lateness);
+    if (bucket >= JITTER_HISTOGRAM_BUCKETS)
+    {
+        bucket = JITTER_HISTOGRAM_BUCKETS - 1;
+    }
+    buckets[bucket]++;
+    count++;
+    total += lateness;
+    if (lateness > max)
+    {
+        max = lateness;
+    }
+}
+
+void JitterHistogram::Reset()
+{
+    for (uint32_t& bucket : buckets)
+    {
+        bucket = 0;
+    }
+    count = 0;
+    max = 0;
+    total = 0;
+}
+
+void JitterHistogram::Report(const char* name)
+{
+    if (count == 0 || !MatrixOS::USB::CDC::Connected())
+    {
+        return;
+    }
+
+    MatrixOS::USB::CDC::Printf("%s jitter: %lu pulses, mean %lu us, max %lu us\r\n", name, (unsigned long)count, (unsigned long)(total / count), (unsigned long)max);
+    for (uint8_t i = 0; i < JITTER_HISTOGRAM_BUCKETS; i++)
+    {
+        if (buckets[i] == 0) continue;
+
+        uint32_t low = i == 0 ? 0 : 1UL << (i - 1);
+        if (i == JITTER_HISTOGRAM_BUCKETS - 1)
+        {
+            MatrixOS::USB::CDC::Printf("  >= %5lu us: %lu\r\n", (unsigned long)low, (unsigned long)buckets[i]);
+        }
+        else
+        {
+            MatrixOS::USB::CDC::Printf("  < %6lu us: %lu\r\n", (unsigned long)(i == 0 ? 1 : low << 1), (unsigned long)buckets[i]);
+        }
+    }
+    MatrixOS::USB::CDC::Flush();
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "MatrixOS.h"
+
+#define JITTER_HISTOGRAM_BUCKETS 16 // 0us, then power of two ranges up to 16ms and everything past it
+
+// How late the sequencer handles each pulse against its scheduled time
+class JitterHistogram
+{
+public:
+    void Record(uint32_t lateness); // Microseconds
+    void Reset();
+    void Report(const char* name); // Dump over USB CDC, if a host has it open
+
+private:
+    uint32_t buckets[JITTER_HISTOGRAM_BUCKETS] = {};
+    uint32_t count = 0;
+    uint32_t max = 0;
+    uint64_t total = 0;
+};
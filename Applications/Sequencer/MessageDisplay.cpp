@@ -447,6 +447,39 @@ void SequencerMessageDisplay::RenderUndo(Point origin, Color color)
     MatrixOS::LED::SetColor(origin + Point(7, 3), color);
 }
 
+void SequencerMessageDisplay::RenderRedo(Point origin, Color color)
+{
+    ClearRows(origin, 4);
+
+    // R
+    MatrixOS::LED::SetColor(origin + Point(0, 0), color);
+    MatrixOS::LED::SetColor(origin + Point(0, 1), color);
+    MatrixOS::LED::SetColor(origin + Point(0, 2), color);
+    MatrixOS::LED::SetColor(origin + Point(0, 3), color);
+    MatrixOS::LED::SetColor(origin + Point(1, 0), color);
+    MatrixOS::LED::SetColor(origin + Point(1, 2), color);
+    MatrixOS::LED::SetColor(origin + Point(2, 1), color);
+    MatrixOS::LED::SetColor(origin + Point(2, 3), color);
+
+    // d
+    MatrixOS::LED::SetColor(origin + Point(3, 2), Color::White);
+    MatrixOS::LED::SetColor(origin + Point(3, 3), Color::White);
+    MatrixOS::LED::SetColor(origin + Point(4, 0), Color::White);
+    MatrixOS::LED::SetColor(origin + Point(4, 1), Color::White);
+    MatrixOS::LED::SetColor(origin + Point(4, 2), Color::White);
+    MatrixOS::LED::SetColor(origin + Point(4, 3), Color::White);
+
+    // o
+    MatrixOS::LED::SetColor(origin + Point(5, 1), color);
+    MatrixOS::LED::SetColor(origin + Point(5, 2), color);
+    MatrixOS::LED::SetColor(origin + Point(5, 3), color);
+    MatrixOS::LED::SetColor(origin + Point(6, 1), color);
+    MatrixOS::LED::SetColor(origin + Point(6, 3), color);
+    MatrixOS::LED::SetColor(origin + Point(7, 1), color);
+    MatrixOS::LED::SetColor(origin + Point(7, 2), color);
+    MatrixOS::LED::SetColor(origin + Point(7, 3), color);
+}
+
 void SequencerMessageDisplay::RenderOctave(Point origin, Color color, bool positive)
 {
     ClearRows(origin, 4);
@@ -578,6 +611,16 @@ bool SequencerMessageDisplay::Render(Point origin)
                 }
                 break;
             }
+            case SequencerMessage::REDO:
+            case SequencerMessage::REDONE:
+            {
+                if(sequencer->CopyActive())
+                {
+                    Color redoColor = sequencer->lastMessage == SequencerMessage::REDO ? Color(0x0080FF) : successColor;
+                    RenderRedo(origin, redoColor);
+                }
+                break;
+            }
             case SequencerMessage::OCTAVE_PLUS:
             case SequencerMessage::OCTAVE_PLUS_DONE:
             {
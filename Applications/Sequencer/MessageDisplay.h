@@ -25,6 +25,7 @@ class SequencerMessageDisplay : public UIComponent {
     void RenderRecord(Point origin, Color color);
     void RenderResume(Point origin, Color color);
     void RenderUndo(Point origin, Color color);
+    void RenderRedo(Point origin, Color color);
     void RenderOctave(Point origin, Color color, bool positive);
 
     public:
@@ -0,0 +1,137 @@
+#include "NoteOffWheel.h"
+
+void NoteOffWheel::Clear()
+{
+    for (uint8_t& head : heads)
+    {
+        head = NOTE_OFF_NONE;
+    }
+    for (uint32_t& word : pending)
+    {
+        word = 0;
+    }
+    count = 0;
+    cursor = 0;
+    anchored = false; // Picks up the time from the next call
+}
+
+void NoteOffWheel::Link(uint8_t note)
+{
+    // Within a lap of level 0 it goes straight to its pulse, later ones wait in level 1 until their block comes up
+    uint32_t tick = ticks[note];
+    uint16_t slot;
+    if (tick - cursor <= NOTE_OFF_WHEEL_SLOTS)
+    {
+        slot = tick % NOTE_OFF_WHEEL_SLOTS;
+    }
+    else
+    {
+        slot = NOTE_OFF_WHEEL_SLOTS + (tick / NOTE_OFF_WHEEL_SLOTS) % NOTE_OFF_WHEEL_SLOTS;
+    }
+
+    list[note] = slot;
+    prev[note] = NOTE_OFF_NONE;
+    next[note] = heads[slot];
+    if (heads[slot] != NOTE_OFF_NONE)
+    {
+        prev[heads[slot]] = note;
+    }
+    heads[slot] = note;
+    pending[note >> 5] |= 1UL << (note & 31);
+    count++;
+}
+
+void NoteOffWheel::Unlink(uint8_t note)
+{
+    if (prev[note] == NOTE_OFF_NONE)
+    {
+        heads[list[note]] = next[note];
+    }
+    else
+    {
+        next[prev[note]] = next[note];
+    }
+    if (next[note] != NOTE_OFF_NONE)
+    {
+        prev[next[note]] = prev[note];
+    }
+    pending[note >> 5] &= ~(1UL << (note & 31));
+    count--;
+}
+
+void NoteOffWheel::Schedule(uint8_t note, uint32_t tick, uint32_t now)
+{
+    note &= 0x7F;
+    if (!anchored)
+    {
+        cursor = now - 1;
+        anchored = true;
+    }
+
+    Cancel(note);
+
+    // Already due goes out on the next tick processed
+    if ((int32_t)(tick - cursor) <= 0)
+    {
+        tick = cursor + 1;
+    }
+    ticks[note] = tick;
+    Link(note);
+}
+
+bool NoteOffWheel::Cancel(uint8_t note)
+{
+    note &= 0x7F;
+    if (!Pending(note))
+    {
+        return false;
+    }
+    Unlink(note);
+    return true;
+}
+
+uint8_t NoteOffWheel::Advance(uint32_t now, uint8_t expired[128])
+{
+    if (!anchored)
+    {
+        cursor = now - 1;
+        anchored = true;
+    }
+
+    uint8_t expiredCount = 0;
+    while ((int32_t)(now - cursor) > 0)
+    {
+        // Nothing pending, jump straight to now
+        if (count == 0)
+        {
+            cursor = now;
+            break;
+        }
+
+        uint32_t tick = cursor + 1;
+
+        // Entering a new level 1 block, bring its notes down to level 0
+        if (tick % NOTE_OFF_WHEEL_SLOTS == 0)
+        {
+            uint16_t slot = NOTE_OFF_WHEEL_SLOTS + (tick / NOTE_OFF_WHEEL_SLOTS) % NOTE_OFF_WHEEL_SLOTS;
+            uint8_t note = heads[slot];
+            while (note != NOTE_OFF_NONE)
+            {
+                uint8_t following = next[note];
+                Unlink(note);
+                Link(note);
+                note = following;
+            }
+        }
+        cursor = tick;
+
+        uint16_t slot = tick % NOTE_OFF_WHEEL_SLOTS;
+        while (heads[slot] != NOTE_OFF_NONE)
+        {
+            uint8_t note = heads[slot];
+            Unlink(note);
+            expired[expiredCount++] = note;
+        }
+    }
+    return expiredCount;
+}
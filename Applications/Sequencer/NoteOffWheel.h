@@ -0,0 +1,47 @@
+#pragma once
+
+#include "MatrixOS.h"
+
+#define NOTE_OFF_WHEEL_SLOTS 256 // Per level. Level 0 is 1 pulse a slot, level 1 is 256 pulses a slot, together they cover the longest note
+#define NOTE_OFF_NONE 0xFF
+
+// Pending note-offs of one track, hierarchical timing wheel keyed on pulse
+// Each of the 128 notes has its own entry, so scheduling, overwriting and expiring a note are all O(1)
+class NoteOffWheel
+{
+public:
+    NoteOffWheel() { Clear(); }
+
+    void Clear();
+    void Schedule(uint8_t note, uint32_t tick, uint32_t now); // Replaces the note's pending note-off, if it has one
+    bool Cancel(uint8_t note);
+    bool Pending(uint8_t note) const { return pending[note >> 5] & (1UL << (note & 31)); }
+    bool Empty() const { return count == 0; }
+    uint8_t Advance(uint32_t now, uint8_t expired[128]); // Collect every note due by now, returns how many
+
+    template <typename Callback>
+    void ForEachPending(Callback callback) const
+    {
+        for (uint8_t word = 0; word < 4; word++)
+        {
+            for (uint32_t bits = pending[word]; bits; bits &= bits - 1)
+            {
+                callback((uint8_t)(word * 32 + __builtin_ctz(bits)));
+            }
+        }
+    }
+
+private:
+    uint32_t ticks[128];
+    uint8_t next[128];
+    uint8_t prev[128];
+    uint16_t list[128]; // Slot the note is linked into, level 1 slots follow level 0
+    uint8_t heads[NOTE_OFF_WHEEL_SLOTS * 2];
+    uint32_t pending[4];
+    uint8_t count;
+    uint32_t cursor; // Last tick processed
+    bool anchored;
+
+    void Link(uint8_t note);
+    void Unlink(uint8_t note);
+};
@@ -363,9 +363,14 @@ bool SequencerNotePad::KeyEvent(Point xy, KeyInfo* keyInfo)
     {
         if(sequencer->noteSelected.count(note) != 0) // Incase we need to do first scan first
         {
-            uint8_t velocity = keyInfo->Value().to7bits();
+            Fract16 pressure = keyInfo->Value();
+            uint8_t velocity = pressure.to7bits();
             sequencer->noteSelected[note] = velocity;
-            packet = MidiPacket::AfterTouch(channel, note, velocity);
+
+            // Pressure goes out at full resolution, the OS scales it to 7 bits for MIDI 1.0 ports
+            MatrixOS::MIDI::SendUMP(UMP::PolyPressure(0, channel, note, UMP::Scale(pressure.value, 16, 32)), MIDI_PORT_ALL);
+            SequencerEvent(MidiPacket::AfterTouch(channel, note, velocity));
+            return true;
         }
     }
     else if(keyInfo->state == RELEASED)
@@ -0,0 +1,47 @@
+#include "OutputRing.h"
+
+bool OutputRing::Push(uint32_t pulse, uint8_t track, const MidiPacket& packet)
+{
+    uint32_t position = head.load(std::memory_order_relaxed);
+    if (position - tail.load(std::memory_order_acquire) >= OUTPUT_RING_SIZE)
+    {
+        return false;
+    }
+
+    entries[position % OUTPUT_RING_SIZE] = {pulse, track, packet};
+    head.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+uint16_t OutputRing::Release(uint32_t pulse, span<Entry> dest)
+{
+    uint32_t start = tail.load(std::memory_order_acquire);
+    while (true)
+    {
+        uint32_t end = head.load(std::memory_order_acquire);
+        uint32_t position = start;
+        uint16_t count = 0;
+
+        // Entries go in pulse order, stop at the first one still in the future
+        while (position != end && count < dest.size() && (int32_t)(entries[position % OUTPUT_RING_SIZE].pulse - pulse) <= 0)
+        {
+            dest[count++] = entries[position % OUTPUT_RING_SIZE];
+            position++;
+        }
+
+        // The slots can't be reused while tail still points at them, so what was copied is valid if nobody else took it
+        if (count == 0 || tail.compare_exchange_strong(start, position, std::memory_order_acq_rel))
+        {
+            return count;
+        }
+    }
+}
+
+void OutputRing::Clear()
+{
+    uint32_t start = tail.load(std::memory_order_acquire);
+    uint32_t end = head.load(std::memory_order_acquire);
+    while (start != end && !tail.compare_exchange_weak(start, end, std::memory_order_acq_rel))
+    {
+    }
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "MatrixOS.h"
+#include <atomic>
+
+#define OUTPUT_RING_SIZE 256 // Power of two
+
+// Rendered MIDI output waiting for its pulse, stamped with the pulse it is due on and the track it came from
+// Single producer (tick task renders ahead), lock-free. The clock task releases on time, Stop may drain
+// from another task at the same time, each entry goes to exactly one of them.
+class OutputRing
+{
+public:
+    struct Entry
+    {
+        uint32_t pulse;
+        uint8_t track;
+        MidiPacket packet;
+    };
+
+    bool Push(uint32_t pulse, uint8_t track, const MidiPacket& packet); // False when full
+    uint16_t Release(uint32_t pulse, span<Entry> dest); // Pop what is due by pulse, up to dest.size()
+    void Clear();
+
+private:
+    Entry entries[OUTPUT_RING_SIZE];
+    std::atomic<uint32_t> head{0}; // Written by the producer
+    std::atomic<uint32_t> tail{0}; // Written by the consumer
+};
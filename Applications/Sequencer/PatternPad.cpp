@@ -94,6 +94,7 @@ bool PatternPad::KeyEvent(Point xy, KeyInfo* keyInfo)
                 uint8_t srcPatternIdx = sequencer->copySource.pattern;
                 uint8_t srcStep = sequencer->copySource.step;
 
+                sequencer->sequence.PageInClip(srcTrack, srcClip);
                 SequencePattern* srcPatternPtr = sequencer->sequence.GetPattern(srcTrack, srcClip, srcPatternIdx);
 
                 // Clear destination step first
@@ -109,6 +110,10 @@ bool PatternPad::KeyEvent(Point xy, KeyInfo* keyInfo)
                     else
                     {
                         // Copy between different patterns - manually copy events
+                        SequenceLock lock(sequencer->sequence);
+                        sequencer->sequence.PatternNormalizeRecordLayers(srcPatternPtr);
+                        sequencer->sequence.PatternNormalizeRecordLayers(pattern);
+                        pattern->recordLayerMax = std::max(pattern->recordLayerMax, srcPatternPtr->recordLayerMax);
                         uint16_t srcStart = srcStep * pulsesPerStep;
                         uint16_t srcEnd = srcStart + pulsesPerStep - 1;
                         uint16_t destStart = step * pulsesPerStep;
@@ -119,7 +124,7 @@ bool PatternPad::KeyEvent(Point xy, KeyInfo* keyInfo)
                         {
                             uint16_t offset = it->first - srcStart;
                             uint16_t newTimestamp = destStart + offset;
-                            pattern->events.insert({newTimestamp, it->second});
+                            sequencer->sequence.PatternAddEvent(pattern, newTimestamp, it->second);
                             ++it;
                         }
                     }
@@ -151,6 +156,7 @@ bool PatternPad::KeyEvent(Point xy, KeyInfo* keyInfo)
             uint8_t channel = sequencer->sequence.GetChannel(track);
             
             // Remove notes from noteActive and send noteOff
+            SequenceLock lock(sequencer->sequence);
             auto it = pattern->events.lower_bound(startTime);
             while (it != pattern->events.end() && it->first <= endTime)
             {
@@ -201,6 +207,7 @@ bool PatternPad::KeyEvent(Point xy, KeyInfo* keyInfo)
         // Populate noteActive with notes from this step and send MIDI NoteOn - Only while not playing
         if(!sequencer->sequence.Playing())
         {
+            SequenceLock lock(sequencer->sequence);
             auto it = pattern->events.lower_bound(startTime);
             while (it != pattern->events.end() && it->first <= endTime)
             {
@@ -226,6 +233,7 @@ bool PatternPad::KeyEvent(Point xy, KeyInfo* keyInfo)
         // Clear noteActive from notes in this step and send MIDI NoteOff - Only while not playing
         if(!sequencer->sequence.Playing())
         {
+            SequenceLock lock(sequencer->sequence);
             auto eventIt = pattern->events.lower_bound(startTime);
             while (eventIt != pattern->events.end() && eventIt->first <= endTime)
             {
@@ -311,6 +319,7 @@ bool PatternPad::Render(Point origin)
         // Render single pattern
         SequencePattern* pattern = sequencer->sequence.GetPattern(track, clip, patternIdx);
         if (!pattern) { continue; }
+        SequenceLock lock(sequencer->sequence); // Recording may insert into it while this walks the events
 
         // Render Base
         bool whiteBase = false;
@@ -6,11 +6,95 @@ using std::vector;
 
 Sequence::Sequence(uint8_t tracks)
 {
+    clipSourceMutex = xSemaphoreCreateMutex();
+    editMutex = xSemaphoreCreateRecursiveMutex();
     New(tracks);
 }
 
+Sequence::~Sequence()
+{
+    MatrixOS::Clock::Unsubscribe(pulseHandle);
+    MatrixOS::Clock::Unsubscribe(renderHandle);
+    vSemaphoreDelete(clipSourceMutex);
+    vSemaphoreDelete(editMutex);
+}
+
+void Sequence::SetTickTask(TaskHandle_t task)
+{
+    // Unsubscribing waits out a pulse callback in flight, the old task is never woken after this
+    MatrixOS::Clock::Unsubscribe(pulseHandle);
+    MatrixOS::Clock::Unsubscribe(renderHandle);
+    pulseHandle = -1;
+    renderHandle = -1;
+    tickTask = task;
+    if (task == nullptr)
+    {
+        return;
+    }
+
+    pulseHandle = MatrixOS::Clock::Subscribe(PPQN, OnPulse, this);
+    renderHandle = MatrixOS::Clock::Subscribe(PPQN, OnRender, this);
+    MatrixOS::Clock::SetLead(renderHandle, LOOKAHEAD);
+    UpdateTiming();
+}
+
+void Sequence::Lock()
+{
+    xSemaphoreTakeRecursive(editMutex, portMAX_DELAY);
+}
+
+void Sequence::Unlock()
+{
+    xSemaphoreGiveRecursive(editMutex);
+}
+
+void Sequence::OnPulse(uint32_t tick, uint64_t time, void* context)
+{
+    // Runs on the clock task right at the pulse time, sends what was rendered for it
+    Sequence* self = static_cast<Sequence*>(context);
+    if (!self->playing.load(std::memory_order_acquire))
+    {
+        return;
+    }
+
+    uint32_t pulse = self->lastRelease.load(std::memory_order_relaxed) >> 32;
+    OutputRing::Entry entries[16];
+    MidiPacket batch[16];
+    uint16_t count;
+    while ((count = self->output.Release(pulse, entries)) > 0)
+    {
+        // Note-ons a track rendered before it was stopped would hang, its note-offs are gone
+        uint16_t send = 0;
+        for (uint16_t i = 0; i < count; i++)
+        {
+            if (entries[i].packet.status == EMidiStatus::NoteOn &&
+                (int32_t)(entries[i].pulse - self->trackCut[entries[i].track].load(std::memory_order_acquire)) < 0)
+            {
+                continue;
+            }
+            batch[send++] = entries[i].packet;
+        }
+        if (send > 0)
+        {
+            MatrixOS::MIDI::SendBatch(span<MidiPacket>(batch, send), MIDI_PORT_ALL);
+        }
+    }
+    self->lastRelease.store(((uint64_t)(pulse + 1) << 32) | (uint32_t)time, std::memory_order_release);
+    self->jitter.Record((uint32_t)(MatrixOS::SYS::Micros() - time));
+}
+
+void Sequence::OnRender(uint32_t tick, uint64_t time, void* context)
+{
+    Sequence* self = static_cast<Sequence*>(context);
+    if (self->playing.load(std::memory_order_acquire))
+    {
+        xTaskNotifyGive(self->tickTask);
+    }
+}
+
 void Sequence::New(uint8_t tracks)
 {
+    SequenceLock lock(*this);
     if (tracks > 32)
     {
         // Don't support 32+ tracks
@@ -51,7 +135,7 @@ void Sequence::New(uint8_t tracks)
     pulseSinceStart = 0;
     currentPulse = UINT16_MAX; // so first increment lands on pulse 0
     currentStep = 0;
-    lastPulseTime = 0;
+    lastRelease.store(0, std::memory_order_relaxed);
     lastRecordLayer = 0;
     currentRecordLayer = 0;
 
@@ -59,6 +143,10 @@ void Sequence::New(uint8_t tracks)
     data.mute = 0;
     data.record = 0xFFFFFFFF;
 
+    SetClipSource("");
+    StopJournal();
+    undo.Clear();
+
     dirty = true;
 
     UpdateTiming();
@@ -66,83 +154,87 @@ void Sequence::New(uint8_t tracks)
 
 void Sequence::Tick()
 {
-    uint32_t now = MatrixOS::SYS::Micros();
+    SequenceLock lock(*this);
+    // Render pulses as the OS clock brings them up, LOOKAHEAD ahead of their (swung) time
+    uint32_t pulses = MatrixOS::Clock::Ticks(renderHandle);
 
-    // Anchor clock on first tick
-    if (lastClockTime == 0) {
-        lastClockTime = now;
+    // Count-in runs off the clock position
+    if (clocksTillStart > 0) {
+        uint64_t position = MatrixOS::Clock::Position();
+        if (position >= startPosition) {
+            clocksTillStart = 0;
+        } else {
+            clocksTillStart = (startPosition - position + CLOCK_LENGTH - 1) / CLOCK_LENGTH;
+        }
     }
 
-    // Single loop: advance clock and pulses until nothing is due
-    while (true) {
-        now = MatrixOS::SYS::Micros();
-        bool progressed = false;
-
-        // Handle MIDI clock output and start countdown
-        if ((now - lastClockTime) >= usPerClock) {
-            if (clockOutput) {
-                MatrixOS::MIDI::Send(MidiPacket::Clock(), MIDI_PORT_ALL);  // MIDI Clock message
-            }
-
-            lastClockTime += usPerClock; // advance by period to maintain phase
-
-            // Update MIDI clock counter (24 PPQN)
-            currentClock = (currentClock + 1) % 24;
+    if (!playing.load(std::memory_order_acquire)) {
+        return;
+    }
 
-            if (clocksTillStart > 0) {
-                clocksTillStart--;
-                if (clocksTillStart == 0) {
-                    // Initialize timing at this clock edge
-                    lastPulseTime = lastClockTime;
-                    currentPulse = UINT16_MAX; // next advance produces pulse 0
-                    pulseSinceStart = 0;
-                }
-            }
-            progressed = true;
+    for (; pulses > 0; pulses--) {
+        if (currentPulse == UINT16_MAX) {
+            currentPulse = 0; // first usable pulse
+        } else {
+            currentPulse++;
+            pulseSinceStart++;
         }
 
-        if (!playing || clocksTillStart > 0) {
-            break;
+        if (currentPulse >= pulsesPerStep) {
+            currentPulse = 0;
+            currentStep++;
         }
 
-        // Anchor pulse timer if uninitialized
-        if (lastPulseTime == 0) {
-            lastPulseTime = now;
-            currentPulse = UINT16_MAX; // so first increment hits 0
+        if (currentStep >= barLength) {
+            currentStep = 0;
         }
 
-        // Handle pulse advance
-        uint16_t period = usPerPulse[currentStep % 2];
-        if ((now - lastPulseTime) >= period) {
-            lastPulseTime += period; // advance by exact period
+        for (uint8_t track = 0; track < trackPlayback.size(); track++) {
+            ProcessTrack(track);
+            pulseOutputTracks.resize(pulseOutput.size(), track);
+        }
 
-            if (currentPulse == UINT16_MAX) {
-                currentPulse = 0; // first usable pulse
+        // Queue this pulse's output for the clock task to send on time
+        if (!pulseOutput.empty()) {
+            if ((int32_t)(renderedPulses - (uint32_t)(lastRelease.load(std::memory_order_acquire) >> 32)) < 0) {
+                // Fell behind, the pulse is already due
+                MatrixOS::MIDI::SendBatch(pulseOutput, MIDI_PORT_ALL);
             } else {
-                currentPulse++;
-                pulseSinceStart++;
-            }
-
-            if (currentPulse >= pulsesPerStep) {
-                currentPulse = 0;
-                currentStep++;
-            }
-
-            if (currentStep >= barLength) {
-                currentStep = 0;
-            }
-
-            for (uint8_t track = 0; track < trackPlayback.size(); track++) {
-                ProcessTrack(track);
+                for (size_t i = 0; i < pulseOutput.size(); i++) {
+                    if (!output.Push(renderedPulses, pulseOutputTracks[i], pulseOutput[i])) {
+                        MatrixOS::MIDI::Send(pulseOutput[i], MIDI_PORT_ALL);
+                    }
+                }
             }
-
-            progressed = true;
+            pulseOutput.clear();
+            pulseOutputTracks.clear();
         }
+        renderedPulses++;
+    }
+}
 
-        if (!progressed) {
-            break; // nothing due right now
-        }
+// Start on a MIDI clock edge, clocks from now (1 is the next edge)
+void Sequence::ScheduleStart(int16_t clocks)
+{
+    // Leave the first pulses time to render
+    uint64_t position = MatrixOS::Clock::Position();
+    uint64_t lookahead = (uint64_t)(LOOKAHEAD * 2 * MatrixOS::Clock::GetBPM() / 60000000.0f * (1ULL << 32));
+    startPosition = ((position + lookahead) / CLOCK_LENGTH + clocks) * CLOCK_LENGTH;
+    clocksTillStart = (startPosition - position + CLOCK_LENGTH - 1) / CLOCK_LENGTH;
+    currentPulse = UINT16_MAX; // first pulse lands on 0
+    pulseSinceStart = 0;
+    renderedPulses = 0;
+    lastRelease.store(0, std::memory_order_relaxed);
+    output.Clear();
+    for (std::atomic<uint32_t>& cut : trackCut) {
+        cut.store(0, std::memory_order_relaxed);
     }
+    jitter.Reset();
+
+    // Line the swing pattern up with the step we start on
+    uint32_t phase = (currentStep % 2) * pulsesPerStep;
+    MatrixOS::Clock::Restart(pulseHandle, startPosition, phase);
+    MatrixOS::Clock::Restart(renderHandle, startPosition, phase);
 }
 
 void Sequence::UpdateTiming()
@@ -156,8 +248,8 @@ void Sequence::UpdateTiming()
     // Base pulse timing stays tied to PPQN; pulsesPerStep only controls when we advance a step
     uint32_t pulseUs = 60000000UL / (data.bpm * PPQN);
 
-    // Calculate clock timing (24 PPQN standard)
-    usPerClock = 60000000UL / (data.bpm * 24);
+    // MIDI clock (24 PPQN standard) runs on the OS clock
+    MatrixOS::Clock::SetBPM(data.bpm);
 
     // Apply swing based on 20-80 range with 50 as center (no swing)
     // Convert swing amount (20-80) to ratio (-0.3 to +0.3)
@@ -171,8 +263,12 @@ void Sequence::UpdateTiming()
     usPerPulse[0] = pulseUs + swingUs;  // On-beat (longer with positive swing)
     usPerPulse[1] = pulseUs - swingUs;  // Off-beat (shorter with positive swing)
 
+    // The OS clock applies the same swing when it schedules our pulses
+    MatrixOS::Clock::SetSwing(pulseHandle, pulsesPerStep, swingRatio);
+    MatrixOS::Clock::SetSwing(renderHandle, pulsesPerStep, swingRatio);
+
     MLOGD("Sequence",
-          "Timing Updated - BPM:%u Swing:%u StepDiv:%u PatternLen:%u BarLen:%u Beats:%u/%u pulses/step:%u usPerPulse[%lu,%lu] usPerClock:%lu",
+          "Timing Updated - BPM:%u Swing:%u StepDiv:%u PatternLen:%u BarLen:%u Beats:%u/%u pulses/step:%u usPerPulse[%lu,%lu]",
           data.bpm,
           data.swing,
           stepDivision,
@@ -182,8 +278,7 @@ void Sequence::UpdateTiming()
           data.beatUnit,
           pulsesPerStep,
           (unsigned long)usPerPulse[0],
-          (unsigned long)usPerPulse[1],
-          (unsigned long)usPerClock);
+          (unsigned long)usPerPulse[1]);
 }
 
 // Playback control
@@ -208,14 +303,16 @@ void Sequence::PlayClip(uint8_t track, uint8_t clip)
     {
         clip = 254;
     }
+    else
+    {
+        PageInClip(track, clip);
+    }
 
     // Initialize timing if not already playing
-    if (!playing) {
-        playing = true;
-        clocksTillStart = record ? 24 * 4 + 1 : 1;
-        currentPulse = UINT16_MAX;
+    if (!playing.load(std::memory_order_acquire)) {
         currentStep = 0;
-        pulseSinceStart = 0;
+        ScheduleStart(record ? 24 * 4 + 1 : 1);
+        playing.store(true, std::memory_order_release);
         currentRecordLayer = 0;
 
         for (uint8_t i = 0; i < trackPlayback.size(); i++) {
@@ -227,8 +324,7 @@ void Sequence::PlayClip(uint8_t track, uint8_t clip)
             // Clear playback state
             trackPlayback[i].nextClip = 255;
             trackPlayback[i].playing = false;
-            trackPlayback[i].noteOffMap.clear();
-            trackPlayback[i].noteOffQueue.clear();
+            trackPlayback[i].noteOffs.Clear();
         }
 
         MatrixOS::MIDI::Send(MidiPacket::Start(), MIDI_PORT_ALL);
@@ -253,6 +349,7 @@ void Sequence::PlayFrom(uint8_t track, uint8_t clip, uint8_t pattern, uint8_t st
 {
     // Validate clip exists
     if (!ClipExists(track, clip)) return;
+    PageInClip(track, clip);
 
     // Validate pattern exists
     if (pattern >= GetPatternCount(track, clip)) return;
@@ -265,11 +362,8 @@ void Sequence::PlayFrom(uint8_t track, uint8_t clip, uint8_t pattern, uint8_t st
     if (step >= targetPattern->steps) return;
 
     // Initialize timing if not already playing
-    if (!playing) {
-        playing = true;
-        clocksTillStart = record ? 24 * 4 + 1 : 1;
-        currentPulse = UINT16_MAX;
-        pulseSinceStart = 0;
+    bool starting = !playing.load(std::memory_order_acquire);
+    if (starting) {
         currentRecordLayer = 0;
 
         for (uint8_t i = 0; i < trackPlayback.size(); i++) {
@@ -282,8 +376,7 @@ void Sequence::PlayFrom(uint8_t track, uint8_t clip, uint8_t pattern, uint8_t st
             trackPlayback[i].nextClip = 255;
             trackPlayback[i].playing = false;
             trackPlayback[i].canResume = false;  // Clear resume state when starting fresh playback
-            trackPlayback[i].noteOffMap.clear();
-            trackPlayback[i].noteOffQueue.clear();
+            trackPlayback[i].noteOffs.Clear();
         }
     }
 
@@ -313,6 +406,11 @@ void Sequence::PlayFrom(uint8_t track, uint8_t clip, uint8_t pattern, uint8_t st
 
     // Set currentStep to sync with bar boundaries
     currentStep = stepSinceStart % barLength;
+
+    if (starting) {
+        ScheduleStart(record ? 24 * 4 + 1 : 1);
+        playing.store(true, std::memory_order_release);
+    }
 }
 
 void Sequence::Resume()
@@ -323,9 +421,8 @@ void Sequence::Resume()
     }
 
     // Initialize timing if not already playing
-    playing = true;
-    currentPulse = UINT16_MAX;
-    clocksTillStart = record ? 24 * 4 + 1 : 1;  // Count-in for recording, immediate otherwise
+    ScheduleStart(record ? 24 * 4 + 1 : 1);  // Count-in for recording, immediate otherwise
+    playing.store(true, std::memory_order_release);
 
     // Resume only tracks that were playing before stop
     for (uint8_t track = 0; track < trackPlayback.size(); track++) {
@@ -337,8 +434,7 @@ void Sequence::Resume()
             // Clear playback state
             trackPlayback[track].nextClip = 255;
             trackPlayback[track].playing = true;
-            trackPlayback[track].noteOffMap.clear();
-            trackPlayback[track].noteOffQueue.clear();
+            trackPlayback[track].noteOffs.Clear();
             trackPlayback[track].canResume = false;  // Clear after resuming
         }
     }
@@ -348,7 +444,7 @@ void Sequence::Resume()
 
 bool Sequence::CanResume()
 {
-    if(playing) return false;
+    if(playing.load(std::memory_order_acquire)) return false;
     for (uint8_t track = 0; track < trackPlayback.size(); track++) {
         if (trackPlayback[track].canResume) {
             return true;
@@ -359,7 +455,7 @@ bool Sequence::CanResume()
 
 bool Sequence::Playing()
 {
-    return playing;
+    return playing.load(std::memory_order_acquire);
 }
 
 bool Sequence::Playing(uint8_t track)
@@ -370,70 +466,61 @@ bool Sequence::Playing(uint8_t track)
 
 void Sequence::Stop()
 {
-    playing = false;
+    playing.store(false, std::memory_order_release);
     record = false;
     uint8_t sessionLayer = currentRecordLayer;
 
+    // Note-offs already handed to the output ring would never be released now
+    FlushOutput();
+
     // Send note-off for all queued notes before clearing
     for (uint8_t track = 0; track < trackPlayback.size(); track++) {
         uint8_t channel = GetChannel(track);
         TerminateRecordedNotes(track);
-        for (const auto& [note, tick] : trackPlayback[track].noteOffMap) {
+        trackPlayback[track].noteOffs.ForEachPending([channel](uint8_t note) {
             MatrixOS::MIDI::Send(MidiPacket::NoteOff(channel, note, 0), MIDI_PORT_ALL);
-        }
+        });
         MatrixOS::MIDI::Send(MidiPacket::ControlChange(channel, 120, 0), MIDI_PORT_ALL); // All sound off per channel
 
         // Save current position to resume position and mark if it can be resumed
         trackPlayback[track].resumePosition = trackPlayback[track].position;
         trackPlayback[track].canResume = trackPlayback[track].playing;
 
-        trackPlayback[track].noteOffMap.clear();
-        trackPlayback[track].noteOffQueue.clear();
+        trackPlayback[track].noteOffs.Clear();
         trackPlayback[track].nextClip = 255;
         trackPlayback[track].playing = false;
     }
     
     MatrixOS::MIDI::Send(MidiPacket::Stop(), MIDI_PORT_ALL);
 
+    // Patterns apply the shift themselves the next time they are recorded into, copied or undone
     if (sessionLayer > 127 && lastRecordLayer > 127)
     {
-        for (auto& track : data.tracks)
-        {
-            for (auto& clipPair : track.clips)
-            {
-                for (auto& pattern : clipPair.second.patterns)
-                {
-                    for (auto& ev : pattern.events)
-                    {
-                        if (ev.second.eventType == SequenceEventType::NoteEvent)
-                        {
-                            int16_t rl = ev.second.recordLayer - 127;
-                            ev.second.recordLayer = rl > 0 ? rl : 0;
-                        }
-                    }
-                }
-            }
-        }
+        recordLayerEpoch++;
         lastRecordLayer = lastRecordLayer - 127;
     }
     currentRecordLayer = 0;
     clocksTillStart = 0;
+
+    jitter.Report("Sequencer");
 }
 
 void Sequence::Stop(uint8_t track)
 {
     if (track >= trackPlayback.size()) return;
 
+    // Note-ons this track already rendered ahead are dropped on release, its note-offs are sent below
+    trackCut[track].store(renderedPulses, std::memory_order_release);
+
     // Send note-off for all queued notes on this track before clearing
     uint8_t channel = GetChannel(track);
     TerminateRecordedNotes(track);
-    for (const auto& [note, tick] : trackPlayback[track].noteOffMap) {
+    trackPlayback[track].noteOffs.ForEachPending([channel](uint8_t note) {
         MatrixOS::MIDI::Send(MidiPacket::NoteOff(channel, note, 0), MIDI_PORT_ALL);
-    }
+    });
     MatrixOS::MIDI::Send(MidiPacket::ControlChange(channel, 120, 0), MIDI_PORT_ALL); // All sound off
 
-    trackPlayback[track].noteOffMap.clear();
-    trackPlayback[track].noteOffQueue.clear();
+    trackPlayback[track].noteOffs.Clear();
     trackPlayback[track].nextClip = 255;
     trackPlayback[track].playing = false;
 
@@ -446,13 +533,37 @@ void Sequence::Stop(uint8_t track)
         }
     }
     if (!anyPlaying) {
-        playing = false;
+        playing.store(false, std::memory_order_release);
+        FlushOutput();
         clocksTillStart = 0;
         trackPlayback[track].resumePosition = trackPlayback[track].position;
         MatrixOS::MIDI::Send(MidiPacket::Stop(), MIDI_PORT_ALL);
     }
 }
 
+// Take everything left in the output ring and send only its note-offs, for when the clock task won't release it anymore
+void Sequence::FlushOutput()
+{
+    OutputRing::Entry entries[16];
+    MidiPacket batch[16];
+    uint16_t count;
+    while ((count = output.Release(renderedPulses, entries)) > 0)
+    {
+        uint16_t send = 0;
+        for (uint16_t i = 0; i < count; i++)
+        {
+            if (entries[i].packet.status == EMidiStatus::NoteOff)
+            {
+                batch[send++] = entries[i].packet;
+            }
+        }
+        if (send > 0)
+        {
+            MatrixOS::MIDI::SendBatch(span<MidiPacket>(batch, send), MIDI_PORT_ALL);
+        }
+    }
+}
+
 void Sequence::StopAfter(uint8_t track)
 {
     if (track >= trackPlayback.size()) return;
@@ -476,15 +587,25 @@ bool Sequence::RecordEnabled()
     return record;
 }
 
+void Sequence::SetRecordQuantize(uint8_t strength)
+{
+    recordQuantize = std::min<uint8_t>(strength, 100);
+}
+
+uint8_t Sequence::GetRecordQuantize()
+{
+    return recordQuantize;
+}
+
 // Clock Output
 void Sequence::EnableClockOutput(bool val)
 {
-    clockOutput = val;
+    MatrixOS::Clock::EnableOutput(val);
 }
 
 bool Sequence::ClockOutputEnabled()
 {
-    return clockOutput;
+    return MatrixOS::Clock::OutputEnabled();
 }
 
 int16_t Sequence::GetClocksTillStart()
@@ -514,19 +635,24 @@ bool Sequence::ClipExists(uint8_t track, uint8_t clip)
 
 bool Sequence::NewClip(uint8_t track, uint8_t clipId)
 {
+    SequenceLock lock(*this);
     if (ClipExists(track, clipId)) return false;
 
     data.tracks[track].clips[clipId] = SequenceClip();
     data.tracks[track].clips[clipId].patterns.emplace_back();
     data.tracks[track].clips[clipId].patterns[0].steps = 16;
+    journal.LogClip(track, clipId, data.tracks[track].clips[clipId]);
     dirty = true;
     return true;
 }
 
 void Sequence::DeleteClip(uint8_t track, uint8_t clip)
 {
+    SequenceLock lock(*this);
     if (!ClipExists(track, clip)) return;
     data.tracks[track].clips.erase(clip);
+    journal.Log(JOURNAL_CLIP_DELETE, track, clip);
+    undo.Clear();
 
     // Update position if pointing to deleted clip
     if (trackPlayback[track].position.clip == clip)
@@ -554,6 +680,7 @@ void Sequence::DeleteClip(uint8_t track, uint8_t clip)
                 }
             }
             trackPlayback[track].position.clip = lowestClip;
+            PageInClip(track, lowestClip);
         }
         trackPlayback[track].position.pattern = 0;
         trackPlayback[track].position.step = 0;
@@ -563,6 +690,7 @@ void Sequence::DeleteClip(uint8_t track, uint8_t clip)
 
 void Sequence::CopyClip(uint8_t sourceTrack, uint8_t sourceClip, uint8_t destTrack, uint8_t destClip)
 {
+    SequenceLock lock(*this);
     if (sourceTrack == destTrack && sourceClip == destClip)
     {
         return;
@@ -570,19 +698,231 @@ void Sequence::CopyClip(uint8_t sourceTrack, uint8_t sourceClip, uint8_t destTra
 
     // Check if source clip exists
     if (!ClipExists(sourceTrack, sourceClip)) return;
+    PageInClip(sourceTrack, sourceClip);
 
     // If destination clip exists, delete it first
     if (ClipExists(destTrack, destClip))
     {
         data.tracks[destTrack].clips.erase(destClip);
+        journal.Log(JOURNAL_CLIP_DELETE, destTrack, destClip);
     }
 
     // Copy entire clip
     data.tracks[destTrack].clips[destClip] = data.tracks[sourceTrack].clips[sourceClip];
+    journal.LogClip(destTrack, destClip, data.tracks[destTrack].clips[destClip]);
+    undo.Clear();
 
     dirty = true;
 }
 
+// Clip paging
+void Sequence::SetClipSource(const string& path)
+{
+    LockClipSource();
+    clipSource = path;
+    savedClips.clear();
+    savedClipsPending = false;
+    UnlockClipSource();
+}
+
+const string& Sequence::GetClipSource()
+{
+    LockClipSource();
+    ApplySavedClips();
+    UnlockClipSource();
+    return clipSource;
+}
+
+void Sequence::LockClipSource()
+{
+    xSemaphoreTake(clipSourceMutex, portMAX_DELAY);
+}
+
+void Sequence::UnlockClipSource()
+{
+    xSemaphoreGive(clipSourceMutex);
+}
+
+void Sequence::ClipsSaved(const string& path, vector<SequenceClipLocation>& locations)
+{
+    savedClipSource = path;
+    savedClips.swap(locations);
+    savedClipsPending = true;
+}
+
+void Sequence::ApplySavedClips()
+{
+    // Caller holds the clip source lock
+    if (!savedClipsPending) return;
+
+    // Clips changed since that save leave the sequence dirty, which keeps them from being evicted
+    for (const auto& location : savedClips)
+    {
+        if (location.track >= data.tracks.size()) continue;
+        auto it = data.tracks[location.track].clips.find(location.clip);
+        if (it == data.tracks[location.track].clips.end()) continue;
+        it->second.fileOffset = location.offset;
+        it->second.fileLength = location.length;
+    }
+    clipSource = savedClipSource;
+    savedClips.clear();
+    savedClipsPending = false;
+}
+
+bool Sequence::LoadClip(uint8_t track, uint8_t clip, SequenceClip& target)
+{
+    // A save may have replaced the file since the caller looked, pick up its offsets under the same lock
+    LockClipSource();
+    ApplySavedClips();
+    File file = MatrixOS::FileSystem::Open(clipSource, "rb");
+    bool loaded = false;
+    if (!file.Name().empty())
+    {
+        loaded = DeserializeSequenceClip(file, target);
+        file.Close();
+    }
+    UnlockClipSource();
+    if (!loaded)
+    {
+        MLOGE("Sequence", "Page in failed t=%u c=%u from %s", track, clip, clipSource.c_str());
+        return false;
+    }
+
+    // Same as a full load, empty patterns follow the pattern length
+    for (auto& pattern : target.patterns)
+    {
+        if (pattern.events.empty()) { pattern.steps = data.patternLength; }
+    }
+    MLOGD("Sequence", "Paged in t=%u c=%u patterns=%zu", track, clip, target.patterns.size());
+    return true;
+}
+
+bool Sequence::PageInClip(uint8_t track, uint8_t clip)
+{
+    if (track >= data.tracks.size()) return false;
+
+    auto it = data.tracks[track].clips.find(clip);
+    if (it == data.tracks[track].clips.end()) return false;
+    SequenceClip& target = it->second;
+    target.lastUse = ++clipUseCount;
+    if (target.resident) return true;
+
+    if (!LoadClip(track, clip, target)) return false;
+    EvictClips();
+    return true;
+}
+
+bool Sequence::PageInAllClips()
+{
+    bool ok = true;
+    for (uint8_t track = 0; track < data.tracks.size(); track++)
+    {
+        for (auto& [clipId, clip] : data.tracks[track].clips)
+        {
+            if (clip.resident) continue;
+            if (!LoadClip(track, clipId, clip)) { ok = false; }
+        }
+    }
+    return ok;
+}
+
+void Sequence::EvictClips()
+{
+    SequenceLock lock(*this);
+    // Only clips that match the slot file can be read back
+    if (dirty || clipSource.empty()) return;
+
+    while (true)
+    {
+        uint16_t resident = 0;
+        SequenceClip* oldest = nullptr;
+        for (uint8_t track = 0; track < data.tracks.size(); track++)
+        {
+            for (auto& [clipId, clip] : data.tracks[track].clips)
+            {
+                if (!clip.resident) continue;
+                resident++;
+
+                // Playback reads current and queued clips without paging, and the clip just paged in is about to be one
+                if (clip.fileLength == 0 || clip.lastUse == clipUseCount) continue;
+                if (track < trackPlayback.size() && (trackPlayback[track].position.clip == clipId || trackPlayback[track].nextClip == clipId)) continue;
+                if (!oldest || clip.lastUse < oldest->lastUse) { oldest = &clip; }
+            }
+        }
+        if (resident <= SEQUENCE_RESIDENT_CLIPS || !oldest) return;
+
+        vector<SequencePattern>().swap(oldest->patterns);
+        oldest->resident = false;
+    }
+}
+
+// Edit journal
+void Sequence::StartJournal()
+{
+    journal.Start();
+}
+
+void Sequence::StopJournal()
+{
+    journal.Stop();
+}
+
+bool Sequence::JournalActive()
+{
+    return journal.Active();
+}
+
+bool Sequence::AppendJournal(File& file, bool begin, uint32_t& records)
+{
+    CborWriter out(file);
+    records = journal.Append(out, data, begin);
+    return out.Flush();
+}
+
+bool Sequence::ReplayJournal(File& file, uint32_t& records)
+{
+    CborReader in(file);
+    SequenceJournalRecord record;
+    records = 0;
+    if (!SequenceJournal::ReadRecord(in, record) || record.tag != JOURNAL_BEGIN || record.fields[0] == 0 || record.fields[0] > SEQUENCE_JOURNAL_VERSION)
+    {
+        MLOGW("Sequence", "Journal - missing or unsupported header");
+        return false;
+    }
+
+    bool complete = true;
+    while (!in.AtEnd())
+    {
+        // A reset in the middle of an append leaves part of a record at the end
+        if (!SequenceJournal::ReadRecord(in, record))
+        {
+            MLOGW("Sequence", "Journal - partial record after %u records", (unsigned)records);
+            complete = false;
+            break;
+        }
+        if (record.HasClip()) { PageInClip(record.Track(), record.Clip()); }
+        Lock();
+        bool applied = SequenceJournal::Apply(data, record);
+        Unlock();
+        if (applied)
+        {
+            journal.LogRecord(record); // Written again if the journal has to start over
+        }
+        else
+        {
+            MLOGW("Sequence", "Journal - record %u (tag %u) does not fit the sequence", (unsigned)records, record.tag);
+        }
+        records++;
+    }
+
+    if (records > 0)
+    {
+        UpdateTiming();
+        dirty = true;
+    }
+    return complete;
+}
+
 // Pattern management (now with clip parameter)
 uint8_t Sequence::GetPatternCount(uint8_t track, uint8_t clip)
 {
@@ -600,6 +940,7 @@ SequencePattern* Sequence::GetPattern(uint8_t track, uint8_t clip, uint8_t patte
 
 int8_t Sequence::NewPattern(uint8_t track, uint8_t clip, uint8_t steps)
 {
+    SequenceLock lock(*this);
     if (!ClipExists(track, clip)) return -1;
     if (data.tracks[track].clips[clip].patterns.size() >= SEQUENCE_MAX_PATTERN_COUNT) {return -1;}
 
@@ -608,17 +949,22 @@ int8_t Sequence::NewPattern(uint8_t track, uint8_t clip, uint8_t steps)
 
     data.tracks[track].clips[clip].patterns.emplace_back();
     data.tracks[track].clips[clip].patterns.back().steps = actualLength;
+    uint8_t index = data.tracks[track].clips[clip].patterns.size() - 1;
+    journal.Log(JOURNAL_PATTERN_COUNT, track, clip, 0, index + 1);
+    journal.Log(JOURNAL_PATTERN_LENGTH, track, clip, index, actualLength);
     dirty = true;
-    return data.tracks[track].clips[clip].patterns.size() - 1;
+    return index;
 }
 
 void Sequence::ClearAllStepsInClip(uint8_t track, uint8_t clip)
 {
+    SequenceLock lock(*this);
     if (!ClipExists(track, clip)) return;
 
     auto& patterns = data.tracks[track].clips[clip].patterns;
     for (auto& pattern : patterns)
     {
+        LogEvents(SequenceUndoOp::RemoveEvent, &pattern, pattern.events);
         pattern.Clear();
     }
     dirty = true;
@@ -626,9 +972,11 @@ void Sequence::ClearAllStepsInClip(uint8_t track, uint8_t clip)
 
 bool Sequence::PatternClearAll(SequencePattern* pattern)
 {
+    SequenceLock lock(*this);
     if (!pattern) return false;
     if (!pattern->events.empty())
     {
+        LogEvents(SequenceUndoOp::RemoveEvent, pattern, pattern->events);
         pattern->events.clear();
         dirty = true;
     }
@@ -637,16 +985,19 @@ bool Sequence::PatternClearAll(SequencePattern* pattern)
 
 bool Sequence::PatternAddEvent(SequencePattern* pattern, uint16_t timestamp, const SequenceEvent& event)
 {
+    SequenceLock lock(*this);
     if (!pattern) return false;
     uint32_t patternLimit = pattern->steps * pulsesPerStep;
     if (timestamp >= patternLimit) return false;
     pattern->events.insert({timestamp, event});
+    LogEvent(SequenceUndoOp::AddEvent, pattern, timestamp, event);
     dirty = true;
     return true;
 }
 
 bool Sequence::PatternHasEventInRange(SequencePattern* pattern, uint16_t startTime, uint16_t endTime, SequenceEventType type)
 {
+    SequenceLock lock(*this);
     if (!pattern) return false;
     auto it = pattern->events.lower_bound(startTime);
     while (it != pattern->events.end() && it->first <= endTime)
@@ -662,6 +1013,7 @@ bool Sequence::PatternHasEventInRange(SequencePattern* pattern, uint16_t startTi
 
 bool Sequence::PatternClearNotesInRange(SequencePattern* pattern, uint16_t startTime, uint16_t endTime, uint8_t note)
 {
+    SequenceLock lock(*this);
     if (!pattern) return false;
     bool removed = false;
     for (auto it = pattern->events.lower_bound(startTime); it != pattern->events.end() && it->first <= endTime; )
@@ -671,6 +1023,7 @@ bool Sequence::PatternClearNotesInRange(SequencePattern* pattern, uint16_t start
             const SequenceEventNote& n = std::get<SequenceEventNote>(it->second.data);
             if (n.note == note)
             {
+                LogEvent(SequenceUndoOp::RemoveEvent, pattern, it->first, it->second);
                 it = pattern->events.erase(it);
                 removed = true;
                 continue;
@@ -684,60 +1037,46 @@ bool Sequence::PatternClearNotesInRange(SequencePattern* pattern, uint16_t start
 
 bool Sequence::PatternOffsetNotesInRange(SequencePattern* pattern, uint16_t startTime, uint16_t endTime, int8_t offset)
 {
+    SequenceLock lock(*this);
     if (!pattern || offset == 0) return false;
 
-    std::vector<std::pair<uint16_t, SequenceEvent>> eventsToModify;
-    std::vector<decltype(pattern->events)::iterator> eventsToRemove;
-
-    // Collect events that need modification
-    for (auto it = pattern->events.lower_bound(startTime); it != pattern->events.end() && it->first <= endTime; ++it)
+    // Timestamps don't change, so notes are modified in place
+    bool changed = false;
+    for (auto it = pattern->events.lower_bound(startTime); it != pattern->events.end() && it->first <= endTime; )
     {
         if (it->second.eventType == SequenceEventType::NoteEvent)
         {
-            SequenceEventNote noteData = std::get<SequenceEventNote>(it->second.data);
+            SequenceEventNote& noteData = std::get<SequenceEventNote>(it->second.data);
             int16_t newNote = noteData.note + offset;
+            changed = true;
+            LogEvent(SequenceUndoOp::RemoveEvent, pattern, it->first, it->second);
 
             // Delete notes that go out of valid MIDI range (0-127)
             if (newNote < 0 || newNote > 127)
             {
-                eventsToRemove.push_back(it);
-            }
-            else
-            {
-                // Update note value
-                noteData.note = (uint8_t)newNote;
-                SequenceEvent modifiedEvent = it->second;
-                modifiedEvent.data = noteData;
-                eventsToModify.push_back({it->first, modifiedEvent});
-                eventsToRemove.push_back(it);
+                it = pattern->events.erase(it);
+                continue;
             }
-        }
-    }
-
-    if (eventsToModify.empty() && eventsToRemove.empty()) return false;
 
-    // Remove old events
-    for (auto it : eventsToRemove)
-    {
-        pattern->events.erase(it);
-    }
-
-    // Insert modified events
-    for (const auto& [timestamp, event] : eventsToModify)
-    {
-        pattern->events.insert({timestamp, event});
+            // Update note value
+            noteData.note = (uint8_t)newNote;
+            LogEvent(SequenceUndoOp::AddEvent, pattern, it->first, it->second);
+        }
+        ++it;
     }
 
-    dirty = true;
-    return true;
+    if (changed) { dirty = true; }
+    return changed;
 }
 
 bool Sequence::PatternClearEventsInRange(SequencePattern* pattern, uint16_t startTime, uint16_t endTime)
 {
+    SequenceLock lock(*this);
     if (!pattern) return false;
     bool removed = false;
     for (auto it = pattern->events.lower_bound(startTime); it != pattern->events.end() && it->first <= endTime; )
     {
+        LogEvent(SequenceUndoOp::RemoveEvent, pattern, it->first, it->second);
         it = pattern->events.erase(it);
         removed = true;
     }
@@ -764,6 +1103,7 @@ bool Sequence::PatternCopyStepEvents(SequencePattern* pattern, uint8_t src, uint
 
 bool Sequence::PatternCopyEventsInRange(SequencePattern* pattern, uint16_t sourceStart, uint16_t destStart, uint16_t length)
 {
+    SequenceLock lock(*this);
     if (!pattern) return false;
     vector<std::pair<uint16_t, SequenceEvent>> eventsToCopy;
 
@@ -785,6 +1125,7 @@ bool Sequence::PatternCopyEventsInRange(SequencePattern* pattern, uint16_t sourc
     for (const auto& [timestamp, event] : eventsToCopy)
     {
         pattern->events.insert({timestamp, event});
+        LogEvent(SequenceUndoOp::AddEvent, pattern, timestamp, event);
     }
     dirty = true;
     return true;
@@ -792,6 +1133,7 @@ bool Sequence::PatternCopyEventsInRange(SequencePattern* pattern, uint16_t sourc
 
 bool Sequence::PatternSetLength(SequencePattern* pattern, uint8_t steps)
 {
+    SequenceLock lock(*this);
     if (!pattern) return false;
 
     // Remove any events that now fall beyond the new pattern length
@@ -800,6 +1142,7 @@ bool Sequence::PatternSetLength(SequencePattern* pattern, uint8_t steps)
     {
         if (it->first >= maxPulse)
         {
+            LogEvent(SequenceUndoOp::RemoveEvent, pattern, it->first, it->second);
             it = pattern->events.erase(it);
         }
         else
@@ -808,6 +1151,7 @@ bool Sequence::PatternSetLength(SequencePattern* pattern, uint8_t steps)
         }
     }
 
+    LogSteps(pattern, pattern->steps, steps);
     pattern->steps = steps;
     dirty = true;
     return true;
@@ -815,11 +1159,16 @@ bool Sequence::PatternSetLength(SequencePattern* pattern, uint8_t steps)
 
 bool Sequence::PatternQuantize(SequencePattern* pattern, SequencePattern* patternNext, uint16_t stepPulse)
 {
+    SequenceLock lock(*this);
     if (!pattern || stepPulse == 0) return false;
 
+    PatternNormalizeRecordLayers(pattern);
+    PatternNormalizeRecordLayers(patternNext);
+    if (patternNext) { patternNext->recordLayerMax = std::max(patternNext->recordLayerMax, pattern->recordLayerMax); }
+
     int32_t patternLen = pattern->steps * pulsesPerStep;
     
-    std::multimap<uint16_t, SequenceEvent> currentQuantized;
+    SequenceEventStore currentQuantized;
     bool changed = false;
 
     auto quantizeVal = [stepPulse](uint16_t val) -> uint16_t {
@@ -830,6 +1179,7 @@ bool Sequence::PatternQuantize(SequencePattern* pattern, SequencePattern* patter
     {
         uint16_t newTimestamp = quantizeVal(timestamp);
         SequenceEvent newEvent = ev;
+        if (newEvent.microtiming != 0) { newEvent.microtiming = 0; changed = true; }
 
         if (ev.eventType == SequenceEventType::NoteEvent)
         {
@@ -856,6 +1206,7 @@ bool Sequence::PatternQuantize(SequencePattern* pattern, SequencePattern* patter
                 {
                     // Distinct patternNext: Safe to insert directly
                     patternNext->events.insert({overflowTimestamp, newEvent});
+                    LogEvent(SequenceUndoOp::AddEvent, patternNext, overflowTimestamp, newEvent);
                 }
             }
         }
@@ -867,6 +1218,8 @@ bool Sequence::PatternQuantize(SequencePattern* pattern, SequencePattern* patter
 
     if (changed)
     {
+        LogEvents(SequenceUndoOp::RemoveEvent, pattern, pattern->events);
+        LogEvents(SequenceUndoOp::AddEvent, pattern, currentQuantized);
         pattern->events.swap(currentQuantized);
         dirty = true;
     }
@@ -876,6 +1229,7 @@ bool Sequence::PatternQuantize(SequencePattern* pattern, SequencePattern* patter
 
 bool Sequence::DualPatternQuantize(SequencePattern* pattern1, SequencePattern* pattern2, SequencePattern* patternNext, uint16_t stepPulse)
 {
+    SequenceLock lock(*this);
     if (!pattern2) return PatternQuantize(pattern1, patternNext, stepPulse);
     if (!pattern1 || stepPulse == 0) return false;
     PatternQuantize(pattern1, pattern2, stepPulse);
@@ -885,6 +1239,7 @@ bool Sequence::DualPatternQuantize(SequencePattern* pattern1, SequencePattern* p
 
 bool Sequence::PatternNudge(SequencePattern* pattern, int16_t offsetPulse)
 {
+    SequenceLock lock(*this);
     if (!pattern) return false;
 
     // Total pulses in the pattern
@@ -896,13 +1251,15 @@ bool Sequence::PatternNudge(SequencePattern* pattern, int16_t offsetPulse)
     if (normalized == 0) return true;
     if (normalized < 0) { normalized += patternLengthPulses; }
 
-    std::multimap<uint16_t, SequenceEvent> shifted;
+    SequenceEventStore shifted;
     for (const auto& [timestamp, ev] : pattern->events)
     {
         int32_t shiftedTs = (timestamp + normalized) % patternLengthPulses;
         shifted.insert({shiftedTs, ev});
     }
 
+    LogEvents(SequenceUndoOp::RemoveEvent, pattern, pattern->events);
+    LogEvents(SequenceUndoOp::AddEvent, pattern, shifted);
     pattern->events.swap(shifted);
     dirty = true;
     return true;
@@ -910,6 +1267,7 @@ bool Sequence::PatternNudge(SequencePattern* pattern, int16_t offsetPulse)
 
 bool Sequence::DualPatternNudge(SequencePattern* pattern1, SequencePattern* pattern2, int16_t offsetPulse)
 {
+    SequenceLock lock(*this);
     if (!pattern1) return false;
 
     // Fallback to single pattern logic if pattern2 is missing
@@ -917,6 +1275,10 @@ bool Sequence::DualPatternNudge(SequencePattern* pattern1, SequencePattern* patt
         return PatternNudge(pattern1, offsetPulse);
     }
 
+    PatternNormalizeRecordLayers(pattern1);
+    PatternNormalizeRecordLayers(pattern2);
+    pattern1->recordLayerMax = pattern2->recordLayerMax = std::max(pattern1->recordLayerMax, pattern2->recordLayerMax);
+
     // Calculate lengths
     int32_t len1 = pattern1->steps * pulsesPerStep;
     int32_t len2 = pattern2->steps * pulsesPerStep;
@@ -930,8 +1292,8 @@ bool Sequence::DualPatternNudge(SequencePattern* pattern1, SequencePattern* patt
     if (normalized < 0) { normalized += totalLen; }
 
     // Temporary storage for the new state of both patterns
-    std::multimap<uint16_t, SequenceEvent> newEvents1;
-    std::multimap<uint16_t, SequenceEvent> newEvents2;
+    SequenceEventStore newEvents1;
+    SequenceEventStore newEvents2;
 
     // --- Process Pattern 1 Events ---
     // These exist virtually from [0 to len1)
@@ -969,6 +1331,10 @@ bool Sequence::DualPatternNudge(SequencePattern* pattern1, SequencePattern* patt
     }
 
     // Apply changes
+    LogEvents(SequenceUndoOp::RemoveEvent, pattern1, pattern1->events);
+    LogEvents(SequenceUndoOp::RemoveEvent, pattern2, pattern2->events);
+    LogEvents(SequenceUndoOp::AddEvent, pattern1, newEvents1);
+    LogEvents(SequenceUndoOp::AddEvent, pattern2, newEvents2);
     pattern1->events.swap(newEvents1);
     pattern2->events.swap(newEvents2);
     dirty = true;
@@ -978,17 +1344,29 @@ bool Sequence::DualPatternNudge(SequencePattern* pattern1, SequencePattern* patt
 
 bool Sequence::PatternNudgeInRange(SequencePattern* pattern, uint16_t startTime, uint16_t length, int16_t offsetPulse, SequencePattern* prevPattern, SequencePattern* nextPattern)
 {
+    SequenceLock lock(*this);
     if (!pattern || offsetPulse == 0 || length == 0) return false;
 
     int32_t patternLengthPulses = pattern->steps * pulsesPerStep;
     if (patternLengthPulses == 0) return false;
 
+    PatternNormalizeRecordLayers(pattern);
+    PatternNormalizeRecordLayers(prevPattern);
+    PatternNormalizeRecordLayers(nextPattern);
+    if (prevPattern) { prevPattern->recordLayerMax = std::max(prevPattern->recordLayerMax, pattern->recordLayerMax); }
+    if (nextPattern) { nextPattern->recordLayerMax = std::max(nextPattern->recordLayerMax, pattern->recordLayerMax); }
+
     uint16_t endTime = startTime + length - 1;
     std::vector<std::pair<uint16_t, SequenceEvent>> eventsToMove;
-    std::vector<decltype(pattern->events)::iterator> eventsToRemove;
+    std::vector<std::pair<uint16_t, SequenceEvent>> eventsToPrev;
+    std::vector<std::pair<uint16_t, SequenceEvent>> eventsToNext;
+
+    // Every event in the range leaves it: moved, spilled into a neighbour, or discarded
+    auto first = pattern->events.lower_bound(startTime);
+    auto last = pattern->events.upper_bound(endTime);
+    if (first == last) return false;
 
-    // Collect events in the specified range
-    for (auto it = pattern->events.lower_bound(startTime); it != pattern->events.end() && it->first <= endTime; ++it)
+    for (auto it = first; it != last; ++it)
     {
         int32_t newTimestamp = (int32_t)it->first + offsetPulse;
 
@@ -996,67 +1374,110 @@ bool Sequence::PatternNudgeInRange(SequencePattern* pattern, uint16_t startTime,
         if (newTimestamp >= 0 && newTimestamp < patternLengthPulses)
         {
             eventsToMove.push_back({(uint16_t)newTimestamp, it->second});
-            eventsToRemove.push_back(it);
         }
-        // Check if event goes to previous pattern
+        // Check if event goes to previous pattern, discard if it can't fit
         else if (newTimestamp < 0 && prevPattern != nullptr)
         {
             int32_t prevPatternLength = prevPattern->steps * pulsesPerStep;
             int32_t prevTimestamp = prevPatternLength + newTimestamp;
             if (prevTimestamp >= 0 && prevTimestamp < prevPatternLength)
             {
-                prevPattern->events.insert({(uint16_t)prevTimestamp, it->second});
-                eventsToRemove.push_back(it);
-            }
-            // Discard if can't fit in previous pattern
-            else
-            {
-                eventsToRemove.push_back(it);
+                eventsToPrev.push_back({(uint16_t)prevTimestamp, it->second});
             }
         }
-        // Check if event goes to next pattern
+        // Check if event goes to next pattern, discard if it can't fit
         else if (newTimestamp >= patternLengthPulses && nextPattern != nullptr)
         {
             int32_t nextTimestamp = newTimestamp - patternLengthPulses;
             int32_t nextPatternLength = nextPattern->steps * pulsesPerStep;
             if (nextTimestamp >= 0 && nextTimestamp < nextPatternLength)
             {
-                nextPattern->events.insert({(uint16_t)nextTimestamp, it->second});
-                eventsToRemove.push_back(it);
-            }
-            // Discard if can't fit in next pattern
-            else
-            {
-                eventsToRemove.push_back(it);
+                eventsToNext.push_back({(uint16_t)nextTimestamp, it->second});
             }
         }
         // Discard if overflow and no prev/next pattern
-        else
-        {
-            eventsToRemove.push_back(it);
-        }
     }
 
-    if (eventsToMove.empty() && eventsToRemove.empty()) return false;
-
-    // Remove old events
-    for (auto it : eventsToRemove)
+    // Remove old events, then insert (a neighbour may be this same pattern)
+    for (auto it = first; it != last; ++it)
     {
-        pattern->events.erase(it);
+        LogEvent(SequenceUndoOp::RemoveEvent, pattern, it->first, it->second);
     }
+    pattern->events.erase(first, last);
 
-    // Insert moved events back into current pattern
-    for (const auto& [timestamp, event] : eventsToMove)
+    for (const auto& event : eventsToMove)
     {
-        pattern->events.insert({timestamp, event});
+        pattern->events.insert(event);
+        LogEvent(SequenceUndoOp::AddEvent, pattern, event.first, event.second);
+    }
+    for (const auto& event : eventsToPrev)
+    {
+        prevPattern->events.insert(event);
+        LogEvent(SequenceUndoOp::AddEvent, prevPattern, event.first, event.second);
+    }
+    for (const auto& event : eventsToNext)
+    {
+        nextPattern->events.insert(event);
+        LogEvent(SequenceUndoOp::AddEvent, nextPattern, event.first, event.second);
     }
 
     dirty = true;
     return true;
 }
 
+void Sequence::PatternNormalizeRecordLayers(SequencePattern* pattern)
+{
+    SequenceLock lock(*this);
+    if (!pattern || pattern->recordLayerEpoch == recordLayerEpoch) return;
+
+    if (pattern->recordLayerMax > 0)
+    {
+        uint32_t shift = (uint16_t)(recordLayerEpoch - pattern->recordLayerEpoch) * 127;
+        for (auto& ev : pattern->events)
+        {
+            if (ev.second.eventType == SequenceEventType::NoteEvent)
+            {
+                ev.second.recordLayer = ev.second.recordLayer > shift ? ev.second.recordLayer - shift : 0;
+            }
+        }
+        pattern->recordLayerMax = pattern->recordLayerMax > shift ? pattern->recordLayerMax - shift : 0;
+    }
+    pattern->recordLayerEpoch = recordLayerEpoch;
+}
+
+SequenceEventStore::iterator Sequence::PatternMoveEvent(SequencePattern* pattern, SequenceEventStore::iterator event, uint16_t timestamp)
+{
+    SequenceLock lock(*this);
+    if (event->first == timestamp) return event;
+    std::pair<uint16_t, SequenceEvent> moved = {timestamp, event->second};
+    LogEvent(SequenceUndoOp::RemoveEvent, pattern, event->first, event->second);
+    pattern->events.erase(event);
+    LogEvent(SequenceUndoOp::AddEvent, pattern, moved.first, moved.second);
+    dirty = true;
+    return pattern->events.insert(moved);
+}
+
+void Sequence::PatternRemoveEvent(SequencePattern* pattern, SequenceEventStore::iterator event)
+{
+    SequenceLock lock(*this);
+    LogEvent(SequenceUndoOp::RemoveEvent, pattern, event->first, event->second);
+    pattern->events.erase(event);
+    dirty = true;
+}
+
+void Sequence::PatternEventChanged(SequencePattern* pattern, uint16_t timestamp, const SequenceEvent& before, const SequenceEvent& after)
+{
+    if (!before.Same(after))
+    {
+        LogEvent(SequenceUndoOp::RemoveEvent, pattern, timestamp, before);
+        LogEvent(SequenceUndoOp::AddEvent, pattern, timestamp, after);
+    }
+    dirty = true;
+}
+
 void Sequence::DeletePattern(uint8_t track, uint8_t clip, uint8_t pattern)
 {
+    SequenceLock lock(*this);
     if (!ClipExists(track, clip)) return;
 
     auto& patterns = data.tracks[track].clips[clip].patterns;
@@ -1065,11 +1486,14 @@ void Sequence::DeletePattern(uint8_t track, uint8_t clip, uint8_t pattern)
     if (patterns.size() == 1)
     {
         // Clear instead of delete (keep at least 1 pattern)
+        LogEvents(SequenceUndoOp::RemoveEvent, &patterns[0], patterns[0].events);
         patterns[0].Clear();
     }
     else
     {
         patterns.erase(patterns.begin() + pattern);
+        journal.Log(JOURNAL_PATTERN_DELETE, track, clip, pattern);
+        undo.Clear(); // Later patterns moved down an index
 
         // Update position if pointing to this clip and pattern
         if (trackPlayback[track].position.clip == clip && trackPlayback[track].position.pattern >= pattern)
@@ -1085,17 +1509,21 @@ void Sequence::DeletePattern(uint8_t track, uint8_t clip, uint8_t pattern)
 
 void Sequence::CopyPattern(uint8_t sourceTrack, uint8_t sourceClip, uint8_t sourcePattern, uint8_t destTrack, uint8_t destClip, uint8_t destPattern)
 {
+    SequenceLock lock(*this);
     if (sourceTrack == destTrack && sourceClip == destClip && sourcePattern == destPattern)
     {
         return;
     }
 
     if (!ClipExists(sourceTrack, sourceClip) || !ClipExists(destTrack, destClip)) return;
+    PageInClip(sourceTrack, sourceClip);
+    PageInClip(destTrack, destClip);
 
     auto& sourcePatterns = data.tracks[sourceTrack].clips[sourceClip].patterns;
     if (sourcePattern >= sourcePatterns.size()) return;
 
     SequencePattern& source = sourcePatterns[sourcePattern];
+    PatternNormalizeRecordLayers(&source);
 
     if (destPattern == 255)
     {
@@ -1106,6 +1534,16 @@ void Sequence::CopyPattern(uint8_t sourceTrack, uint8_t sourceClip, uint8_t sour
         SequencePattern& dest = destPatterns.back();
         dest.steps = source.steps;
         dest.events = source.events;
+        dest.recordLayerMax = source.recordLayerMax;
+        dest.recordLayerEpoch = source.recordLayerEpoch;
+
+        uint8_t index = destPatterns.size() - 1;
+        journal.Log(JOURNAL_PATTERN_COUNT, destTrack, destClip, 0, index + 1);
+        journal.Log(JOURNAL_PATTERN_LENGTH, destTrack, destClip, index, dest.steps);
+        for (const auto& [timestamp, event] : dest.events)
+        {
+            journal.LogEvent(JOURNAL_EVENT_ADD, destTrack, destClip, index, timestamp, event);
+        }
     }
     else
     {
@@ -1113,8 +1551,13 @@ void Sequence::CopyPattern(uint8_t sourceTrack, uint8_t sourceClip, uint8_t sour
         auto& destPatterns = data.tracks[destTrack].clips[destClip].patterns;
         if (destPattern >= destPatterns.size()) return;
         SequencePattern& dest = destPatterns[destPattern];
+        LogEvents(SequenceUndoOp::RemoveEvent, &dest, dest.events);
+        LogSteps(&dest, dest.steps, source.steps);
+        LogEvents(SequenceUndoOp::AddEvent, &dest, source.events);
         dest.steps = source.steps;
         dest.events = source.events;
+        dest.recordLayerMax = source.recordLayerMax;
+        dest.recordLayerEpoch = source.recordLayerEpoch;
     }
     dirty = true;
 }
@@ -1130,6 +1573,7 @@ void Sequence::SetChannel(uint8_t track, uint8_t channel)
     if (data.tracks[track].channel != channel)
     {
         data.tracks[track].channel = channel;
+        journal.LogTrack(track);
         dirty = true;
     }
 }
@@ -1145,6 +1589,7 @@ void Sequence::SetBPM(uint16_t bpm)
     if (bpm != data.bpm)
     {
         data.bpm = bpm;
+        journal.LogSettings();
         UpdateTiming();
         dirty = true;
     }
@@ -1161,6 +1606,7 @@ void Sequence::SetSwing(uint8_t swing)
     if (swing != data.swing)
     {
         data.swing = swing;
+        journal.LogSettings();
         UpdateTiming();
         dirty = true;
     }
@@ -1194,12 +1640,14 @@ void Sequence::SetPatternLength(uint8_t patternLength)
     if (patternLength != data.patternLength)
     {
         data.patternLength = patternLength;
+        journal.LogSettings();
         dirty = true;
     }
 }
 
 void Sequence::UpdateEmptyPatternsWithPatternLength()
 {
+    SequenceLock lock(*this);
     // Iterate through all tracks
     for (uint8_t track = 0; track < data.tracks.size(); track++)
     {
@@ -1210,9 +1658,10 @@ void Sequence::UpdateEmptyPatternsWithPatternLength()
             for (auto& pattern : clip.patterns)
             {
                 // Only update patterns that are empty (no events)
-                if (pattern.events.empty())
+                if (pattern.events.empty() && pattern.steps != data.patternLength)
                 {
                     pattern.steps = data.patternLength;
+                    journal.Log(JOURNAL_PATTERN_LENGTH, track, clipId, &pattern - clip.patterns.data(), pattern.steps);
                 }
             }
         }
@@ -1252,6 +1701,7 @@ void Sequence::SetTimeSignature(uint8_t beatsPerBar, uint8_t beatUnit)
     if (changed)
     {
         UpdateTiming();
+        journal.LogSettings();
         dirty = true;
     }
 }
@@ -1286,6 +1736,7 @@ void Sequence::SetSolo(uint8_t track, bool val)
             data.solo = mask;
         else
             data.solo = 0;
+        journal.LogSettings();
 
         // Send all-notes-off on this track's channel when solo state changes
         uint8_t channel = GetChannel(track);
@@ -1321,6 +1772,7 @@ void Sequence::SetMute(uint8_t track, bool val)
             data.mute |= mask;
         else
             data.mute &= ~mask;
+        journal.LogSettings();
 
         // Send all-notes-off on this track's channel when mute state changes
         uint8_t channel = GetChannel(track);
@@ -1354,6 +1806,7 @@ void Sequence::SetRecord(uint8_t track, bool val)
             data.record |= mask;
         else
             data.record &= ~mask;
+        journal.LogSettings();
         dirty = true;
     }
 }
@@ -1375,8 +1828,7 @@ bool Sequence::GetEnabled(uint8_t track)
 bool Sequence::IsNoteActive(uint8_t track, uint8_t note) const
 {   
     if (track >= trackPlayback.size()) return false;
-    auto it = trackPlayback[track].noteOffMap.find(note);
-    return it != trackPlayback[track].noteOffMap.end();
+    return trackPlayback[track].noteOffs.Pending(note & 0x7F);
 }
 
 SequencePosition* Sequence::GetPosition(uint8_t track)
@@ -1388,6 +1840,7 @@ SequencePosition* Sequence::GetPosition(uint8_t track)
 void Sequence::SetPosition(uint8_t track, uint8_t clip, uint8_t pattern, uint8_t step)
 {
     if (track >= trackPlayback.size()) return;
+    PageInClip(track, clip);
     trackPlayback[track].position.clip = clip;
     trackPlayback[track].position.pattern = pattern;
     trackPlayback[track].position.step = step;
@@ -1398,10 +1851,12 @@ void Sequence::SetPosition(uint8_t track, uint8_t clip, uint8_t pattern, uint8_t
 void Sequence::SetClip(uint8_t track, uint8_t clip)
 {
     if (track >= trackPlayback.size()) return;
+    PageInClip(track, clip);
     trackPlayback[track].position.clip = clip;
     trackPlayback[track].position.pattern = 0;
     trackPlayback[track].position.step = 0;
     data.tracks[track].activeClip = clip;
+    journal.LogTrack(track);
     dirty = true;
 }
 
@@ -1421,6 +1876,7 @@ uint8_t Sequence::GetNextClip(uint8_t track)
 void Sequence::SetNextClip(uint8_t track, uint8_t clip)
 {
     if (track >= trackPlayback.size()) return;
+    PageInClip(track, clip);
     trackPlayback[track].nextClip = clip;
 }
 
@@ -1432,12 +1888,13 @@ uint32_t Sequence::GetLastEventTime(uint8_t track)
 
 Fract16 Sequence::GetStepProgress()
 {
-    if (!playing) {
+    if (!playing.load(std::memory_order_acquire)) {
         return 0;
     }
 
     uint32_t currentTime = MatrixOS::SYS::Micros();
     uint32_t usPerCurrentPulse = usPerPulse[currentStep % 2];
+    uint32_t lastPulseTime = (uint32_t)lastRelease.load(std::memory_order_relaxed);
     uint32_t timeElapsedSinceStep = (currentTime - lastPulseTime) + (currentPulse * usPerCurrentPulse);
     uint32_t usPerCurrentStep = usPerCurrentPulse * pulsesPerStep;
 
@@ -1465,15 +1922,8 @@ uint8_t Sequence::StepProgressBreath(uint8_t lowBound)
 Fract16 Sequence::GetQuarterNoteProgress()
 {
 
-    uint32_t usPerQuarterNote = usPerClock * 24; // Clock is 24PPQN
-    uint32_t timeElapsedSinceQuarterNote = (MatrixOS::SYS::Micros() - lastClockTime) + (usPerClock * currentClock);
-    // Use 64-bit arithmetic to avoid overflow when multiplying
-    uint64_t progress = ((uint64_t)timeElapsedSinceQuarterNote * UINT16_MAX) / usPerQuarterNote;
-    // Clamp to UINT16_MAX in case we're past the quarter note boundary
-    if (progress > UINT16_MAX) {
-        progress = UINT16_MAX;
-    }
-    return (Fract16)progress;
+    // Fractional part of the OS clock position is how far we are into the quarter note
+    return (Fract16)((MatrixOS::Clock::Position() >> 16) & UINT16_MAX);
 }
 
 uint8_t Sequence::QuarterNoteProgressBreath(uint8_t lowBound)
@@ -1489,8 +1939,9 @@ uint8_t Sequence::QuarterNoteProgressBreath(uint8_t lowBound)
     return (uint8_t)brightness;
 }
 
-void Sequence::RecordEvent(MidiPacket packet, uint8_t track)
+void Sequence::RecordEvent(MidiPacket packet, uint8_t track, uint32_t arrival)
 {
+    SequenceLock lock(*this);
     // if track is 0xff, determine based on the packet channel.
     if (!record) return;
 
@@ -1539,7 +1990,9 @@ void Sequence::RecordEvent(MidiPacket packet, uint8_t track)
 
         SequencePattern* pattern = GetPattern(t, clipIdx, patIdx);
         if (!pattern) continue;
-        uint32_t currentTick = 0;
+        int32_t currentTick = 0;
+        uint32_t heardPulse = 0; // pulseSinceStart of the moment it was played, for lengths
+        int8_t microtiming = 0;
         uint16_t pulse = trackPlayback[t].position.pulse;
         if (pulse == UINT16_MAX) {
             pulse = 0;
@@ -1547,8 +2000,21 @@ void Sequence::RecordEvent(MidiPacket packet, uint8_t track)
         if (clampToStart) {
             currentTick = trackPlayback[t].position.step * pulsesPerStep;
         } else {
-            currentTick = trackPlayback[t].position.step * pulsesPerStep + pulse;
+            // Playback renders ahead of what is heard, record where the output was when the packet came in
+            // One load, a pulse released in between would put the count and its time one pulse apart
+            uint64_t release = lastRelease.load(std::memory_order_acquire);
+            uint32_t released = release >> 32;
+            uint32_t ahead = renderedPulses - released;
+            currentTick = (int32_t)(trackPlayback[t].position.step * pulsesPerStep + pulse) - (int32_t)ahead;
+            heardPulse = pulseSinceStart - ahead;
+            if (playing.load(std::memory_order_acquire)) {
+                int32_t shift = ArrivalShift(arrival, released, (uint32_t)release, currentTick, microtiming);
+                currentTick += shift;
+                heardPulse += shift;
+            }
         }
+        // Ahead of the output or rounded past the end, it belongs to the pattern before or after
+        WrapRecordTick(t, clipIdx, patIdx, currentTick);
         auto& pending = trackPlayback[t].recordedNotes;
 
         if (status == EMidiStatus::NoteOn && velocity > 0)
@@ -1565,26 +2031,44 @@ void Sequence::RecordEvent(MidiPacket packet, uint8_t track)
             {
                 Sequence::TrackPlayback::RecordedNote prev = prevIt->second;
                 pending.erase(prevIt);
-                if (prev.eventPtr != nullptr)
-                {
-                    uint32_t prevLen = (pulseSinceStart > prev.startPulse) ? (pulseSinceStart - prev.startPulse) : 1;
-                    if (prevLen == 0) prevLen = 1;
-                    SequenceEventNote& prevNoteData = std::get<SequenceEventNote>(prev.eventPtr->data);
-                    if (prevLen > UINT16_MAX) prevLen = UINT16_MAX;
-                    prevNoteData.length = (uint16_t)prevLen;
-                    dirty = true;
-                }
+                uint32_t prevLen = (heardPulse > prev.startPulse) ? (heardPulse - prev.startPulse) : 1;
+                if (prevLen == 0) prevLen = 1;
+                if (prevLen > UINT16_MAX) prevLen = UINT16_MAX;
+                if (FinishRecordedNote(t, prev, note, prevLen)) { dirty = true; }
+            }
+
+            if (recordQuantize > 0 && !clampToStart)
+            {
+                // Pull toward the nearest step, in microtiming units so partial strengths keep their resolution
+                int32_t played = currentTick * SEQUENCE_MICROTIMING_STEPS + microtiming;
+                int32_t stepUnits = pulsesPerStep * SEQUENCE_MICROTIMING_STEPS;
+                int32_t grid = (played + stepUnits / 2) / stepUnits * stepUnits;
+                played += (grid - played) * recordQuantize / 100;
+                currentTick = (played + SEQUENCE_MICROTIMING_STEPS / 2) / SEQUENCE_MICROTIMING_STEPS;
+                microtiming = played - currentTick * SEQUENCE_MICROTIMING_STEPS;
+
+                // Pulled past the end, it heads the next pattern
+                WrapRecordTick(t, clipIdx, patIdx, currentTick);
             }
 
-            auto evIt = pattern->events.insert({(uint16_t)currentTick, SequenceEvent::Note(note, velocity, false, 0)});
+            pattern = GetPattern(t, clipIdx, patIdx);
+            PatternNormalizeRecordLayers(pattern);
+            SequenceEvent recorded = SequenceEvent::Note(note, velocity, false, 0);
+            recorded.microtiming = microtiming;
+            auto evIt = pattern->events.insert({(uint16_t)currentTick, recorded});
             SequenceEvent& evRef = evIt->second;
             if (evRef.eventType == SequenceEventType::NoteEvent)
             {
                 evRef.recordLayer = currentRecordLayer;
+                if (currentRecordLayer > pattern->recordLayerMax) { pattern->recordLayerMax = currentRecordLayer; }
             }
+            journal.LogEvent(JOURNAL_EVENT_ADD, t, clipIdx, patIdx, (uint16_t)currentTick, evRef);
             Sequence::TrackPlayback::RecordedNote info;
-            info.startPulse = clampToStart ? 0 : pulseSinceStart;
-            info.eventPtr = &evRef;
+            info.startPulse = heardPulse;
+            info.pattern = pattern;
+            info.clip = clipIdx;
+            info.index = patIdx;
+            info.timestamp = (uint16_t)currentTick;
             pending[note] = info;
             dirty = true;
         }
@@ -1596,15 +2080,11 @@ void Sequence::RecordEvent(MidiPacket packet, uint8_t track)
             Sequence::TrackPlayback::RecordedNote info = itPending->second;
             pending.erase(itPending);
 
-            if (info.eventPtr == nullptr) continue;
-
-            uint32_t length = (pulseSinceStart > info.startPulse) ? (pulseSinceStart - info.startPulse) : 1;
+            uint32_t length = ((int32_t)(heardPulse - info.startPulse) > 0) ? (heardPulse - info.startPulse) : 1;
             if (length > UINT16_MAX) length = UINT16_MAX;
             if (length == 0) length = 1;
 
-            SequenceEventNote& noteData = std::get<SequenceEventNote>(info.eventPtr->data);
-            noteData.length = (uint16_t)length;
-            dirty = true;
+            if (FinishRecordedNote(t, info, note, length)) { dirty = true; }
         }
         else
         {
@@ -1620,22 +2100,28 @@ bool Sequence::CanUndoLastRecord()
 
 void Sequence::UndoLastRecorded()
 {
+    SequenceLock lock(*this);
     if (lastRecordLayer == 0)
     {
         return;
     }
 
     bool removed = false;
-    for (auto& track : data.tracks)
+    for (uint8_t track = 0; track < data.tracks.size(); track++)
     {
-        for (auto& clipPair : track.clips)
+        for (auto& clipPair : data.tracks[track].clips)
         {
-            for (auto& pattern : clipPair.second.patterns)
+            auto& patterns = clipPair.second.patterns;
+            for (uint8_t index = 0; index < patterns.size(); index++)
             {
+                SequencePattern& pattern = patterns[index];
+                PatternNormalizeRecordLayers(&pattern);
+                if (pattern.recordLayerMax < lastRecordLayer) { continue; }
                 for (auto it = pattern.events.begin(); it != pattern.events.end();)
                 {
                     if (it->second.recordLayer == lastRecordLayer)
                     {
+                        LogEdit(SequenceUndoOp::RemoveEvent, track, clipPair.first, index, it->first, it->second);
                         it = pattern.events.erase(it);
                         removed = true;
                         continue;
@@ -1654,8 +2140,206 @@ void Sequence::UndoLastRecorded()
     }
 }
 
+// Edit history
+void Sequence::UndoMark()
+{
+    undo.Mark();
+}
+
+bool Sequence::CanUndo()
+{
+    return undo.CanUndo();
+}
+
+bool Sequence::CanRedo()
+{
+    return undo.CanRedo();
+}
+
+bool Sequence::Undo()
+{
+    SequenceLock lock(*this);
+    return undo.Undo([&](const SequenceUndoEntry& entry, bool forward) { ApplyUndo(entry, forward); });
+}
+
+bool Sequence::Redo()
+{
+    SequenceLock lock(*this);
+    return undo.Redo([&](const SequenceUndoEntry& entry, bool forward) { ApplyUndo(entry, forward); });
+}
+
+void Sequence::ClearUndo()
+{
+    undo.Clear();
+}
+
+bool Sequence::LocatePattern(const SequencePattern* pattern, uint8_t& track, uint8_t& clip, uint8_t& index)
+{
+    auto contains = [pattern](const SequenceClip& target) {
+        return !target.patterns.empty() && pattern >= target.patterns.data() && pattern < target.patterns.data() + target.patterns.size();
+    };
+
+    // Edits come in runs on one clip, so the clip found last time is tried first
+    if (undoTrack < data.tracks.size())
+    {
+        auto it = data.tracks[undoTrack].clips.find(undoClip);
+        if (it != data.tracks[undoTrack].clips.end() && contains(it->second))
+        {
+            track = undoTrack;
+            clip = undoClip;
+            index = pattern - it->second.patterns.data();
+            return true;
+        }
+    }
+
+    for (uint8_t t = 0; t < data.tracks.size(); t++)
+    {
+        for (auto& [clipId, target] : data.tracks[t].clips)
+        {
+            if (!contains(target)) continue;
+            track = undoTrack = t;
+            clip = undoClip = clipId;
+            index = pattern - target.patterns.data();
+            return true;
+        }
+    }
+    return false;
+}
+
+void Sequence::LogEvent(SequenceUndoOp op, const SequencePattern* pattern, uint16_t timestamp, const SequenceEvent& event)
+{
+    uint8_t track, clip, index;
+    if (LocatePattern(pattern, track, clip, index))
+    {
+        LogEdit(op, track, clip, index, timestamp, event);
+    }
+}
+
+void Sequence::LogEvents(SequenceUndoOp op, const SequencePattern* pattern, const SequenceEventStore& events)
+{
+    uint8_t track, clip, index;
+    if (events.empty() || !LocatePattern(pattern, track, clip, index)) return;
+    for (const auto& [timestamp, event] : events)
+    {
+        LogEdit(op, track, clip, index, timestamp, event);
+    }
+}
+
+void Sequence::LogSteps(const SequencePattern* pattern, uint8_t oldSteps, uint8_t newSteps)
+{
+    if (oldSteps == newSteps) return;
+    LogEvent(SequenceUndoOp::SetSteps, pattern, (oldSteps << 8) | newSteps, SequenceEvent{SequenceEventType::Invalid, SequenceEventNote{}});
+}
+
+void Sequence::LogEdit(SequenceUndoOp op, uint8_t track, uint8_t clip, uint8_t index, uint16_t timestamp, const SequenceEvent& event)
+{
+    undo.Log(op, track, clip, index, timestamp, event);
+    JournalEdit(op, true, track, clip, index, timestamp, event);
+}
+
+void Sequence::JournalEdit(SequenceUndoOp op, bool forward, uint8_t track, uint8_t clip, uint8_t index, uint16_t timestamp, const SequenceEvent& event)
+{
+    if (op == SequenceUndoOp::SetSteps)
+    {
+        journal.Log(JOURNAL_PATTERN_LENGTH, track, clip, index, forward ? (timestamp & 0xFF) : (timestamp >> 8));
+        return;
+    }
+    bool add = (op == SequenceUndoOp::AddEvent) == forward;
+    journal.LogEvent(add ? JOURNAL_EVENT_ADD : JOURNAL_EVENT_REMOVE, track, clip, index, timestamp, event);
+}
+
+void Sequence::ApplyUndo(const SequenceUndoEntry& entry, bool forward)
+{
+    PageInClip(entry.track, entry.clip);
+    SequencePattern* pattern = GetPattern(entry.track, entry.clip, entry.pattern);
+    if (!pattern) return;
+
+    if (entry.op == SequenceUndoOp::SetSteps)
+    {
+        pattern->steps = forward ? (entry.timestamp & 0xFF) : (entry.timestamp >> 8);
+    }
+    else if ((entry.op == SequenceUndoOp::AddEvent) == forward)
+    {
+        pattern->events.insert({entry.timestamp, entry.event});
+    }
+    else
+    {
+        // Events have no identity, any one that matches will do. Gone already if recording took it out since
+        auto range = pattern->events.equal_range(entry.timestamp);
+        auto it = range.first;
+        while (it != range.second && !it->second.Same(entry.event)) { ++it; }
+        if (it == range.second) return;
+        pattern->events.erase(it);
+    }
+    JournalEdit(entry.op, forward, entry.track, entry.clip, entry.pattern, entry.timestamp, entry.event);
+    dirty = true;
+}
+
+// Pulses from the last one heard, sent at releaseTime with released pulses out so far, to the arrival time. What is left over goes in microtiming
+// tick is where the last heard pulse sits in the pattern, its step tells on-beat and off-beat pulse lengths apart
+int32_t Sequence::ArrivalShift(uint32_t arrival, uint32_t released, uint32_t releaseTime, int32_t tick, int8_t& microtiming)
+{
+    microtiming = 0;
+    if (released == 0) return 0; // Nothing has gone out yet
+
+    int32_t offset = (int32_t)((arrival != 0 ? arrival : (uint32_t)MatrixOS::SYS::Micros()) - releaseTime);
+    auto pulseLength = [&](int32_t at) -> int32_t {
+        int32_t step = (at >= 0 ? at : at - (pulsesPerStep - 1)) / pulsesPerStep;
+        return usPerPulse[step & 1];
+    };
+
+    int32_t shift = 0;
+    while (offset < 0 && shift > -PPQN)
+    {
+        shift--;
+        offset += pulseLength(tick + shift);
+    }
+    while (offset >= pulseLength(tick + shift) && shift < PPQN)
+    {
+        offset -= pulseLength(tick + shift);
+        shift++;
+    }
+    if (offset < 0 || offset >= pulseLength(tick + shift)) return 0; // More than a beat off, it was held up somewhere, keep the dequeue time
+
+    // Round to the nearest pulse
+    int32_t fraction = offset * SEQUENCE_MICROTIMING_STEPS / pulseLength(tick + shift);
+    if (fraction >= SEQUENCE_MICROTIMING_STEPS / 2)
+    {
+        shift++;
+        fraction -= SEQUENCE_MICROTIMING_STEPS;
+    }
+    microtiming = fraction;
+    return shift;
+}
+
+// Moves a tick outside its pattern into the pattern it falls in, the patterns of a clip play in order and loop
+void Sequence::WrapRecordTick(uint8_t track, uint8_t clip, uint8_t& pattern, int32_t& tick)
+{
+    uint8_t count = GetPatternCount(track, clip);
+    int32_t clipLength = 0;
+    for (uint8_t i = 0; i < count; i++) { clipLength += GetPattern(track, clip, i)->steps * pulsesPerStep; }
+    if (clipLength == 0)
+    {
+        tick = 0;
+        return;
+    }
+
+    while (tick < 0)
+    {
+        pattern = pattern > 0 ? pattern - 1 : count - 1;
+        tick += GetPattern(track, clip, pattern)->steps * pulsesPerStep;
+    }
+    int32_t length;
+    while (tick >= (length = GetPattern(track, clip, pattern)->steps * pulsesPerStep))
+    {
+        tick -= length;
+        pattern = pattern + 1 < count ? pattern + 1 : 0;
+    }
+}
+
 void Sequence::TerminateRecordedNotes(uint8_t track)
 {
+    SequenceLock lock(*this);
     if (track >= trackPlayback.size()) return;
     auto& recordedNotes = trackPlayback[track].recordedNotes;
     if (recordedNotes.empty()) return;
@@ -1667,15 +2351,11 @@ void Sequence::TerminateRecordedNotes(uint8_t track)
     for (auto& entry : recordedNotes)
     {
         const auto& info = entry.second;
-        if (info.eventPtr == nullptr) continue;
-
         uint32_t length = (currentPulseGlobal > info.startPulse) ? (currentPulseGlobal - info.startPulse) : 1;
         if (length == 0) length = 1;
         if (length > UINT16_MAX) length = UINT16_MAX;
 
-        SequenceEventNote& noteData = std::get<SequenceEventNote>(info.eventPtr->data);
-        noteData.length = (uint16_t)length;
-        updated = true;
+        if (FinishRecordedNote(track, info, entry.first, length)) { updated = true; }
     }
 
     recordedNotes.clear();
@@ -1770,11 +2450,11 @@ void Sequence::ProcessTrack(uint8_t track)
                     uint8_t channel = data.tracks[track].channel;
                     if (noteData.aftertouch)
                     {
-                        MatrixOS::MIDI::Send(MidiPacket::AfterTouch(channel, noteData.note, noteData.velocity), MIDI_PORT_ALL);
+                        pulseOutput.push_back(MidiPacket::AfterTouch(channel, noteData.note, noteData.velocity));
                     }
                     else
                     {
-                        MatrixOS::MIDI::Send(MidiPacket::NoteOn(channel, noteData.note, noteData.velocity), MIDI_PORT_ALL);
+                        pulseOutput.push_back(MidiPacket::NoteOn(channel, noteData.note, noteData.velocity));
                     }
 
                     uint8_t note = noteData.note;
@@ -1783,31 +2463,15 @@ void Sequence::ProcessTrack(uint8_t track)
                     // Update lastEventTime timestamp for led purposes
                     trackPlayback[track].lastEventTime = MatrixOS::SYS::Millis();
 
-                    // Remove any pending note-off for this note (overwrite case)
-                    auto mapIt = trackPlayback[track].noteOffMap.find(note);
-                    if (mapIt != trackPlayback[track].noteOffMap.end()) {
-                        uint32_t oldTick = mapIt->second;
-                        for (auto qIt = trackPlayback[track].noteOffQueue.begin();
-                             qIt != trackPlayback[track].noteOffQueue.end(); ) {
-                            if (qIt->second == note) {
-                                qIt = trackPlayback[track].noteOffQueue.erase(qIt);
-                            } else {
-                                ++qIt;
-                            }
-                        }
-                        trackPlayback[track].noteOffMap.erase(mapIt);
-                    }
-
-                    // Add new note-off
-                    trackPlayback[track].noteOffMap[note] = noteOffTick;
-                    trackPlayback[track].noteOffQueue.insert({noteOffTick, note});
+                    // Replaces any pending note-off for this note (overwrite case)
+                    trackPlayback[track].noteOffs.Schedule(note, noteOffTick, pulseSinceStart);
                     break;
                 }
                 case SequenceEventType::ControlChangeEvent:
                 {
                     const SequenceEventCC& ccEvent = std::get<SequenceEventCC>(ev.data);
                     uint8_t channel = data.tracks[track].channel;
-                    MatrixOS::MIDI::Send(MidiPacket::ControlChange(channel, ccEvent.param, ccEvent.value), MIDI_PORT_ALL);
+                    pulseOutput.push_back(MidiPacket::ControlChange(channel, ccEvent.param, ccEvent.value));
                     break;
                 }
                 default:
@@ -1817,18 +2481,43 @@ void Sequence::ProcessTrack(uint8_t track)
     }
 
     // 3. Process note-offs that have reached their time
-    //    Only check the earliest entries (efficient with multimap)
-    while (!trackPlayback[track].noteOffQueue.empty() &&
-           trackPlayback[track].noteOffQueue.begin()->first <= pulseSinceStart) {
+    uint8_t expired[128];
+    uint8_t expiredCount = trackPlayback[track].noteOffs.Advance(pulseSinceStart, expired);
+    if (trackEnabled && expiredCount > 0) {
+        uint8_t channel = GetChannel(track);
+        for (uint8_t i = 0; i < expiredCount; i++) {
+            pulseOutput.push_back(MidiPacket::NoteOff(channel, expired[i], 0));
+        }
+    }
+}
 
-        uint8_t note = trackPlayback[track].noteOffQueue.begin()->second;
+SequenceEvent* Sequence::FindRecordedNote(const TrackPlayback::RecordedNote& info, uint8_t note)
+{
+    if (info.pattern == nullptr) return nullptr;
 
-        if (trackEnabled) {
-            uint8_t channel = GetChannel(track);
-            MatrixOS::MIDI::Send(MidiPacket::NoteOff(channel, note, 0), MIDI_PORT_ALL);
-        }
+    // Still pending means length 0, nothing else at this timestamp has that
+    auto range = info.pattern->events.equal_range(info.timestamp);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        if (it->second.eventType != SequenceEventType::NoteEvent) continue;
 
-        trackPlayback[track].noteOffMap.erase(note);
-        trackPlayback[track].noteOffQueue.erase(trackPlayback[track].noteOffQueue.begin());
+        SequenceEventNote& noteData = std::get<SequenceEventNote>(it->second.data);
+        if (noteData.note == note && noteData.length == 0)
+        {
+            return &it->second;
+        }
     }
+    return nullptr;
+}
+
+bool Sequence::FinishRecordedNote(uint8_t track, const TrackPlayback::RecordedNote& info, uint8_t note, uint16_t length)
+{
+    SequenceEvent* event = FindRecordedNote(info, note);
+    if (event == nullptr) return false;
+
+    // The journal has the note as it went in, swap that for the finished one
+    journal.LogEvent(JOURNAL_EVENT_REMOVE, track, info.clip, info.index, info.timestamp, *event);
+    std::get<SequenceEventNote>(event->data).length = length;
+    journal.LogEvent(JOURNAL_EVENT_ADD, track, info.clip, info.index, info.timestamp, *event);
+    return true;
 }
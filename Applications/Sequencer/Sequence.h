@@ -1,9 +1,16 @@
 #pragma once
 
 #include "SequenceData.h"
+#include "SequenceJournal.h"
+#include "SequenceUndo.h"
 #include "SequenceMeta.h"
+#include "JitterHistogram.h"
+#include "OutputRing.h"
+#include "NoteOffWheel.h"
 #include <unordered_map>
 
+#define SEQUENCE_RESIDENT_CLIPS 32 // Clean clips past this many are evicted least recently used first
+
 struct SequencePosition
 {
     uint8_t clip = 0;
@@ -19,30 +26,49 @@ private:
 
     bool dirty = false;
 
-    bool playing = false;
+    // Clip paging, clips of an indexed slot stay on SD until they become current or queued
+    string clipSource;                          // Slot file clips that are not resident page in from
+    SemaphoreHandle_t clipSourceMutex = nullptr; // Held while the slot file is read or replaced
+    SemaphoreHandle_t editMutex = nullptr;       // Recursive, see Lock()
+    uint32_t clipUseCount = 0;
+    string savedClipSource;                      // Where the last save put everything, applied from the UI task
+    vector<SequenceClipLocation> savedClips;
+    std::atomic<bool> savedClipsPending{false};
+
+    SequenceJournal journal; // Edits since the slot file, logged where they are made and appended from the UI task
+
+    SequenceUndo undo;     // Pattern edits made through Sequence from the UI task
+    uint8_t undoTrack = 0; // Clip the last logged pattern was found in
+    uint8_t undoClip = 0;
+
+    std::atomic<bool> playing{false}; // Written by the UI task, read by the clock task in OnPulse / OnRender
     int16_t clocksTillStart = 0;            // MIDI clocks until playback starts (24 PPQN, 0 = not scheduled, negative = count-in)
+    uint64_t startPosition = 0;             // OS clock position playback starts at
     bool record = false;
 
-    bool clockOutput = false;
-
     // Clip switching timing
     uint16_t barLength = 16; // Length of each bar in steps
 
-    // Internal sequencer timing (96 PPQN)
-    uint32_t lastPulseTime = 0;             // Last time the sequencer tick was processed (microseconds)
+    // Internal sequencer timing (96 PPQN), pulses are scheduled on the OS clock with swing applied
+    // The tick task renders each pulse LOOKAHEAD us early into output, the clock task sends it right on the pulse
+    int8_t pulseHandle = -1;                // Releases output
+    int8_t renderHandle = -1;               // Same pulses, LOOKAHEAD early
+    TaskHandle_t tickTask = nullptr;        // Woken to render
+    OutputRing output;
+    uint32_t renderedPulses = 0;
+    std::atomic<uint64_t> lastRelease{0};  // Pulses released so far in the high half, scheduled time of the last one (us) in the low half, read together
+    std::atomic<uint32_t> trackCut[32] = {};   // Rendered pulse each track was last stopped at, its earlier note-ons are not released
+    JitterHistogram jitter;
     uint32_t pulseSinceStart = 0;           // Global tick counter for note-off scheduling (96 PPQN)
     uint16_t  currentStep = 0;
     uint16_t  currentPulse = 0;              // Current pulse for swing timing (alternates 0/1 for on/off beat)
     uint32_t usPerPulse[2];                 // Microseconds per pulse with swing (on-beat/off-beat)
     uint8_t stepDivision = 16;                // division: 4=quarter,8=8th,16=16th per step
     uint16_t pulsesPerStep = (PPQN * 4) / 16;      // will be updated with stepDivision
+    uint8_t recordQuantize = 0;             // Percent of the way recorded notes are pulled onto the step grid
     uint8_t lastRecordLayer = 0;
     uint8_t currentRecordLayer = 0;
-
-    // Unswung Clock timing (24 PPQN) - For MIDI Clock & LED Animation
-    uint32_t lastClockTime = 0;             // Last time a MIDI clock pulse was sent (microseconds)
-    uint8_t  currentClock = 0;              // Counter for clocks (0-23, wraps at 24)
-    uint32_t usPerClock;                    // Microseconds per clock pulse (24 PPQN)
+    uint16_t recordLayerEpoch = 0;          // Each bump lowers every recordLayer by 127, patterns catch up lazily
 
     // Playback state per track
     struct TrackPlayback {
@@ -52,28 +78,45 @@ private:
         bool canResume = false;                   // Whether this track can be resumed (was playing before stop)
         uint8_t nextClip = 255;                   // Next clip to play (255 = none)
         uint32_t lastEventTime = 0;               // Last event time (for animation)
-        map<uint8_t, uint32_t> noteOffMap;        // note -> tick time (for overwrite lookup)
-        multimap<uint32_t, uint8_t> noteOffQueue; // tick -> note (for efficient processing)
+        NoteOffWheel noteOffs;                    // Pending note-offs, keyed on pulseSinceStart
         struct RecordedNote
         {
             uint32_t startPulse = 0;
-            SequenceEvent* eventPtr = nullptr;
+            SequencePattern* pattern = nullptr; // Where the pending event went, events move so it is looked up again
+            uint8_t clip = 0;                   // Same pattern by index, for the journal
+            uint8_t index = 0;
+            uint16_t timestamp = 0;
         };
         std::unordered_map<uint8_t, RecordedNote> recordedNotes; // note -> pending event info
     };
 
     vector<TrackPlayback> trackPlayback;
+    vector<MidiPacket> pulseOutput;          // Packets fired on the current pulse, sent as one batch
+    vector<uint8_t> pulseOutputTracks;       // Track each pulseOutput packet came from
 
     void UpdateTiming();
+    void ScheduleStart(int16_t clocks);
     void ProcessTrack(uint8_t track);
+    void FlushOutput();
+    static void OnPulse(uint32_t tick, uint64_t time, void* context);
+    static void OnRender(uint32_t tick, uint64_t time, void* context);
 public:
     const static uint16_t PPQN = 96;
+    const static uint64_t CLOCK_LENGTH = (1ULL << 32) / 24; // One MIDI clock in OS clock position units
+    const static uint32_t LOOKAHEAD = 4000; // us each pulse is rendered ahead of its output
 
     Sequence(uint8_t tracks = 8);
+    ~Sequence();
     void New(uint8_t tracks = 8);
 
+    void SetTickTask(TaskHandle_t task); // Task to wake when a pulse is due for rendering, nullptr to stop pulses
     void Tick();
 
+    // Event stores are flat arrays an insert may move, so patterns are only touched with this held.
+    // Tick() and RecordEvent() hold it on the tick task and the edits below take it themselves, views hold it while they walk events
+    void Lock();
+    void Unlock();
+
     void Play();
     void Play(uint8_t track);
     void PlayClip(uint8_t track, uint8_t clip);
@@ -90,6 +133,8 @@ public:
 
     void EnableRecord(bool val);
     bool RecordEnabled();
+    void SetRecordQuantize(uint8_t strength); // 0 keeps the timing as played, 100 lands every note on a step
+    uint8_t GetRecordQuantize();
 
     void EnableClockOutput(bool val);
     bool ClockOutputEnabled();
@@ -130,6 +175,12 @@ public:
     bool PatternNudge(SequencePattern* pattern, int16_t offsetPulse);
     bool DualPatternNudge(SequencePattern* pattern1, SequencePattern* pattern2, int16_t offsetPulse); // Nudge cycle though 2 patterns
     bool PatternNudgeInRange(SequencePattern* pattern, uint16_t startTime, uint16_t length, int16_t offsetPulse, SequencePattern* prevPattern, SequencePattern* nextPattern);
+    void PatternNormalizeRecordLayers(SequencePattern* pattern); // Call before moving events to another pattern
+
+    // Edits on an event the UI is holding on to
+    SequenceEventStore::iterator PatternMoveEvent(SequencePattern* pattern, SequenceEventStore::iterator event, uint16_t timestamp);
+    void PatternRemoveEvent(SequencePattern* pattern, SequenceEventStore::iterator event);
+    void PatternEventChanged(SequencePattern* pattern, uint16_t timestamp, const SequenceEvent& before, const SequenceEvent& after); // After editing it in place
 
     uint8_t GetChannel(uint8_t track);
     void SetChannel(uint8_t track, uint8_t channel);
@@ -167,6 +218,15 @@ public:
     bool CanUndoLastRecord();
     void UndoLastRecorded();
 
+    // Edit history of the Pattern* helpers above, call from the UI task only. Recording is not in it, UndoLastRecorded covers that
+    // Clip and pattern deletes and copies, New and SetData clear it, since its entries address patterns by index
+    void UndoMark(); // Edits from here on undo as one, called on every key press
+    bool CanUndo();
+    bool CanRedo();
+    bool Undo();
+    bool Redo();
+    void ClearUndo();
+
     bool IsNoteActive(uint8_t track, uint8_t note) const;
 
     SequencePosition* GetPosition(uint8_t track);
@@ -185,12 +245,55 @@ public:
     Fract16 GetQuarterNoteProgress();
     uint8_t QuarterNoteProgressBreath(uint8_t lowBound = 0); // LED Helper
 
-    void RecordEvent(MidiPacket packet, uint8_t track = 0xFF); // if track is 0xff, will determain based on the packet channel. 
+    void RecordEvent(MidiPacket packet, uint8_t track = 0xFF, uint32_t arrival = 0); // if track is 0xff, will determain based on the packet channel. arrival is SYS::Micros() when it came in, 0 for now
+
+    // Clip paging, call from the UI task only, Tick() never pages
+    void SetClipSource(const string& path); // Empty when every clip is resident
+    const string& GetClipSource();
+    bool PageInClip(uint8_t track, uint8_t clip);
+    bool PageInAllClips(); // Before the clip source goes away
+    void LockClipSource();
+    void UnlockClipSource();
+    void ClipsSaved(const string& path, vector<SequenceClipLocation>& locations); // With the clip source locked, once the new file is in place
+
+    // Edit journal, call from the UI task only
+    void StartJournal(); // The sequence as it is now is what the slot file holds
+    void StopJournal();
+    bool JournalActive();
+    bool AppendJournal(File& file, bool begin, uint32_t& records); // Writes the edits logged since the last append
+    bool ReplayJournal(File& file, uint32_t& records); // False if the journal ends in a partial record, records up to it are applied
 
     // Data accessors (for serialization)
     const SequenceData& GetData() const { return data; }
-    void SetData(const SequenceData& newData) { data = newData; UpdateEmptyPatternsWithPatternLength(); UpdateTiming(); lastRecordLayer = 0; currentRecordLayer = 0; dirty = true; }
+    void SetData(const SequenceData& newData) { Lock(); data = newData; UpdateEmptyPatternsWithPatternLength(); UpdateTiming(); lastRecordLayer = 0; currentRecordLayer = 0; undo.Clear(); dirty = true; Unlock(); }
 
 private:
     void TerminateRecordedNotes(uint8_t track);
+    int32_t ArrivalShift(uint32_t arrival, uint32_t released, uint32_t releaseTime, int32_t tick, int8_t& microtiming);
+    void WrapRecordTick(uint8_t track, uint8_t clip, uint8_t& pattern, int32_t& tick);
+    void ApplySavedClips();
+    bool LoadClip(uint8_t track, uint8_t clip, SequenceClip& target);
+    void EvictClips();
+    SequenceEvent* FindRecordedNote(const TrackPlayback::RecordedNote& info, uint8_t note);
+    bool FinishRecordedNote(uint8_t track, const TrackPlayback::RecordedNote& info, uint8_t note, uint16_t length); // Sets the length of a pending note, false if it is gone
+    bool LocatePattern(const SequencePattern* pattern, uint8_t& track, uint8_t& clip, uint8_t& index);
+    void LogEvent(SequenceUndoOp op, const SequencePattern* pattern, uint16_t timestamp, const SequenceEvent& event);
+    void LogEvents(SequenceUndoOp op, const SequencePattern* pattern, const SequenceEventStore& events);
+    void LogEdit(SequenceUndoOp op, uint8_t track, uint8_t clip, uint8_t index, uint16_t timestamp, const SequenceEvent& event); // Undo history and journal
+    void JournalEdit(SequenceUndoOp op, bool forward, uint8_t track, uint8_t clip, uint8_t index, uint16_t timestamp, const SequenceEvent& event);
+    void LogSteps(const SequencePattern* pattern, uint8_t oldSteps, uint8_t newSteps);
+    void ApplyUndo(const SequenceUndoEntry& entry, bool forward);
+};
+
+// Holds the sequence lock for a scope
+class SequenceLock
+{
+public:
+    explicit SequenceLock(Sequence& sequence) : sequence(sequence) { sequence.Lock(); }
+    ~SequenceLock() { sequence.Unlock(); }
+    SequenceLock(const SequenceLock&) = delete;
+    SequenceLock& operator=(const SequenceLock&) = delete;
+
+private:
+    Sequence& sequence;
 };
@@ -1,11 +1,8 @@
 #include "SequenceData.h"
-#include "cb0r.h"
-#include "cb0rHelper.h"
-#include <string>
+#include "CborStream.h"
 #include <cstring>
 
 using std::vector;
-using std::string;
 
 void SequencePattern::Clear()
 {
@@ -23,348 +20,577 @@ void SequencePattern::ClearStepEvents(uint8_t step, uint16_t pulsesPerStep)
     }
 }
 
+// Version 4 tags items and keys the header with small integers, version 3 used short text strings
+// Version 5 adds the index item right after the header, each clip item and its patterns can then be read on their own
+enum SequenceDataTag : uint8_t
+{
+    TAG_TRACK = 0,   // [tag, channel, activeClip]
+    TAG_CLIP = 1,    // [tag, clipId]
+    TAG_PATTERN = 2, // [tag, steps, events[]]
+    TAG_INDEX = 3,   // [tag, [[channel, activeClip]...], [[track, clip, offset, length]...]]
+    TAG_UNKNOWN = 0xFF,
+};
+
+enum SequenceDataHeaderKey : uint8_t
+{
+    HEADER_VERSION = 0,
+    HEADER_BPM,
+    HEADER_SWING,
+    HEADER_PATTERN_LENGTH,
+    HEADER_BEATS,
+    HEADER_BEAT_UNIT,
+    HEADER_STEP_DIVISION,
+    HEADER_SOLO,
+    HEADER_MUTE,
+    HEADER_RECORD,
+    HEADER_COUNT,
+};
+
+// Version 3 header key names, in SequenceDataHeaderKey order
+static const char* const legacyKeys[HEADER_COUNT] = {"ver", "bpm", "swing", "patternLen", "beats", "beatUnit", "stepDiv", "solo", "mute", "rec"};
+
 // --- Serialization helpers ---
-static void SerializeEvent(vector<uint8_t>& out, const std::pair<uint16_t, SequenceEvent>& evPair)
+void SerializeSequenceEvent(CborWriter& out, const std::pair<uint16_t, SequenceEvent>& evPair)
 {
     const SequenceEvent& ev = evPair.second;
-    cb_write_uint(out, CB0R_ARRAY, 3);
-    cb_write_uint(out, CB0R_INT, evPair.first);                                  // timestamp
-    cb_write_uint(out, CB0R_INT, static_cast<uint8_t>(ev.eventType));            // type
+    out.Head(CB0R_ARRAY, ev.microtiming != 0 ? 4 : 3); // Microtiming trails the payload, only when there is some
+    out.UInt(evPair.first);                                  // timestamp
+    out.UInt(static_cast<uint8_t>(ev.eventType));            // type
 
     if (ev.eventType == SequenceEventType::NoteEvent)
     {
         const SequenceEventNote& n = std::get<SequenceEventNote>(ev.data);
-        cb_write_uint(out, CB0R_ARRAY, 4);
-        cb_write_uint(out, CB0R_INT, n.note);
-        cb_write_uint(out, CB0R_INT, n.velocity);
-        cb_write_uint(out, CB0R_INT, n.length);
-        cb_write_bool(out, n.aftertouch);
+        out.Head(CB0R_ARRAY, 4);
+        out.UInt(n.note);
+        out.UInt(n.velocity);
+        out.UInt(n.length);
+        out.Bool(n.aftertouch);
     }
     else if (ev.eventType == SequenceEventType::ControlChangeEvent)
     {
         const SequenceEventCC& cc = std::get<SequenceEventCC>(ev.data);
-        cb_write_uint(out, CB0R_ARRAY, 2);
-        cb_write_uint(out, CB0R_INT, cc.param);
-        cb_write_uint(out, CB0R_INT, cc.value);
+        out.Head(CB0R_ARRAY, 2);
+        out.UInt(cc.param);
+        out.UInt(cc.value);
     }
     else
     {
-        cb_write_uint(out, CB0R_ARRAY, 0);
+        out.Head(CB0R_ARRAY, 0);
+    }
+
+    if (ev.microtiming > 0) { out.UInt(ev.microtiming); }
+    else if (ev.microtiming < 0) { out.Head(CB0R_NEG, -1 - ev.microtiming); }
+}
+
+// Offsets and lengths are fixed width so the index can be written before the clips and patched after
+static void SerializeIndex(CborWriter& out, const SequenceData& data, const vector<SequenceClipLocation>& locations)
+{
+    out.Head(CB0R_ARRAY, 3);
+    out.UInt(TAG_INDEX);
+    out.Head(CB0R_ARRAY, data.tracks.size());
+    for (const auto& track : data.tracks)
+    {
+        out.Head(CB0R_ARRAY, 2);
+        out.UInt(track.channel);
+        out.UInt(track.activeClip);
+    }
+    out.Head(CB0R_ARRAY, locations.size());
+    for (const auto& location : locations)
+    {
+        out.Head(CB0R_ARRAY, 4);
+        out.UInt(location.track);
+        out.UInt(location.clip);
+        out.FixedUInt(location.offset);
+        out.FixedUInt(location.length);
     }
 }
 
-bool SerializeSequenceData(const SequenceData& data, File& file)
+// A clip that was never paged in is copied over byte for byte
+static bool CopyClip(CborWriter& out, File* source, const SequenceClip& clip)
 {
-    std::vector<uint8_t> buffer;
+    if (!source || !source->Seek(clip.fileOffset)) { MLOGW("SequenceData", "Clip copy failed - source unavailable"); return false; }
+    uint8_t chunk[128];
+    size_t remaining = clip.fileLength;
+    while (remaining > 0)
+    {
+        size_t n = std::min(remaining, sizeof(chunk));
+        if (source->Read(chunk, n) != n) { MLOGW("SequenceData", "Clip copy failed - short read"); return false; }
+        out.Raw(chunk, n);
+        remaining -= n;
+    }
+    return true;
+}
 
-    // Header item (map)
-    buffer.clear();
-    cb_write_uint(buffer, CB0R_MAP, 10);
-    cb_write_text(buffer, "ver"); cb_write_uint(buffer, CB0R_INT, data.version);
-    cb_write_text(buffer, "bpm"); cb_write_uint(buffer, CB0R_INT, data.bpm);
-    cb_write_text(buffer, "swing"); cb_write_uint(buffer, CB0R_INT, data.swing);
-    cb_write_text(buffer, "patternLen"); cb_write_uint(buffer, CB0R_INT, data.patternLength);
-    cb_write_text(buffer, "beats"); cb_write_uint(buffer, CB0R_INT, data.beatsPerBar);
-    cb_write_text(buffer, "beatUnit"); cb_write_uint(buffer, CB0R_INT, data.beatUnit);
-    cb_write_text(buffer, "stepDiv"); cb_write_uint(buffer, CB0R_INT, data.stepDivision);
-    cb_write_text(buffer, "solo"); cb_write_uint(buffer, CB0R_INT, data.solo);
-    cb_write_text(buffer, "mute"); cb_write_uint(buffer, CB0R_INT, data.mute);
-    cb_write_text(buffer, "rec"); cb_write_uint(buffer, CB0R_INT, data.record);
-    if (file.Write(buffer.data(), buffer.size()) != buffer.size()) return false;
+bool SerializeSequenceData(const SequenceData& data, File& file, File* clipSource, vector<SequenceClipLocation>* locations)
+{
+    CborWriter out(file);
 
+    vector<SequenceClipLocation> placed;
+    for (uint8_t trackId = 0; trackId < data.tracks.size(); trackId++)
+    {
+        for (const auto& clipPair : data.tracks[trackId].clips)
+        {
+            placed.push_back({trackId, clipPair.first, 0, 0});
+        }
+    }
+
+    // Header item (map)
+    out.Head(CB0R_MAP, HEADER_COUNT);
+    out.UInt(HEADER_VERSION); out.UInt(SEQUENCE_VERSION);
+    out.UInt(HEADER_BPM); out.UInt(data.bpm);
+    out.UInt(HEADER_SWING); out.UInt(data.swing);
+    out.UInt(HEADER_PATTERN_LENGTH); out.UInt(data.patternLength);
+    out.UInt(HEADER_BEATS); out.UInt(data.beatsPerBar);
+    out.UInt(HEADER_BEAT_UNIT); out.UInt(data.beatUnit);
+    out.UInt(HEADER_STEP_DIVISION); out.UInt(data.stepDivision);
+    out.UInt(HEADER_SOLO); out.UInt(data.solo);
+    out.UInt(HEADER_MUTE); out.UInt(data.mute);
+    out.UInt(HEADER_RECORD); out.UInt(data.record);
+
+    size_t indexPosition = out.Position();
+    SerializeIndex(out, data, placed);
+
+    size_t nextLocation = 0;
     uint8_t trackId = 0;
     for (const auto& track : data.tracks)
     {
         MLOGD("SequenceData", "Serializing track %u ch=%u activeClip=%u clips=%zu", trackId, track.channel, track.activeClip, track.clips.size());
-        // Track item: ["t", channel, activeClip]
-        buffer.clear();
-        cb_write_uint(buffer, CB0R_ARRAY, 3);
-        cb_write_text(buffer, "t");
-        cb_write_uint(buffer, CB0R_INT, track.channel);
-        cb_write_uint(buffer, CB0R_INT, track.activeClip);
-        if (file.Write(buffer.data(), buffer.size()) != buffer.size()) return false;
+        // Track item: [TAG_TRACK, channel, activeClip]
+        out.Head(CB0R_ARRAY, 3);
+        out.UInt(TAG_TRACK);
+        out.UInt(track.channel);
+        out.UInt(track.activeClip);
 
         // Clip meta + patterns
         for (const auto& clipPair : track.clips)
         {
             uint8_t clipId = clipPair.first;
             const SequenceClip& clip = clipPair.second;
+            SequenceClipLocation& location = placed[nextLocation++];
+            location.offset = out.Position();
+
+            if (!clip.resident)
+            {
+                MLOGD("SequenceData", "Copying clip t=%u id=%u length=%u", trackId, clipId, (unsigned)clip.fileLength);
+                if (!CopyClip(out, clipSource, clip)) return false;
+                location.length = out.Position() - location.offset;
+                continue;
+            }
 
             MLOGD("SequenceData", "Serializing clip t=%u id=%u patterns=%zu", trackId, clipId, clip.patterns.size());
-            // Clip item: ["c", clipId]
-            buffer.clear();
-            cb_write_uint(buffer, CB0R_ARRAY, 2);
-            cb_write_text(buffer, "c");
-            cb_write_uint(buffer, CB0R_INT, clipId);
-            if (file.Write(buffer.data(), buffer.size()) != buffer.size()) return false;
+            // Clip item: [TAG_CLIP, clipId]
+            out.Head(CB0R_ARRAY, 2);
+            out.UInt(TAG_CLIP);
+            out.UInt(clipId);
 
             // Patterns
             for (size_t patIdx = 0; patIdx < clip.patterns.size(); patIdx++)
             {
                 const SequencePattern& pat = clip.patterns[patIdx];
-                buffer.clear();
-                // ["p", steps, events[]]
-                cb_write_uint(buffer, CB0R_ARRAY, 3);
-                cb_write_text(buffer, "p");
-                cb_write_uint(buffer, CB0R_INT, pat.steps);
-                cb_write_uint(buffer, CB0R_ARRAY, pat.events.size());
+                // [TAG_PATTERN, steps, events[]]
+                out.Head(CB0R_ARRAY, 3);
+                out.UInt(TAG_PATTERN);
+                out.UInt(pat.steps);
+                out.Head(CB0R_ARRAY, pat.events.size());
                 MLOGD("SequenceData", "Serializing pattern t=%u c=%u p=%zu steps=%u events=%zu", trackId, clipId, patIdx, pat.steps, pat.events.size());
                 for (const auto& ev : pat.events)
                 {
-                    SerializeEvent(buffer, ev);
+                    SerializeSequenceEvent(out, ev);
                 }
-                if (file.Write(buffer.data(), buffer.size()) != buffer.size()) return false;
             }
+            location.length = out.Position() - location.offset;
         }
         trackId++;
     }
+    if (!out.Flush()) return false;
 
+    // Now the clip offsets are known, rewrite the index in place
+    if (!file.Seek(indexPosition)) return false;
+    CborWriter index(file);
+    SerializeIndex(index, data, placed);
+    if (!index.Flush()) return false;
+
+    if (locations) { locations->swap(placed); }
     return true;
 }
 
 // --- Deserialization helpers ---
-static bool ParseHeader(cb0r_s root, SequenceData& out)
+// Reads the next item into field if it is an unsigned integer, skips it otherwise
+template <typename T>
+static bool ReadField(CborReader& in, T& field)
+{
+    cb0r_e type;
+    uint64_t value;
+    if (!in.Head(type, value)) return false;
+    if (type == CB0R_INT) field = (T)value;
+    return in.Skip(type, value);
+}
+
+// Skips array elements past the ones we understand
+static bool SkipRest(CborReader& in, uint64_t length, uint64_t read)
+{
+    for (uint64_t i = read; i < length; i++)
+    {
+        if (!in.SkipItem()) return false;
+    }
+    return true;
+}
+
+static bool ParseKey(CborReader& in, uint8_t& key)
+{
+    cb0r_e type;
+    uint64_t value;
+    if (!in.Head(type, value)) return false;
+    key = HEADER_COUNT;
+    if (type == CB0R_INT)
+    {
+        if (value < HEADER_COUNT) key = value;
+        return true;
+    }
+
+    // Version 3 text keys
+    char name[12];
+    if (type != CB0R_UTF8 || value >= sizeof(name)) return in.Skip(type, value);
+    if (!in.Read(name, value)) return false;
+    name[value] = '\0';
+    for (uint8_t k = 0; k < HEADER_COUNT; k++)
+    {
+        if (strcmp(name, legacyKeys[k]) == 0) { key = k; break; }
+    }
+    return true;
+}
+
+static bool ParseHeader(CborReader& in, uint64_t entries, SequenceData& out)
 {
-    cb0r_s item;
-    if (!cb0r_find(&root, CB0R_UTF8, 3, (uint8_t*)"ver", &item)) { MLOGW("SequenceData", "Header missing 'ver'"); return false; }
-    out.version = item.value;
+    bool hasVersion = false;
+    for (uint64_t i = 0; i < entries; i++)
+    {
+        uint8_t key;
+        bool ok = ParseKey(in, key);
+        if (ok)
+        {
+            switch (key)
+            {
+                case HEADER_VERSION: ok = ReadField(in, out.version); hasVersion = true; break;
+                case HEADER_BPM: ok = ReadField(in, out.bpm); break;
+                case HEADER_SWING: ok = ReadField(in, out.swing); break;
+                case HEADER_PATTERN_LENGTH: ok = ReadField(in, out.patternLength); break;
+                case HEADER_BEATS: ok = ReadField(in, out.beatsPerBar); break;
+                case HEADER_BEAT_UNIT: ok = ReadField(in, out.beatUnit); break;
+                case HEADER_STEP_DIVISION: ok = ReadField(in, out.stepDivision); break;
+                case HEADER_SOLO: ok = ReadField(in, out.solo); break;
+                case HEADER_MUTE: ok = ReadField(in, out.mute); break;
+                case HEADER_RECORD: ok = ReadField(in, out.record); break;
+                default: ok = in.SkipItem(); break;
+            }
+        }
+        if (!ok) { MLOGW("SequenceData", "Header parse failed - truncated"); return false; }
+    }
+    if (!hasVersion) { MLOGW("SequenceData", "Header missing 'ver'"); return false; }
     if (out.version < MIN_SUPPORTED_SEQUENCE_VERSION || out.version > SEQUENCE_VERSION) { MLOGW("SequenceData", "Unsupported version %u", out.version); return false; }
-    if (cb0r_find(&root, CB0R_UTF8, 3, (uint8_t*)"bpm", &item)) out.bpm = item.value;
-    if (cb0r_find(&root, CB0R_UTF8, 5, (uint8_t*)"swing", &item)) out.swing = item.value;
-    if (cb0r_find(&root, CB0R_UTF8, 10, (uint8_t*)"patternLen", &item)) out.patternLength = item.value;
-    if (cb0r_find(&root, CB0R_UTF8, 5, (uint8_t*)"beats", &item)) out.beatsPerBar = item.value;
-    if (cb0r_find(&root, CB0R_UTF8, 8, (uint8_t*)"beatUnit", &item)) out.beatUnit = item.value;
-    if (cb0r_find(&root, CB0R_UTF8, 7, (uint8_t*)"stepDiv", &item)) out.stepDivision = item.value;
-    if (cb0r_find(&root, CB0R_UTF8, 4, (uint8_t*)"solo", &item)) out.solo = item.value;
-    if (cb0r_find(&root, CB0R_UTF8, 4, (uint8_t*)"mute", &item)) out.mute = item.value;
-    if (cb0r_find(&root, CB0R_UTF8, 3, (uint8_t*)"rec", &item)) out.record = item.value;
     out.tracks.clear();
     return true;
 }
 
-static bool ParseTrack(cb0r_s node, uint8_t& channel, uint8_t& activeClip)
+static bool ParseTag(CborReader& in, uint8_t& tag)
 {
-    if (node.type != CB0R_ARRAY || node.length < 3) { MLOGW("SequenceData", "Track parse failed - invalid node"); return false; }
-    cb0r_s item;
-    // ["t", channel, activeClip]
-    if (!cb0r_get(&node, 1, &item) || item.type != CB0R_INT) { MLOGW("SequenceData", "Track parse failed - channel missing"); return false; }
-    channel = item.value;
-    if (!cb0r_get(&node, 2, &item) || item.type != CB0R_INT) { MLOGW("SequenceData", "Track parse failed - activeClip missing"); return false; }
-    activeClip = item.value;
-    MLOGD("SequenceData", "Parsed Track ch=%u activeClip=%u", channel, activeClip);
+    cb0r_e type;
+    uint64_t value;
+    if (!in.Head(type, value)) return false;
+    tag = TAG_UNKNOWN;
+    if (type == CB0R_INT)
+    {
+        if (value <= TAG_INDEX) tag = value;
+        return true;
+    }
+
+    // Version 3 single letter tags
+    if (type != CB0R_UTF8 || value != 1) return in.Skip(type, value);
+    char letter;
+    if (!in.Read(&letter, 1)) return false;
+    if (letter == 't') tag = TAG_TRACK;
+    else if (letter == 'c') tag = TAG_CLIP;
+    else if (letter == 'p') tag = TAG_PATTERN;
     return true;
 }
 
-static bool ParseClip(cb0r_s node, uint8_t& clipId)
+static bool ParseTrack(CborReader& in, uint64_t length, uint8_t& channel, uint8_t& activeClip)
 {
-    // Accept legacy 3-element clips but only require 2 (["c", clipId, <enabled>])
-    if (node.type != CB0R_ARRAY || node.length < 2) { MLOGW("SequenceData", "Clip parse failed - invalid node"); return false; }
-    cb0r_s item;
-    // ["c", clipId]
-    if (!cb0r_get(&node, 1, &item) || item.type != CB0R_INT) { MLOGW("SequenceData", "Clip parse failed - id missing"); return false; }
-    clipId = item.value;
+    // [tag, channel, activeClip]
+    if (length < 3) { MLOGW("SequenceData", "Track parse failed - invalid node"); return false; }
+    uint64_t value;
+    if (!in.UInt(value)) { MLOGW("SequenceData", "Track parse failed - channel missing"); return false; }
+    channel = value;
+    if (!in.UInt(value)) { MLOGW("SequenceData", "Track parse failed - activeClip missing"); return false; }
+    activeClip = value;
+    MLOGD("SequenceData", "Parsed Track ch=%u activeClip=%u", channel, activeClip);
+    return SkipRest(in, length, 3);
+}
+
+static bool ParseClip(CborReader& in, uint64_t length, uint8_t& clipId)
+{
+    // Accept legacy 3-element clips but only require 2 ([tag, clipId, <enabled>])
+    if (length < 2) { MLOGW("SequenceData", "Clip parse failed - invalid node"); return false; }
+    uint64_t value;
+    if (!in.UInt(value)) { MLOGW("SequenceData", "Clip parse failed - id missing"); return false; }
+    clipId = value;
     MLOGD("SequenceData", "Parsed Clip id=%u", clipId);
-    return true;
+    return SkipRest(in, length, 2);
 }
 
-// --- Deserialization helpers ---
-static bool ParseEvent(cb0r_s node, SequenceEvent& outEv, uint16_t& timestamp, uint8_t version)
+static bool ParseEvent(CborReader& in, SequenceEvent& outEv, uint16_t& timestamp, uint8_t version)
 {
     (void)version;
-    if (node.type != CB0R_ARRAY || node.length < 2) { MLOGW("SequenceData", "Event parse failed - invalid node"); return false; }
-    cb0r_s item;
-    if (!cb0r_get(&node, 0, &item) || item.type != CB0R_INT) { MLOGW("SequenceData", "Event parse failed - timestamp missing"); return false; }
-    timestamp = item.value;
-    if (!cb0r_get(&node, 1, &item) || item.type != CB0R_INT) { MLOGW("SequenceData", "Event parse failed - type missing"); return false; }
-    uint8_t type = item.value;
-    cb0r_s payload;
-    if (!cb0r_get(&node, 2, &payload)) payload.type = CB0R_ARRAY;
-
-    if (type == static_cast<uint8_t>(SequenceEventType::NoteEvent))
+    cb0r_e type;
+    uint64_t length;
+    if (!in.Head(type, length)) { MLOGW("SequenceData", "Event parse failed - truncated"); return false; }
+    if (type != CB0R_ARRAY || length < 2) { MLOGW("SequenceData", "Event parse failed - invalid node"); return false; }
+    uint64_t value;
+    if (!in.UInt(value)) { MLOGW("SequenceData", "Event parse failed - timestamp missing"); return false; }
+    timestamp = value;
+    if (!in.UInt(value)) { MLOGW("SequenceData", "Event parse failed - type missing"); return false; }
+    SequenceEventType eventType = static_cast<SequenceEventType>(value);
+
+    // Payload array, fields that are missing keep their defaults
+    uint64_t fields = 0;
+    if (length >= 3)
     {
-        SequenceEventNote note{};
-        if (payload.type == CB0R_ARRAY)
+        if (!in.Head(type, fields)) return false;
+        if (type != CB0R_ARRAY)
         {
-            cb0r_s d;
-            if (cb0r_get(&payload, 0, &d) && d.type == CB0R_INT) note.note = d.value;
-            if (cb0r_get(&payload, 1, &d) && d.type == CB0R_INT) note.velocity = d.value;
-            if (cb0r_get(&payload, 2, &d) && d.type == CB0R_INT) note.length = d.value;
-            if (cb0r_get(&payload, 3, &d))
-            {
-                note.aftertouch = (d.type == CB0R_TRUE) || (d.type == CB0R_INT && d.value != 0);
-            }
+            if (!in.Skip(type, fields)) return false;
+            fields = 0;
         }
-        outEv = SequenceEvent{SequenceEventType::NoteEvent, note};
     }
-    else if (type == static_cast<uint8_t>(SequenceEventType::ControlChangeEvent))
+
+    SequenceEventNote note{};
+    SequenceEventCC cc{};
+    for (uint64_t i = 0; i < fields; i++)
     {
-        SequenceEventCC cc{};
-        if (payload.type == CB0R_ARRAY)
+        if (!in.Head(type, value)) return false;
+        bool isInt = type == CB0R_INT;
+        if (eventType == SequenceEventType::NoteEvent)
+        {
+            if (i == 0 && isInt) note.note = value;
+            else if (i == 1 && isInt) note.velocity = value;
+            else if (i == 2 && isInt) note.length = value;
+            else if (i == 3) note.aftertouch = (type == CB0R_TRUE) || (isInt && value != 0);
+        }
+        else if (eventType == SequenceEventType::ControlChangeEvent)
         {
-            cb0r_s d;
-            if (cb0r_get(&payload, 0, &d) && d.type == CB0R_INT) cc.param = d.value;
-            if (cb0r_get(&payload, 1, &d) && d.type == CB0R_INT) cc.value = d.value;
+            if (i == 0 && isInt) cc.param = value;
+            else if (i == 1 && isInt) cc.value = value;
         }
+        if (!in.Skip(type, value)) return false;
+    }
+
+    if (eventType == SequenceEventType::NoteEvent)
+    {
+        outEv = SequenceEvent{SequenceEventType::NoteEvent, note};
+    }
+    else if (eventType == SequenceEventType::ControlChangeEvent)
+    {
         outEv = SequenceEvent{SequenceEventType::ControlChangeEvent, cc};
     }
     else
     {
         outEv = SequenceEvent{SequenceEventType::Invalid, SequenceEventNote{}};
     }
-    return true;
+
+    if (length >= 4)
+    {
+        if (!in.Head(type, value)) return false;
+        if (type == CB0R_INT && value <= INT8_MAX) { outEv.microtiming = value; }
+        else if (type == CB0R_NEG && value < -INT8_MIN) { outEv.microtiming = -1 - (int16_t)value; }
+        if (!in.Skip(type, value)) return false;
+        return SkipRest(in, length, 4);
+    }
+    return SkipRest(in, length, length >= 3 ? 3 : 2);
+}
+
+bool DeserializeSequenceEvent(CborReader& in, SequenceEvent& event, uint16_t& timestamp)
+{
+    return ParseEvent(in, event, timestamp, SEQUENCE_VERSION);
 }
 
-static bool ParsePattern(cb0r_s node, uint8_t trackId, uint8_t clipId, uint8_t patternId, SequenceData& data)
+static bool ParsePattern(CborReader& in, uint64_t length, SequencePattern& pat)
 {
-    if (node.type != CB0R_ARRAY || node.length < 3) { MLOGW("SequenceData", "Pattern parse failed - invalid node"); return false; }
-    cb0r_s item;
-    // ["p", steps, events[]]
-    if (!cb0r_get(&node, 1, &item) || item.type != CB0R_INT) { MLOGW("SequenceData", "Pattern parse failed - steps missing"); return false; }
-    uint8_t steps = item.value;
-    if (!cb0r_get(&node, 2, &item) || item.type != CB0R_ARRAY) { MLOGW("SequenceData", "Pattern parse failed - events array missing"); return false; }
-
-    if (trackId >= data.tracks.size()) data.tracks.resize(trackId + 1);
-    SequenceTrack& track = data.tracks[trackId];
-    SequenceClip& clip = track.clips[clipId];
-    if (clip.patterns.size() <= patternId) clip.patterns.resize(patternId + 1);
-    SequencePattern& pat = clip.patterns[patternId];
+    // [tag, steps, events[]]
+    if (length < 3) { MLOGW("SequenceData", "Pattern parse failed - invalid node"); return false; }
+    uint64_t value;
+    if (!in.UInt(value)) { MLOGW("SequenceData", "Pattern parse failed - steps missing"); return false; }
+    uint8_t steps = value;
+    cb0r_e type;
+    uint64_t count;
+    if (!in.Head(type, count) || type != CB0R_ARRAY) { MLOGW("SequenceData", "Pattern parse failed - events array missing"); return false; }
+    // A corrupt count must not turn into a huge reserve, every event takes at least its head, timestamp and type
+    if (count > in.Remaining() / SEQUENCE_EVENT_MIN_SIZE) { MLOGW("SequenceData", "Pattern parse failed - event count %llu past end of file", (unsigned long long)count); return false; }
+
     pat.steps = steps;
     pat.events.clear();
+    pat.events.reserve(count);
 
-    for (size_t i = 0; i < item.length; i++)
+    for (uint64_t i = 0; i < count; i++)
     {
-        cb0r_s evNode;
-        if (!cb0r_get(&item, (uint32_t)i, &evNode)) continue;
         SequenceEvent e(SequenceEventType::Invalid, SequenceEventNote{});
         uint16_t timestamp = 0;
-        if (ParseEvent(evNode, e, timestamp, data.version))
-        {
-            pat.events.insert({timestamp, e});
-        }
+        if (!ParseEvent(in, e, timestamp, SEQUENCE_VERSION)) return false;
+        pat.events.insert({timestamp, e});
     }
-    MLOGD("SequenceData", "Parsed Pattern t=%u c=%u p=%u steps=%u events=%zu", trackId, clipId, patternId, pat.steps, pat.events.size());
+    return SkipRest(in, length, 3);
+}
+
+// Reads the next item's array head and tag
+static bool ParseItem(CborReader& in, uint64_t& length, uint8_t& tag)
+{
+    cb0r_e type;
+    return in.Head(type, length) && type == CB0R_ARRAY && length >= 1 && ParseTag(in, tag);
+}
+
+static bool ParseHeaderItem(CborReader& in, SequenceData& out)
+{
+    cb0r_e type;
+    uint64_t length;
+    if (!in.Head(type, length) || type != CB0R_MAP) { MLOGW("SequenceData", "Header parse failed - not a map"); return false; }
+    if (!ParseHeader(in, length, out)) { MLOGW("SequenceData", "Header parse failed"); return false; }
+    MLOGD("SequenceData", "Header parsed ver=%u bpm=%u swing=%u patternLen=%u beats=%u beatUnit=%u stepDiv=%u", out.version, out.bpm, out.swing, out.patternLength, out.beatsPerBar, out.beatUnit, out.stepDivision);
     return true;
 }
 
 bool DeserializeSequenceData(File& file, SequenceData& out)
 {
-    const size_t MAX_STREAMING_BUFFER = 8 * 1024;
-    std::vector<uint8_t> buffer;
-    buffer.reserve(1024);
-    uint8_t chunk[512];
-    size_t fileOffset = 0; // bytes consumed from start of file
-    bool eofReached = false;
-
-    bool headerParsed = false;
+    CborReader in(file);
+    uint64_t length;
+    if (!ParseHeaderItem(in, out)) return false;
+
     uint8_t currentTrack = 0xFF;
     uint8_t currentClip = 0;
     uint8_t nextPattern = 0;
 
-    while (true)
+    while (!in.AtEnd())
     {
-        cb0r_s root{};
-        while (true)
+        size_t offset = in.Position();
+        uint8_t tag;
+        if (!ParseItem(in, length, tag))
         {
-            size_t consumed = 0;
-            bool itemReady = false;
-
-            do
-            {
-                bool itemRead = cb0r_read(buffer.data(), buffer.size(), &root);
-                consumed = itemRead ? (size_t)(root.end - buffer.data()) : 0;
-
-                if (buffer.size() > 0 && (consumed == 0 || consumed > buffer.size()))
-                {
-                    MLOGW("SequenceData", "Item parse failed - consumed=%zu size=%zu", consumed, buffer.size());
-                    return false;
-                }
-
-                itemReady = itemRead && (consumed < buffer.size() || eofReached);
-
-                if (itemReady) break;
+            MLOGW("SequenceData", "Item parse failed at offset %zu - not a tagged array", offset);
+            return false;
+        }
 
-                // We need to read more
-                size_t n = file.Read(chunk, 512);
- 
-                if (buffer.size() + n > MAX_STREAMING_BUFFER)
-                {
-                    MLOGE("SequenceData", "Deserialize - item too large (%zu bytes)", buffer.size() + n);
-                    return false;
-                }
+        if (tag == TAG_TRACK)
+        {
+            uint8_t channel = 0;
+            uint8_t activeClip = 0;
+            if (!ParseTrack(in, length, channel, activeClip)) { MLOGW("SequenceData", "Failed to parse track item"); return false; }
+            currentTrack++;
+            currentClip = 0;
+            nextPattern = 0;
+            if (currentTrack >= out.tracks.size()) out.tracks.resize(currentTrack + 1);
+            out.tracks[currentTrack].channel = channel;
+            out.tracks[currentTrack].activeClip = activeClip;
+        }
+        else if (tag == TAG_CLIP)
+        {
+            uint8_t clipId = 0;
+            if (!ParseClip(in, length, clipId)) { MLOGW("SequenceData", "Failed to parse clip item"); return false; }
+            currentClip = clipId;
+            nextPattern = 0;
+            if (currentTrack >= out.tracks.size()) out.tracks.resize(currentTrack + 1);
+        }
+        else if (tag == TAG_PATTERN)
+        {
+            if (currentTrack >= out.tracks.size()) out.tracks.resize(currentTrack + 1);
+            SequenceClip& clip = out.tracks[currentTrack].clips[currentClip];
+            if (clip.patterns.size() <= nextPattern) clip.patterns.resize(nextPattern + 1);
+            if (!ParsePattern(in, length, clip.patterns[nextPattern])) { MLOGW("SequenceData", "Failed to parse pattern item t=%u c=%u p=%u", currentTrack, currentClip, nextPattern); return false; }
+            MLOGD("SequenceData", "Parsed Pattern t=%u c=%u p=%u steps=%u events=%zu", currentTrack, currentClip, nextPattern, clip.patterns[nextPattern].steps, clip.patterns[nextPattern].events.size());
+            nextPattern++;
+        }
+        else if (tag == TAG_INDEX)
+        {
+            // Everything in the index is repeated in the track and clip items
+            if (!SkipRest(in, length, 1)) return false;
+        }
+        else
+        {
+            MLOGW("SequenceData", "Unknown item tag at offset %zu", offset);
+            return false;
+        }
+    }
 
-                buffer.insert(buffer.end(), chunk, chunk + n);
+    return true;
+}
 
-                if (file.Position() >= file.Size())
-                {
-                    eofReached = true;
-                }
-            } while (!itemReady);
+bool DeserializeSequenceIndex(File& file, SequenceData& out)
+{
+    CborReader in(file);
+    if (!ParseHeaderItem(in, out)) return false;
+    if (out.version < MIN_INDEXED_SEQUENCE_VERSION) return false;
+
+    uint64_t length;
+    uint8_t tag;
+    if (!ParseItem(in, length, tag) || tag != TAG_INDEX || length < 3) { MLOGW("SequenceData", "Index parse failed - missing"); return false; }
+
+    cb0r_e type;
+    uint64_t count;
+    uint64_t fields;
+    uint64_t value;
+
+    // Tracks
+    if (!in.Head(type, count) || type != CB0R_ARRAY) { MLOGW("SequenceData", "Index parse failed - tracks missing"); return false; }
+    if (count > 32) { MLOGW("SequenceData", "Index parse failed - %llu tracks", (unsigned long long)count); return false; } // Sequence holds 32 at most
+    out.tracks.resize(count);
+    for (auto& track : out.tracks)
+    {
+        if (!in.Head(type, fields) || type != CB0R_ARRAY || fields < 2) { MLOGW("SequenceData", "Index parse failed - invalid track"); return false; }
+        if (!in.UInt(value)) return false;
+        track.channel = value;
+        if (!in.UInt(value)) return false;
+        track.activeClip = value;
+        if (!SkipRest(in, fields, 2)) return false;
+    }
 
-            MLOGD("SequenceData", "Item parsed offset=%zu consumed=%zu type=%u len=%u first=%02X",
-                  fileOffset, consumed, (unsigned)root.type, (unsigned)root.length, buffer.empty() ? 0 : buffer[0]);
+    // Clips, left on SD until paged in
+    if (!in.Head(type, count) || type != CB0R_ARRAY) { MLOGW("SequenceData", "Index parse failed - clips missing"); return false; }
+    for (uint64_t i = 0; i < count; i++)
+    {
+        uint64_t entry[4];
+        if (!in.Head(type, fields) || type != CB0R_ARRAY || fields < 4) { MLOGW("SequenceData", "Index parse failed - invalid clip"); return false; }
+        for (uint8_t f = 0; f < 4; f++)
+        {
+            if (!in.UInt(entry[f])) return false;
+        }
+        if (!SkipRest(in, fields, 4)) return false;
+        if (entry[0] >= out.tracks.size()) { MLOGW("SequenceData", "Index parse failed - clip on track %u", (unsigned)entry[0]); return false; }
 
-            if (!headerParsed)
-            {
-                if (root.type != CB0R_MAP) { MLOGW("SequenceData", "Header parse failed - not a map"); return false; }
-                if (!ParseHeader(root, out)) { MLOGW("SequenceData", "Header parse failed"); return false; }
-                MLOGD("SequenceData", "Header parsed ver=%u bpm=%u swing=%u patternLen=%u beats=%u beatUnit=%u stepDiv=%u", out.version, out.bpm, out.swing, out.patternLength, out.beatsPerBar, out.beatUnit, out.stepDivision);
-                headerParsed = true;
-                currentTrack = 0xFF;
-                currentClip = 0;
-                nextPattern = 0;
-            }
-            else
-            {
-                if (root.type != CB0R_ARRAY || root.length < 1) {
-                    MLOGW("SequenceData", "Item parse failed - not array (type=%u len=%u)", (unsigned)root.type, (unsigned)root.length);
-                    return false;
-                }
-                cb0r_s tagNode;
-                if (!cb0r_get(&root, 0, &tagNode) || tagNode.type != CB0R_UTF8) { MLOGW("SequenceData", "Item parse failed - tag missing"); return false; }
-                string tag((char*)(tagNode.start + tagNode.header), tagNode.length);
+        SequenceClip& clip = out.tracks[entry[0]].clips[entry[1]];
+        clip.resident = false;
+        clip.fileOffset = entry[2];
+        clip.fileLength = entry[3];
+    }
+    MLOGD("SequenceData", "Index parsed tracks=%zu clips=%u", out.tracks.size(), (unsigned)count);
+    return SkipRest(in, length, 3);
+}
 
-                if (tag == "t")
-                {
-                    uint8_t channel = 0;
-                    uint8_t activeClip = 0;
-                    if (!ParseTrack(root, channel, activeClip)) { MLOGW("SequenceData", "Failed to parse track item"); return false; }
-                    currentTrack++;
-                    currentClip = 0;
-                    nextPattern = 0;
-                    if (currentTrack >= out.tracks.size()) out.tracks.resize(currentTrack + 1);
-                    out.tracks[currentTrack].channel = channel;
-                    out.tracks[currentTrack].activeClip = activeClip;
-                }
-                else if (tag == "c")
-                {
-                    uint8_t clipId = 0;
-                    if (!ParseClip(root, clipId)) { MLOGW("SequenceData", "Failed to parse clip item"); return false; }
-                    currentClip = clipId;
-                    nextPattern = 0;
-                    if (currentTrack >= out.tracks.size()) out.tracks.resize(currentTrack + 1);
-                }
-                else if (tag == "p")
-                {
-                    if (!ParsePattern(root, currentTrack, currentClip, nextPattern, out)) { MLOGW("SequenceData", "Failed to parse pattern item t=%u c=%u p=%u", currentTrack, currentClip, nextPattern); return false; }
-                    nextPattern++;
-                }
-                else
-                {
-                    MLOGW("SequenceData", "Unknown item tag");
-                    return false;
-                }
-            }
+bool DeserializeSequenceClip(File& file, SequenceClip& clip)
+{
+    if (!file.Seek(clip.fileOffset)) { MLOGW("SequenceData", "Clip parse failed - seek to %u", (unsigned)clip.fileOffset); return false; }
+    CborReader in(file);
 
-            buffer.erase(buffer.begin(), buffer.begin() + consumed);
-            fileOffset += consumed;
+    // [TAG_CLIP, clipId] then its patterns, up to fileLength
+    uint64_t length;
+    uint8_t tag;
+    if (!ParseItem(in, length, tag) || tag != TAG_CLIP || !SkipRest(in, length, 1)) { MLOGW("SequenceData", "Clip parse failed - no clip item at %u", (unsigned)clip.fileOffset); return false; }
 
-            if (buffer.empty() && eofReached)
-            {
-                return headerParsed;
-            }
-            break;
-        }
+    vector<SequencePattern> patterns;
+    while (in.Position() < clip.fileLength)
+    {
+        if (!ParseItem(in, length, tag) || tag != TAG_PATTERN) { MLOGW("SequenceData", "Clip parse failed - expected pattern"); return false; }
+        patterns.emplace_back();
+        if (!ParsePattern(in, length, patterns.back())) return false;
     }
 
-    return headerParsed;
+    clip.patterns.swap(patterns);
+    clip.resident = true;
+    return true;
 }
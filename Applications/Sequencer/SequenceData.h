@@ -2,26 +2,42 @@
 
 #include "MatrixOS.h"
 #include "SequenceEvent.h"
+#include "SequenceEventStore.h"
 #include <vector>
 #include <cstdint>
 #include <unordered_map>
 
-#define SEQUENCE_VERSION 3
+#define SEQUENCE_VERSION 5
 #define MIN_SUPPORTED_SEQUENCE_VERSION 3
+#define MIN_INDEXED_SEQUENCE_VERSION 5 // First version with a table of contents, clips can be paged in
 
 struct SequencePattern {
     uint8_t steps = 16;
-    std::multimap<uint16_t, SequenceEvent> events;
+    SequenceEventStore events;
+    uint8_t recordLayerMax = 0; // Upper bound of recordLayer among events, 0 when nothing recorded
+    uint16_t recordLayerEpoch = 0; // Sequence layer epoch the recordLayers were last normalized to
 
     void Clear();
     void ClearStepEvents(uint8_t step, uint16_t pulsesPerStep);
 };
 
 #define SEQUENCE_MAX_PATTERN_COUNT 16
+#define SEQUENCE_EVENT_MIN_SIZE 3 // Smallest encoded event: array head, timestamp, type
 
 
 struct SequenceClip {
     vector<SequencePattern> patterns;
+    bool resident = true;    // False while the patterns are only in the slot file
+    uint32_t fileOffset = 0; // Where the clip is in the slot file, fileLength is 0 if it has not been saved
+    uint32_t fileLength = 0;
+    uint32_t lastUse = 0;    // For LRU eviction
+};
+
+struct SequenceClipLocation {
+    uint8_t track;
+    uint8_t clip;
+    uint32_t offset;
+    uint32_t length;
 };
 
 struct SequenceTrack {
@@ -45,5 +61,16 @@ struct SequenceData {
 };
 
 // Stream-based encoding (CBOR sequence) using File.
-bool SerializeSequenceData(const SequenceData& data, File& file);
+// Clips that are not resident are copied from clipSource. locations receives where each clip went
+bool SerializeSequenceData(const SequenceData& data, File& file, File* clipSource = nullptr, vector<SequenceClipLocation>* locations = nullptr);
 bool DeserializeSequenceData(File& file, SequenceData& out);
+
+// Indexed files only, reads the header and table of contents and leaves every clip on SD. False for older files, import those with DeserializeSequenceData
+bool DeserializeSequenceIndex(File& file, SequenceData& out);
+bool DeserializeSequenceClip(File& file, SequenceClip& clip);
+
+// Single [timestamp, type, payload] event, shared with the edit journal
+class CborWriter;
+class CborReader;
+void SerializeSequenceEvent(CborWriter& out, const std::pair<uint16_t, SequenceEvent>& event);
+bool DeserializeSequenceEvent(CborReader& in, SequenceEvent& event, uint16_t& timestamp);
@@ -15,6 +15,24 @@ SequenceEvent SequenceEvent::ControlChange(const uint8_t param, const uint8_t va
     return {SequenceEventType::ControlChangeEvent, SequenceEventCC{param, value}};
 }
 
+bool SequenceEvent::Same(const SequenceEvent& other) const
+{
+    if (eventType != other.eventType || microtiming != other.microtiming) return false;
+    if (eventType == SequenceEventType::NoteEvent)
+    {
+        const SequenceEventNote& x = std::get<SequenceEventNote>(data);
+        const SequenceEventNote& y = std::get<SequenceEventNote>(other.data);
+        return x.note == y.note && x.velocity == y.velocity && x.length == y.length && x.aftertouch == y.aftertouch;
+    }
+    if (eventType == SequenceEventType::ControlChangeEvent)
+    {
+        const SequenceEventCC& x = std::get<SequenceEventCC>(data);
+        const SequenceEventCC& y = std::get<SequenceEventCC>(other.data);
+        return x.param == y.param && x.value == y.value;
+    }
+    return true;
+}
+
 // SequenceEvent SequenceEvent::ProgramChange(const uint8_t program)
 // {
 //     return {SequenceEventType::ProgramControl, SequenceEventPC{program}};
@@ -4,10 +4,12 @@
 
 #include "MatrixOS.h"
 
+#define SEQUENCE_MICROTIMING_STEPS 128 // Microtiming units per pulse
+
 // Forward declaration
 struct SequenceData;
 
-enum class SequenceEventType {
+enum class SequenceEventType : uint8_t {
     Invalid = 0x00,
     NoteEvent = 0x10,
     ControlChangeEvent = 0x20,
@@ -49,15 +51,16 @@ using SequenceEventData = std::variant<
     SequenceEventCC
 >;
 
-// Main event structure
+// Main event structure, packed to 10 bytes - patterns keep these in flat arrays
 struct SequenceEvent {
     SequenceEventType eventType;
-    SequenceEventData data;
     uint8_t recordLayer = 0;
+    int8_t microtiming = 0; // Where it was played relative to the timestamp, in 1/SEQUENCE_MICROTIMING_STEPS of a pulse
+    SequenceEventData data;
 
     // constructor for factory methods
     SequenceEvent(SequenceEventType type, const SequenceEventData& eventData)
-        : eventType(type), data(eventData), recordLayer(0) {}
+        : eventType(type), recordLayer(0), microtiming(0), data(eventData) {}
 
     // Static factory methods - defined in SequenceEvent.cpp
     static SequenceEvent Note(const uint8_t note, const uint8_t velocity, const bool aftertouch, const uint16_t length = UINT16_MAX /*UINT16_MAX = auto-set to default step length*/);
@@ -66,4 +69,5 @@ struct SequenceEvent {
     // static SequenceEvent BPMChange(const uint16_t bpm);
     // static SequenceEvent SwingChange(const uint8_t swing);
 
+    bool Same(const SequenceEvent& other) const; // Equal apart from recordLayer
 };
@@ -0,0 +1,92 @@
+#include "SequenceEventStore.h"
+#include <algorithm>
+
+SequenceEventStore& SequenceEventStore::operator=(const SequenceEventStore& other)
+{
+    events = other.events;
+    buckets = other.buckets;
+    revision++;
+    return *this;
+}
+
+void SequenceEventStore::clear()
+{
+    events.clear();
+    buckets.clear();
+    revision++;
+}
+
+void SequenceEventStore::swap(SequenceEventStore& other)
+{
+    events.swap(other.events);
+    buckets.swap(other.buckets);
+    revision++;
+    other.revision++;
+}
+
+size_t SequenceEventStore::Find(uint16_t timestamp, bool after) const
+{
+    // Past the last bucket, nothing is this late
+    size_t bucket = timestamp / SEQUENCE_EVENT_BUCKET;
+    if (bucket + 1 >= buckets.size())
+    {
+        return events.size();
+    }
+
+    // Only search inside the bucket
+    auto first = events.begin() + buckets[bucket];
+    auto last = events.begin() + buckets[bucket + 1];
+    if (after)
+    {
+        return std::upper_bound(first, last, timestamp, [](uint16_t time, const value_type& event) { return time < event.first; }) - events.begin();
+    }
+    return std::lower_bound(first, last, timestamp, [](const value_type& event, uint16_t time) { return event.first < time; }) - events.begin();
+}
+
+SequenceEventStore::iterator SequenceEventStore::insert(const value_type& event)
+{
+    size_t bucket = event.first / SEQUENCE_EVENT_BUCKET;
+    if (bucket + 2 > buckets.size())
+    {
+        buckets.resize(bucket + 2, events.size());
+    }
+
+    size_t index = Find(event.first, true);
+    events.insert(events.begin() + index, event);
+    for (size_t i = bucket + 1; i < buckets.size(); i++)
+    {
+        buckets[i]++;
+    }
+    revision++;
+    return events.begin() + index;
+}
+
+SequenceEventStore::iterator SequenceEventStore::erase(iterator position)
+{
+    return erase(position, position + 1);
+}
+
+SequenceEventStore::iterator SequenceEventStore::erase(iterator first, iterator last)
+{
+    size_t start = first - events.begin();
+    size_t end = last - events.begin();
+    if (start == end)
+    {
+        return first;
+    }
+
+    // Buckets starting inside the erased run now start where it was
+    for (uint16_t& bucket : buckets)
+    {
+        if (bucket >= end)
+        {
+            bucket -= end - start;
+        }
+        else if (bucket > start)
+        {
+            bucket = start;
+        }
+    }
+    revision++;
+    return events.erase(first, last);
+}
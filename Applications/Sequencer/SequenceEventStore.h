@@ -0,0 +1,52 @@
+#pragma once
+
+#include "SequenceEvent.h"
+#include <vector>
+#include <utility>
+
+#define SEQUENCE_EVENT_BUCKET 24 // Pulses per index bucket, one 16th note step at 96 PPQN
+
+// A pattern's events in one sorted array, plus the index each step bucket starts at
+// Same interface as the multimap<uint16_t, SequenceEvent> it replaced. Insert and erase invalidate iterators, watch Revision()
+class SequenceEventStore
+{
+public:
+    using value_type = std::pair<uint16_t, SequenceEvent>;
+    using iterator = std::vector<value_type>::iterator;
+    using const_iterator = std::vector<value_type>::const_iterator;
+
+    SequenceEventStore() = default;
+    SequenceEventStore(const SequenceEventStore& other) = default;
+    SequenceEventStore& operator=(const SequenceEventStore& other);
+
+    iterator begin() { return events.begin(); }
+    iterator end() { return events.end(); }
+    const_iterator begin() const { return events.begin(); }
+    const_iterator end() const { return events.end(); }
+    size_t size() const { return events.size(); }
+    bool empty() const { return events.empty(); }
+
+    void clear();
+    void swap(SequenceEventStore& other);
+    void reserve(size_t count) { events.reserve(count); }
+
+    iterator insert(const value_type& event); // Goes after events with the same timestamp
+    iterator erase(iterator position);
+    iterator erase(iterator first, iterator last);
+
+    iterator lower_bound(uint16_t timestamp) { return events.begin() + Find(timestamp, false); }
+    iterator upper_bound(uint16_t timestamp) { return events.begin() + Find(timestamp, true); }
+    std::pair<iterator, iterator> equal_range(uint16_t timestamp) { return {lower_bound(timestamp), upper_bound(timestamp)}; }
+    const_iterator lower_bound(uint16_t timestamp) const { return events.begin() + Find(timestamp, false); }
+    const_iterator upper_bound(uint16_t timestamp) const { return events.begin() + Find(timestamp, true); }
+    std::pair<const_iterator, const_iterator> equal_range(uint16_t timestamp) const { return {lower_bound(timestamp), upper_bound(timestamp)}; }
+
+    uint16_t Revision() const { return revision; } // Changes whenever events move in memory
+
+private:
+    std::vector<value_type> events;
+    std::vector<uint16_t> buckets; // Index of the first event at or after bucket * SEQUENCE_EVENT_BUCKET, the last entry is events.size()
+    uint16_t revision = 0;
+
+    size_t Find(uint16_t timestamp, bool after) const;
+};
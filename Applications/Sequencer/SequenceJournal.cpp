@@ -0,0 +1,336 @@
+#include "SequenceJournal.h"
+
+// Unsigned fields each record needs, in SequenceJournalTag order. Event records carry the event after them
+static const uint8_t recordFields[JOURNAL_TAG_COUNT] = {1, 9, 3, 2, 2, 3, 4, 3, 3, 3};
+
+// Same as far as the slot file can tell, recordLayer is not saved
+static bool SameEvent(const std::pair<uint16_t, SequenceEvent>& a, const std::pair<uint16_t, SequenceEvent>& b)
+{
+    return a.first == b.first && a.second.Same(b.second);
+}
+
+static void WriteEventRecord(CborWriter& out, SequenceJournalTag tag, uint8_t track, uint8_t clip, uint8_t pattern, const std::pair<uint16_t, SequenceEvent>& event)
+{
+    out.Head(CB0R_ARRAY, 5);
+    out.UInt(tag);
+    out.UInt(track);
+    out.UInt(clip);
+    out.UInt(pattern);
+    SerializeSequenceEvent(out, event);
+}
+
+SequenceJournal::SequenceJournal()
+{
+    mutex = xSemaphoreCreateMutex();
+}
+
+SequenceJournal::~SequenceJournal()
+{
+    vSemaphoreDelete(mutex);
+}
+
+void SequenceJournal::Start()
+{
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    entries.clear();
+    settings = false;
+    tracks = 0;
+    active = true;
+    xSemaphoreGive(mutex);
+}
+
+void SequenceJournal::Stop()
+{
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    vector<SequenceJournalEntry>().swap(entries);
+    vector<SequenceJournalEntry>().swap(writing);
+    settings = false;
+    tracks = 0;
+    active = false;
+    xSemaphoreGive(mutex);
+}
+
+void SequenceJournal::LogSettings()
+{
+    if (!active) return;
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    settings = true;
+    xSemaphoreGive(mutex);
+}
+
+void SequenceJournal::LogTrack(uint8_t track)
+{
+    if (!active || track >= 32) return;
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    tracks |= 1UL << track;
+    xSemaphoreGive(mutex);
+}
+
+void SequenceJournal::Log(SequenceJournalTag tag, uint8_t track, uint8_t clip, uint8_t pattern, uint16_t value)
+{
+    LogEvent(tag, track, clip, pattern, value, SequenceEvent{SequenceEventType::Invalid, SequenceEventNote{}});
+}
+
+void SequenceJournal::LogEvent(SequenceJournalTag tag, uint8_t track, uint8_t clip, uint8_t pattern, uint16_t timestamp, const SequenceEvent& event)
+{
+    if (!active) return;
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    entries.push_back(SequenceJournalEntry{tag, track, clip, pattern, timestamp, event});
+    xSemaphoreGive(mutex);
+}
+
+void SequenceJournal::LogClip(uint8_t track, uint8_t clipId, const SequenceClip& clip)
+{
+    if (!active) return;
+    Log(JOURNAL_CLIP_NEW, track, clipId);
+    Log(JOURNAL_PATTERN_COUNT, track, clipId, 0, clip.patterns.size());
+    for (uint8_t patternId = 0; patternId < clip.patterns.size(); patternId++)
+    {
+        const SequencePattern& pattern = clip.patterns[patternId];
+        Log(JOURNAL_PATTERN_LENGTH, track, clipId, patternId, pattern.steps);
+        for (const auto& [timestamp, event] : pattern.events)
+        {
+            LogEvent(JOURNAL_EVENT_ADD, track, clipId, patternId, timestamp, event);
+        }
+    }
+}
+
+void SequenceJournal::LogRecord(const SequenceJournalRecord& record)
+{
+    const uint32_t* fields = record.fields;
+    switch (record.tag)
+    {
+        case JOURNAL_SETTINGS:
+            LogSettings();
+            break;
+        case JOURNAL_TRACK:
+            LogTrack(fields[0]);
+            break;
+        case JOURNAL_CLIP_NEW:
+        case JOURNAL_CLIP_DELETE:
+            Log((SequenceJournalTag)record.tag, fields[0], fields[1]);
+            break;
+        case JOURNAL_PATTERN_COUNT:
+            Log(JOURNAL_PATTERN_COUNT, fields[0], fields[1], 0, fields[2]);
+            break;
+        case JOURNAL_PATTERN_LENGTH:
+            Log(JOURNAL_PATTERN_LENGTH, fields[0], fields[1], fields[2], fields[3]);
+            break;
+        case JOURNAL_PATTERN_DELETE:
+            Log(JOURNAL_PATTERN_DELETE, fields[0], fields[1], fields[2]);
+            break;
+        case JOURNAL_EVENT_ADD:
+        case JOURNAL_EVENT_REMOVE:
+            LogEvent((SequenceJournalTag)record.tag, fields[0], fields[1], fields[2], record.timestamp, record.event);
+            break;
+        default:
+            break;
+    }
+}
+
+uint32_t SequenceJournal::Append(CborWriter& out, const SequenceData& data, bool begin)
+{
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    writing.swap(entries);
+    bool writeSettings = settings;
+    uint32_t writeTracks = tracks;
+    settings = false;
+    tracks = 0;
+    xSemaphoreGive(mutex);
+
+    uint32_t records = 0;
+    if (begin)
+    {
+        out.Head(CB0R_ARRAY, 2);
+        out.UInt(JOURNAL_BEGIN);
+        out.UInt(SEQUENCE_JOURNAL_VERSION);
+        records++;
+    }
+
+    if (writeSettings)
+    {
+        out.Head(CB0R_ARRAY, 10);
+        out.UInt(JOURNAL_SETTINGS);
+        out.UInt(data.bpm);
+        out.UInt(data.swing);
+        out.UInt(data.beatsPerBar);
+        out.UInt(data.beatUnit);
+        out.UInt(data.stepDivision);
+        out.UInt(data.patternLength);
+        out.UInt(data.solo);
+        out.UInt(data.mute);
+        out.UInt(data.record);
+        records++;
+    }
+
+    for (uint8_t trackId = 0; trackId < data.tracks.size() && trackId < 32; trackId++)
+    {
+        if (!(writeTracks & (1UL << trackId))) continue;
+        out.Head(CB0R_ARRAY, 4);
+        out.UInt(JOURNAL_TRACK);
+        out.UInt(trackId);
+        out.UInt(data.tracks[trackId].channel);
+        out.UInt(data.tracks[trackId].activeClip);
+        records++;
+    }
+
+    for (const SequenceJournalEntry& entry : writing)
+    {
+        switch (entry.tag)
+        {
+            case JOURNAL_EVENT_ADD:
+            case JOURNAL_EVENT_REMOVE:
+                WriteEventRecord(out, (SequenceJournalTag)entry.tag, entry.track, entry.clip, entry.pattern, {entry.value, entry.event});
+                break;
+            case JOURNAL_PATTERN_COUNT:
+                out.Head(CB0R_ARRAY, 4);
+                out.UInt(entry.tag);
+                out.UInt(entry.track);
+                out.UInt(entry.clip);
+                out.UInt(entry.value);
+                break;
+            case JOURNAL_PATTERN_LENGTH:
+                out.Head(CB0R_ARRAY, 5);
+                out.UInt(entry.tag);
+                out.UInt(entry.track);
+                out.UInt(entry.clip);
+                out.UInt(entry.pattern);
+                out.UInt(entry.value);
+                break;
+            case JOURNAL_PATTERN_DELETE:
+                out.Head(CB0R_ARRAY, 4);
+                out.UInt(entry.tag);
+                out.UInt(entry.track);
+                out.UInt(entry.clip);
+                out.UInt(entry.pattern);
+                break;
+            default: // Clip new and delete
+                out.Head(CB0R_ARRAY, 3);
+                out.UInt(entry.tag);
+                out.UInt(entry.track);
+                out.UInt(entry.clip);
+                break;
+        }
+        records++;
+    }
+    writing.clear();
+    return records;
+}
+
+bool SequenceJournal::ReadRecord(CborReader& in, SequenceJournalRecord& record)
+{
+    cb0r_e type;
+    uint64_t length;
+    uint64_t value;
+    if (!in.Head(type, length) || type != CB0R_ARRAY || length < 1) return false;
+    if (!in.UInt(value)) return false;
+    record = SequenceJournalRecord();
+    record.tag = value < JOURNAL_TAG_COUNT ? value : JOURNAL_TAG_COUNT;
+
+    // Records from a newer build are skipped whole
+    if (record.tag == JOURNAL_TAG_COUNT)
+    {
+        for (uint64_t i = 1; i < length; i++)
+        {
+            if (!in.SkipItem()) return false;
+        }
+        return true;
+    }
+
+    bool hasEvent = record.tag == JOURNAL_EVENT_ADD || record.tag == JOURNAL_EVENT_REMOVE;
+    uint64_t fields = length - 1;
+    if (hasEvent)
+    {
+        if (fields == 0) return false;
+        fields--;
+    }
+    if (fields < recordFields[record.tag]) return false;
+    for (uint64_t i = 0; i < fields; i++)
+    {
+        if (!in.UInt(value)) return false;
+        if (i < SEQUENCE_JOURNAL_FIELDS) { record.fields[i] = value; }
+    }
+    return !hasEvent || DeserializeSequenceEvent(in, record.event, record.timestamp);
+}
+
+bool SequenceJournal::Apply(SequenceData& data, const SequenceJournalRecord& record)
+{
+    const uint32_t* fields = record.fields;
+    switch (record.tag)
+    {
+        case JOURNAL_BEGIN:
+            return true;
+        case JOURNAL_SETTINGS:
+            data.bpm = fields[0];
+            data.swing = fields[1];
+            data.beatsPerBar = fields[2];
+            data.beatUnit = fields[3];
+            data.stepDivision = fields[4];
+            data.patternLength = fields[5];
+            data.solo = fields[6];
+            data.mute = fields[7];
+            data.record = fields[8];
+            return true;
+        case JOURNAL_TRACK:
+            if (fields[0] >= data.tracks.size()) return false;
+            data.tracks[fields[0]].channel = fields[1];
+            data.tracks[fields[0]].activeClip = fields[2];
+            return true;
+        default:
+            break;
+    }
+    if (!record.HasClip()) return true;
+
+    if (record.Track() >= data.tracks.size()) return false;
+    auto& clips = data.tracks[record.Track()].clips;
+    if (record.tag == JOURNAL_CLIP_NEW)
+    {
+        clips[record.Clip()] = SequenceClip();
+        return true;
+    }
+    if (record.tag == JOURNAL_CLIP_DELETE)
+    {
+        return clips.erase(record.Clip()) > 0;
+    }
+
+    auto it = clips.find(record.Clip());
+    if (it == clips.end() || !it->second.resident) return false;
+    vector<SequencePattern>& patterns = it->second.patterns;
+    if (record.tag == JOURNAL_PATTERN_COUNT)
+    {
+        if (fields[2] > SEQUENCE_MAX_PATTERN_COUNT) return false;
+        patterns.resize(fields[2]);
+        return true;
+    }
+
+    if (fields[2] >= patterns.size()) return false;
+    if (record.tag == JOURNAL_PATTERN_DELETE)
+    {
+        patterns.erase(patterns.begin() + fields[2]);
+        return true;
+    }
+    SequencePattern& pattern = patterns[fields[2]];
+    if (record.tag == JOURNAL_PATTERN_LENGTH)
+    {
+        pattern.steps = fields[3];
+        return true;
+    }
+
+    std::pair<uint16_t, SequenceEvent> event{record.timestamp, record.event};
+    if (record.tag == JOURNAL_EVENT_ADD)
+    {
+        pattern.events.insert(event);
+        return true;
+    }
+
+    auto [first, last] = pattern.events.equal_range(record.timestamp);
+    for (auto found = first; found != last; ++found)
+    {
+        if (SameEvent(*found, event))
+        {
+            pattern.events.erase(found);
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "SequenceData.h"
+#include "CborStream.h"
+
+#define SEQUENCE_JOURNAL_VERSION 2 // Adds JOURNAL_PATTERN_DELETE, version 1 journals still replay
+#define SEQUENCE_JOURNAL_FIELDS 9 // Most unsigned fields a record carries, the settings record
+
+// Record tags, each record is one CBOR array [tag, fields..., event]
+enum SequenceJournalTag : uint8_t
+{
+    JOURNAL_BEGIN = 0,          // [tag, version], first record of every journal
+    JOURNAL_SETTINGS = 1,       // [tag, bpm, swing, beatsPerBar, beatUnit, stepDivision, patternLength, solo, mute, record]
+    JOURNAL_TRACK = 2,          // [tag, track, channel, activeClip]
+    JOURNAL_CLIP_NEW = 3,       // [tag, track, clip]
+    JOURNAL_CLIP_DELETE = 4,    // [tag, track, clip]
+    JOURNAL_PATTERN_COUNT = 5,  // [tag, track, clip, count]
+    JOURNAL_PATTERN_LENGTH = 6, // [tag, track, clip, pattern, steps]
+    JOURNAL_EVENT_ADD = 7,      // [tag, track, clip, pattern, event]
+    JOURNAL_EVENT_REMOVE = 8,   // [tag, track, clip, pattern, event]
+    JOURNAL_PATTERN_DELETE = 9, // [tag, track, clip, pattern], later patterns move down
+    JOURNAL_TAG_COUNT,
+};
+
+struct SequenceJournalRecord
+{
+    uint8_t tag = JOURNAL_TAG_COUNT;
+    uint32_t fields[SEQUENCE_JOURNAL_FIELDS] = {};
+    uint16_t timestamp = 0;
+    SequenceEvent event{SequenceEventType::Invalid, SequenceEventNote{}};
+
+    bool HasClip() const { return tag >= JOURNAL_CLIP_NEW && tag < JOURNAL_TAG_COUNT; }
+    uint8_t Track() const { return fields[0]; }
+    uint8_t Clip() const { return fields[1]; }
+};
+
+// One edit waiting to be written, value is the timestamp of an event, the steps of a pattern length or the count of a pattern count
+struct SequenceJournalEntry
+{
+    uint8_t tag;
+    uint8_t track;
+    uint8_t clip;
+    uint8_t pattern;
+    uint16_t value;
+    SequenceEvent event;
+};
+
+// Append-only log of edits on top of a slot file
+// Sequence logs each edit where it makes it, the entries wait in RAM until the next append writes them out.
+// Settings and track fields are only flagged, their values as of the append are written. Logging may come from the tick task
+class SequenceJournal
+{
+public:
+    SequenceJournal();
+    ~SequenceJournal();
+
+    void Start(); // The sequence as it is now is what the slot file holds, nothing to write
+    void Stop();
+    bool Active() const { return active; }
+
+    void LogSettings();
+    void LogTrack(uint8_t track);
+    void Log(SequenceJournalTag tag, uint8_t track, uint8_t clip, uint8_t pattern = 0, uint16_t value = 0);
+    void LogEvent(SequenceJournalTag tag, uint8_t track, uint8_t clip, uint8_t pattern, uint16_t timestamp, const SequenceEvent& event);
+    void LogClip(uint8_t track, uint8_t clipId, const SequenceClip& clip); // The whole clip as new
+    void LogRecord(const SequenceJournalRecord& record); // A replayed record, for when the journal it came from is rewritten
+
+    // Writes what was logged since the last append. begin opens a new journal
+    uint32_t Append(CborWriter& out, const SequenceData& data, bool begin);
+
+    static bool ReadRecord(CborReader& in, SequenceJournalRecord& record);
+    static bool Apply(SequenceData& data, const SequenceJournalRecord& record);
+
+private:
+    SemaphoreHandle_t mutex;
+    bool active = false;
+    bool settings = false;
+    uint32_t tracks = 0; // Bitmap of tracks whose channel or active clip changed
+    vector<SequenceJournalEntry> entries;
+    vector<SequenceJournalEntry> writing; // Swapped with entries on append, so logging never waits on SD
+};
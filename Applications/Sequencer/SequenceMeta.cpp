@@ -3,6 +3,7 @@
 #include "cb0rHelper.h"
 #include <string>
 #include <cstring>
+#include <algorithm>
 
 using std::vector;
 using std::string;
@@ -28,6 +29,7 @@ void SequenceMeta::New(uint8_t tracks)
     float hue = hueIndex * hueStep;
     color = Color::HsvToRgb(hue, 1.0f, 1.0f);
     clockOutput = false;
+    recordQuantize = 0;
     for(uint8_t i = 0; i < tracks; i++)
     {
         SequenceMetaTrack track;
@@ -50,9 +52,10 @@ bool SerializeSequenceMeta(const SequenceMeta& meta, File& file)
 
     // Header map (no track count stored; we stream until EOF)
     buffer.clear();
-    cb_write_uint(buffer, CB0R_MAP, 2);
+    cb_write_uint(buffer, CB0R_MAP, 3);
     cb_write_text(buffer, "color"); cb_write_uint(buffer, CB0R_INT, meta.color.RGB());
     cb_write_text(buffer, "clock"); cb_write_bool(buffer, meta.clockOutput);
+    cb_write_text(buffer, "rquant"); cb_write_uint(buffer, CB0R_INT, meta.recordQuantize);
     MLOGD("SequenceMeta", "Serialize header color=0x%06X clock=%d tracks=%u", meta.color.RGB(), meta.clockOutput ? 1 : 0, (unsigned)meta.tracks.size());
     if (file.Write(buffer.data(), buffer.size()) != buffer.size()) return false;
 
@@ -165,6 +168,8 @@ bool DeserializeSequenceMeta(File& file, SequenceMeta& out)
     cb0r_s item;
     if (cb0r_find(&root, CB0R_UTF8, 5, (uint8_t*)"color", &item)) out.color = Color(item.value);
     if (cb0r_find(&root, CB0R_UTF8, 5, (uint8_t*)"clock", &item)) out.clockOutput = (item.type == CB0R_TRUE) || (item.type == CB0R_INT && item.value != 0);
+    out.recordQuantize = 0;
+    if (cb0r_find(&root, CB0R_UTF8, 6, (uint8_t*)"rquant", &item) && item.type == CB0R_INT) out.recordQuantize = std::min<uint64_t>(item.value, 100);
     MLOGD("SequenceMeta", "Header parsed color=0x%06X", out.color.RGB());
     out.tracks.clear();
     offset += consumed;
@@ -44,6 +44,7 @@ struct SequenceMetaTrack {
 struct SequenceMeta {
     Color color;
     bool clockOutput;
+    uint8_t recordQuantize = 0; // Percent, see Sequence::SetRecordQuantize
     vector<SequenceMetaTrack> tracks;
 
     void New(uint8_t tracks);
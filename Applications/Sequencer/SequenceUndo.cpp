@@ -0,0 +1,54 @@
+#include "SequenceUndo.h"
+
+void SequenceUndo::Clear()
+{
+    tail = cursor = head = 0;
+    pendingMark = true;
+    overflow = false;
+}
+
+void SequenceUndo::Log(SequenceUndoOp op, uint8_t track, uint8_t clip, uint8_t pattern, uint16_t timestamp, const SequenceEvent& event)
+{
+    bool begin = pendingMark;
+    if (pendingMark)
+    {
+        pendingMark = false;
+        overflow = false;
+    }
+    else if (overflow)
+    {
+        return;
+    }
+
+    if (entries.empty())
+    {
+        entries.resize(SEQUENCE_UNDO_CAPACITY);
+    }
+
+    // A new edit replaces whatever was undone
+    head = cursor;
+    begin = begin || cursor == tail;
+
+    if (head - tail == SEQUENCE_UNDO_CAPACITY)
+    {
+        // Full, drop the oldest edit as a whole
+        do { tail++; } while (tail != head && !entries[tail % SEQUENCE_UNDO_CAPACITY].begin);
+        if (tail == head)
+        {
+            // This edit alone filled the ring, it can't be undone anyway
+            overflow = true;
+            return;
+        }
+    }
+
+    SequenceUndoEntry& entry = entries[head % SEQUENCE_UNDO_CAPACITY];
+    entry.op = op;
+    entry.begin = begin;
+    entry.track = track;
+    entry.clip = clip;
+    entry.pattern = pattern;
+    entry.timestamp = timestamp;
+    entry.event = event;
+    entry.event.recordLayer = 0; // Comes back as a plain edit, not part of any recording
+    cursor = ++head;
+}
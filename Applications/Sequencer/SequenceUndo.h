@@ -0,0 +1,72 @@
+#pragma once
+
+#include "SequenceEvent.h"
+
+#define SEQUENCE_UNDO_CAPACITY 1024 // Entries kept, 16 bytes each. Power of two so the counters can wrap
+
+enum class SequenceUndoOp : uint8_t
+{
+    AddEvent,    // Undo removes the event, redo puts it back
+    RemoveEvent, // Undo puts the event back
+    SetSteps,    // timestamp holds old steps << 8 | new steps
+};
+
+struct SequenceUndoEntry
+{
+    SequenceUndoOp op = SequenceUndoOp::AddEvent;
+    bool begin = false; // First entry of an edit, undo and redo move a whole edit at a time
+    uint8_t track = 0;
+    uint8_t clip = 0;
+    uint8_t pattern = 0;
+    uint16_t timestamp = 0;
+    SequenceEvent event{SequenceEventType::Invalid, SequenceEventNote{}};
+};
+
+// Bounded log of pattern edits, one entry per event added or removed
+// Entries go in a ring allocated on first use, the oldest edits are dropped when it fills up
+class SequenceUndo
+{
+public:
+    void Mark() { pendingMark = true; } // Whatever is logged next starts a new edit
+    void Clear();
+    void Log(SequenceUndoOp op, uint8_t track, uint8_t clip, uint8_t pattern, uint16_t timestamp, const SequenceEvent& event);
+
+    bool CanUndo() const { return cursor != tail; }
+    bool CanRedo() const { return cursor != head; }
+
+    // Hands apply(entry, forward) each entry of the last edit, newest first
+    template <typename Apply>
+    bool Undo(Apply apply)
+    {
+        if (!CanUndo()) return false;
+        do
+        {
+            cursor--;
+            apply(entries[cursor % SEQUENCE_UNDO_CAPACITY], false);
+        } while (!entries[cursor % SEQUENCE_UNDO_CAPACITY].begin);
+        pendingMark = true;
+        return true;
+    }
+
+    // Hands apply(entry, forward) each entry of the next undone edit, oldest first
+    template <typename Apply>
+    bool Redo(Apply apply)
+    {
+        if (!CanRedo()) return false;
+        do
+        {
+            apply(entries[cursor % SEQUENCE_UNDO_CAPACITY], true);
+            cursor++;
+        } while (cursor != head && !entries[cursor % SEQUENCE_UNDO_CAPACITY].begin);
+        pendingMark = true;
+        return true;
+    }
+
+private:
+    vector<SequenceUndoEntry> entries;
+    uint32_t tail = 0;   // Oldest entry, always the start of an edit
+    uint32_t cursor = 0; // Entries before this are applied
+    uint32_t head = 0;   // Entries from cursor up to this were undone and can be redone
+    bool pendingMark = true;
+    bool overflow = false; // The current edit outgrew the ring, the rest of it is not logged
+};
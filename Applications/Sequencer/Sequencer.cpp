@@ -23,13 +23,17 @@ void Sequencer::SequenceTask(void* ctx)
     Sequencer* self = static_cast<Sequencer*>(ctx);
     for (;;)
     {
+        // Sleep until the OS clock wakes us on a pulse, the idle timeout keeps MIDI input and count-in moving
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(SEQUENCER_IDLE_INTERVAL));
+
+        // Recorded at the time each packet came in, not when this loop got to it
         MidiPacket midiPacket;
-        while(MatrixOS::MIDI::Get(&midiPacket))
+        uint32_t arrival;
+        while(MatrixOS::MIDI::Get(&midiPacket, 0, &arrival))
         {
-            self->sequence.RecordEvent(midiPacket);
+            self->sequence.RecordEvent(midiPacket, 0xFF, arrival);
         }
         self->sequence.Tick();
-        taskYIELD();
     }
 }
 
@@ -42,11 +46,15 @@ void Sequencer::Setup(const vector<string> &args)
         saveSlot = 0xFFFF;
     }
 
+    MatrixOS::Clock::SetSource(MatrixOS::Clock::CLOCK_SOURCE_INTERNAL); // The sequencer keeps its own time, whatever the last app left
     sequence.EnableClockOutput(meta.clockOutput);
+    sequence.SetRecordQuantize(meta.recordQuantize);
 
     if (tickTaskHandle == nullptr)
     {
-        xTaskCreate(SequenceTask, "SeqTick", configMINIMAL_STACK_SIZE * 2, this, 1, &tickTaskHandle);
+        // Above the UI so rendering keeps its lookahead while it redraws, the clock task sends the output
+        xTaskCreate(SequenceTask, "SeqTick", configMINIMAL_STACK_SIZE * 2, this, configMAX_PRIORITIES - 3, &tickTaskHandle);
+        sequence.SetTickTask(tickTaskHandle);
     }
 
     SequencerUI();
@@ -54,7 +62,11 @@ void Sequencer::Setup(const vector<string> &args)
 
 void Sequencer::End()
 {
+    WaitForSave();
+    AppendJournal();
     sequence.Stop();
+    sequence.EnableClockOutput(false);
+    sequence.SetTickTask(nullptr);
     if (tickTaskHandle)
     {
         vTaskDelete(tickTaskHandle);
@@ -103,9 +115,16 @@ void Sequencer::SequencerUI()
     SequencerMessageDisplay messageDisplay(this);
     sequencerUI.AddUIComponent(messageDisplay, Point(0, 3));
 
+    sequencerUI.SetLoopFunc([&]() -> void { JournalLoop(); });
+
     sequencerUI.AllowExit(false);
     sequencerUI.SetKeyEventHandler([&](KeyEvent *keyEvent) -> bool
                                    {
+    if (keyEvent->info.state == PRESSED)
+    {
+      sequence.UndoMark(); // Whatever this press edits undoes as one
+    }
+
     if (keyEvent->id == FUNCTION_KEY)
     {
       if (keyEvent->info.state == PRESSED)
@@ -963,6 +982,21 @@ void Sequencer::SwingSelector()
     });
     swingUI.AddUIComponent(resetButton, Point(7, 6));
 
+    // Record quantize, each press steps the strength up a quarter and wraps back to off
+    UIButton recordQuantizeButton;
+    recordQuantizeButton.SetName("Record Quantize");
+    recordQuantizeButton.SetColorFunc([&]() -> Color
+                                      { return Color(0xFF0000).Scale(meta.recordQuantize == 0 ? 32 : 63 + meta.recordQuantize * 192 / 100); });
+    recordQuantizeButton.OnPress([&]() -> void
+    {
+        meta.recordQuantize = meta.recordQuantize >= 100 ? 0 : meta.recordQuantize + 25;
+        sequence.SetRecordQuantize(meta.recordQuantize);
+        sequence.SetDirty();
+    });
+    recordQuantizeButton.OnHold([&]() -> void
+                                { MatrixOS::UIUtility::TextScroll("Record Quantize " + std::to_string(meta.recordQuantize) + "%", Color(0xFF0000)); });
+    swingUI.AddUIComponent(recordQuantizeButton, Point(0, 6));
+
     swingUI.Start();
 
     if (sequence.GetSwing() != (uint8_t)swingValue)
@@ -1326,7 +1360,7 @@ void Sequencer::SetMessage(SequencerMessage msg, bool stayOn)
     lastMessageTime = stayOn ? UINT32_MAX : MatrixOS::SYS::Millis();
 }
 
-bool Sequencer::Save(uint16_t slot)
+uint16_t Sequencer::PrepareSaveSlot(uint16_t slot)
 {
     if (slot == 0xFFFF) { 
         MLOGD("Sequencer", "Load - No Previous Assigned Slot - Finding the next available slot"); 
@@ -1342,19 +1376,19 @@ bool Sequencer::Save(uint16_t slot)
         if (freeSlot == 0xFFFF)
         {
             MLOGE("Sequencer", "Save - no free slot available");
-            return false;
+            return 0xFFFF;
         }
         slot = freeSlot;
         MLOGD("Sequencer", "Save - using free slot %u", slot);
     } 
 
-    if (slot >= SD_SLOT_MAX) { MLOGE("Sequencer", "Save - slot out of range %u", slot); return false; }
-    if (!MatrixOS::FileSystem::Available()) { MLOGE("Sequencer", "Save - filesystem not available"); return false; }
+    if (slot >= SD_SLOT_MAX) { MLOGE("Sequencer", "Save - slot out of range %u", slot); return 0xFFFF; }
+    if (!MatrixOS::FileSystem::Available()) { MLOGE("Sequencer", "Save - filesystem not available"); return 0xFFFF; }
 
     if (!MatrixOS::FileSystem::Exists("/sequences") && !MatrixOS::FileSystem::MakeDir("/sequences"))
     {
         MLOGE("Sequencer", "Save - failed to create /sequences");
-        return false;
+        return 0xFFFF;
     }
     else if (!MatrixOS::FileSystem::Exists("/sequences"))
     {
@@ -1367,51 +1401,211 @@ bool Sequencer::Save(uint16_t slot)
         if (!MatrixOS::FileSystem::MakeDir(slotDir))
         {
             MLOGE("Sequencer", "Save - failed to create %s", slotDir.c_str());
-            return false;
+            return 0xFFFF;
         }
         MLOGD("Sequencer", "Save - created slot dir %s", slotDir.c_str());
     }
+    return slot;
+}
 
+bool Sequencer::WriteSlot(uint16_t slot, const SequenceData& data, const SequenceMeta& meta, const string& clipSource)
+{
     // Sequence file paths
+    string slotDir = "/sequences/" + std::to_string(slot + 1);
     string dataPath = slotDir + "/sequence.data";
     string metaPath = slotDir + "/sequence.meta";
+    string dataTemp = dataPath + ".tmp";
+    string metaTemp = metaPath + ".tmp";
 
-    if (!BackupSlot(slot)) return false;
-
-    // Write meta first
-    File metaFile = MatrixOS::FileSystem::Open(metaPath, "wb");
-    if (metaFile.Name().empty()) { MLOGE("Sequencer", "Save - open meta fail %s", metaPath.c_str()); return false; }
+    // Write both files beside the live ones, the slot stays intact until they are complete
+    File metaFile = MatrixOS::FileSystem::Open(metaTemp, "wb");
+    if (metaFile.Name().empty()) { MLOGE("Sequencer", "Save - open meta fail %s", metaTemp.c_str()); return false; }
     bool metaOk = SerializeSequenceMeta(meta, metaFile);
     size_t metaFileSize = metaFile.Size();
     metaFile.Close();
     if (!metaOk) { MLOGE("Sequencer", "Save - write meta failed"); return false; }
-    MLOGD("Sequencer", "Save - sequence meta written to %s, size=%u", metaPath.c_str(), (unsigned)metaFileSize);
+    MLOGD("Sequencer", "Save - sequence meta written to %s, size=%u", metaTemp.c_str(), (unsigned)metaFileSize);
+
+    // Clips that were never paged in are copied from the file they live in
+    File sourceFile = clipSource.empty() ? File() : MatrixOS::FileSystem::Open(clipSource, "rb");
+    if (!clipSource.empty() && sourceFile.Name().empty()) { MLOGE("Sequencer", "Save - open clip source fail %s", clipSource.c_str()); return false; }
 
-    // Write sequence data
-    File dataFile = MatrixOS::FileSystem::Open(dataPath, "wb");
-    if (dataFile.Name().empty()) { MLOGE("Sequencer", "Save - open fail %s", dataPath.c_str()); return false; }
-    bool dataOk = SerializeSequenceData(sequence.GetData(), dataFile);
+    File dataFile = MatrixOS::FileSystem::Open(dataTemp, "wb");
+    if (dataFile.Name().empty()) { MLOGE("Sequencer", "Save - open fail %s", dataTemp.c_str()); return false; }
+    vector<SequenceClipLocation> locations;
+    bool dataOk = SerializeSequenceData(data, dataFile, clipSource.empty() ? nullptr : &sourceFile, &locations);
     size_t dataFileSize = dataFile.Size();
     dataFile.Close();
+    if (!clipSource.empty()) { sourceFile.Close(); }
     if (!dataOk) { MLOGE("Sequencer", "Save - serialize stream failed"); return false; }
-    MLOGD("Sequencer", "Save - sequence data written to %s size=%u", dataPath.c_str(), (unsigned)dataFileSize);
+    MLOGD("Sequencer", "Save - sequence data written to %s size=%u", dataTemp.c_str(), (unsigned)dataFileSize);
+
+    // Both files are complete, mark them so a save cut off from here on is finished by RecoverSlot instead of lost
+    File commitFile = MatrixOS::FileSystem::Open(slotDir + "/sequence.commit", "wb");
+    if (commitFile.Name().empty()) { MLOGE("Sequencer", "Save - open commit marker fail"); return false; }
+    commitFile.Close();
+
+    // Move the old files to prev, then rename the new ones into place. Paging waits, the clip source may be moving
+    sequence.LockClipSource();
+    bool ok = CommitSlot(slot);
+    if (ok) { sequence.ClipsSaved(dataPath, locations); }
+    sequence.UnlockClipSource();
+    return ok;
+}
+
+bool Sequencer::Save(uint16_t slot)
+{
+    WaitForSave();
+
+    slot = PrepareSaveSlot(slot);
+    if (slot == 0xFFFF) return false;
 
+    // Writes straight from the live patterns, recording waits until the journal restarts on what was written
+    SequenceLock lock(sequence);
+    if (!WriteSlot(slot, sequence.GetData(), meta, sequence.GetClipSource())) return false;
+
+    // Edits journaled against another slot are in this save now
+    if (saveSlot != 0xFFFF && saveSlot != slot)
+    {
+        MatrixOS::FileSystem::Remove("/sequences/" + std::to_string(saveSlot + 1) + "/sequence.journal");
+    }
     saveSlot = slot;
     sequence.SetDirty(false);
+    sequence.StartJournal();
+    journalSize = 0;
+    return true;
+}
+
+// What a background save writes, owned by the save task
+struct SequencerSaveJob
+{
+    Sequencer* sequencer;
+    uint16_t slot;
+    SequenceData data;
+    SequenceMeta meta;
+    string clipSource;
+};
+
+bool Sequencer::SaveInBackground(uint16_t slot)
+{
+    if (saveState == SaveState::Saving) return false;
+
+    slot = PrepareSaveSlot(slot);
+    if (slot == 0xFFFF) { saveState = SaveState::Failed; return false; }
+
+    // Whichever way the save goes, the slot file plus its journal match the snapshot
+    AppendJournal();
+
+    // The snapshot is a full copy of every resident clip, so pattern memory doubles until the save task frees it
+    // Clips still on SD are not copied at all, the save task reads them from the clip source
+    // Recording inserts from the tick task, it waits until the copy is taken and the journal restarts on it
+    sequence.Lock();
+    SequencerSaveJob* job = new SequencerSaveJob{this, slot, sequence.GetData(), meta, sequence.GetClipSource()};
+
+    // Edits made while the save runs mark the sequence dirty again, and are journaled once it is done
+    sequence.SetDirty(false);
+    sequence.StartJournal();
+    sequence.Unlock();
+    saveState = SaveState::Saving;
+    if (xTaskCreate(SaveTask, "SeqSave", SEQUENCER_SAVE_STACK_SIZE, job, tskIDLE_PRIORITY + 1, nullptr) != pdPASS)
+    {
+        MLOGE("Sequencer", "Save - failed to start save task");
+        delete job;
+        sequence.SetDirty();
+        saveState = SaveState::Failed;
+        return false;
+    }
+    return true;
+}
+
+void Sequencer::SaveTask(void* ctx)
+{
+    SequencerSaveJob* job = static_cast<SequencerSaveJob*>(ctx);
+    Sequencer* self = job->sequencer;
+
+    bool ok = self->WriteSlot(job->slot, job->data, job->meta, job->clipSource);
+    if (ok)
+    {
+        if (self->saveSlot != 0xFFFF && self->saveSlot != job->slot)
+        {
+            MatrixOS::FileSystem::Remove("/sequences/" + std::to_string(self->saveSlot + 1) + "/sequence.journal");
+        }
+        self->saveSlot = job->slot;
+        self->journalSize = 0;
+    }
+    else
+    {
+        self->sequence.SetDirty();
+    }
+    delete job;
+
+    self->saveState = ok ? SaveState::Saved : SaveState::Failed;
+    vTaskDelete(NULL);
+}
+
+bool Sequencer::AppendJournal()
+{
+    // Appends wait out a background save, it may be moving the journal to prev
+    if (saveSlot == 0xFFFF || saveState == SaveState::Saving || !sequence.JournalActive()) return false;
+    if (!MatrixOS::FileSystem::Available()) return false;
+
+    string journalPath = "/sequences/" + std::to_string(saveSlot + 1) + "/sequence.journal";
+    bool begin = !MatrixOS::FileSystem::Exists(journalPath);
+    File journalFile = MatrixOS::FileSystem::Open(journalPath, "ab");
+    if (journalFile.Name().empty()) { MLOGE("Sequencer", "Journal - open fail %s", journalPath.c_str()); return false; }
+    uint32_t records = 0;
+    bool ok = sequence.AppendJournal(journalFile, begin, records);
+    journalSize = journalFile.Size();
+    journalFile.Close();
+
+    if (!ok)
+    {
+        // The journal's copy of the sequence has moved on without it, the next full save starts a new journal
+        MLOGE("Sequencer", "Journal - append to %s failed", journalPath.c_str());
+        sequence.StopJournal();
+        return false;
+    }
+    if (records > 0) { MLOGD("Sequencer", "Journal - %u records, %u bytes", (unsigned)records, (unsigned)journalSize); }
     return true;
 }
 
+void Sequencer::JournalLoop()
+{
+    if (!sequence.GetDirty() || MatrixOS::SYS::Millis() - journalTime < SEQUENCER_JOURNAL_INTERVAL) return;
+
+    journalTime = MatrixOS::SYS::Millis();
+    if (!AppendJournal()) return;
+
+    if (journalSize >= SEQUENCER_JOURNAL_COMPACT_SIZE)
+    {
+        MLOGD("Sequencer", "Journal - compacting %u bytes into slot %u", (unsigned)journalSize, saveSlot);
+        SaveInBackground(saveSlot);
+    }
+}
+
+void Sequencer::WaitForSave()
+{
+    while (saveState == SaveState::Saving)
+    {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+}
+
 bool Sequencer::Load(uint16_t slot)
 {
+    WaitForSave();
+    AppendJournal();
     sequence.Stop();
 
     if (slot == 0xFFFF) { MLOGD("Sequencer", "Load - No Previous Assigned Slot"); return false; }
     if (slot >= SD_SLOT_MAX) { MLOGE("Sequencer", "Load - slot out of range %u", slot); return false; }
     if (!MatrixOS::FileSystem::Available()) { MLOGE("Sequencer", "Load - filesystem not available"); return false; }
+    RecoverSlot(slot);
 
     string slotDir = "/sequences/" + std::to_string(slot + 1);
     string dataPath = slotDir + "/sequence.data";
     string metaPath = slotDir + "/sequence.meta";
+    string journalPath = slotDir + "/sequence.journal";
 
     // Ensure slot and prev directories exist
     if (!MatrixOS::FileSystem::Exists("/sequences"))
@@ -1437,16 +1631,54 @@ bool Sequencer::Load(uint16_t slot)
     // Read sequence data
     File dataFile = MatrixOS::FileSystem::Open(dataPath, "rb");
     if (dataFile.Name().empty()) { MLOGE("Sequencer", "Load - open fail %s", dataPath.c_str()); return false; }
-    SequenceData dataCopy = sequence.GetData();
-    bool dataOk = DeserializeSequenceData(dataFile, dataCopy);
+    // Indexed files only bring in the header and clip table, clips page in when they are first played or edited
+    SequenceData dataCopy;
+    bool indexed = DeserializeSequenceIndex(dataFile, dataCopy);
+    bool dataOk = indexed;
+    if (!indexed)
+    {
+        dataCopy = SequenceData();
+        dataFile.Seek(0);
+        dataOk = DeserializeSequenceData(dataFile, dataCopy);
+    }
     dataFile.Close();
     if (!dataOk) { MLOGE("Sequencer", "Load - deserialize data failed"); return false; }
-    MLOGD("Sequencer", "Loaded sequence data from %s", dataPath.c_str());
-    
+    MLOGD("Sequencer", "Loaded sequence %s from %s", indexed ? "index" : "data", dataPath.c_str());
+
     sequence.SetData(dataCopy);
+    sequence.SetClipSource(indexed ? dataPath : "");
+    for (uint8_t track = 0; track < sequence.GetTrackCount(); track++)
+    {
+        sequence.PageInClip(track, sequence.GetPosition(track)->clip);
+    }
+
+    // Replay edits journaled since the slot was saved
+    sequence.StartJournal();
+    uint32_t replayed = 0;
+    journalSize = 0;
+    if (MatrixOS::FileSystem::Exists(journalPath))
+    {
+        File journalFile = MatrixOS::FileSystem::Open(journalPath, "rb");
+        bool complete = !journalFile.Name().empty() && sequence.ReplayJournal(journalFile, replayed);
+        journalSize = journalFile.Size();
+        journalFile.Close();
+        if (complete)
+        {
+            sequence.StartJournal();
+        }
+        else
+        {
+            // Appending after a partial record would hide everything behind it. Start over, replay logged its edits again for the next append
+            MatrixOS::FileSystem::Remove(journalPath);
+            journalSize = 0;
+        }
+        MLOGD("Sequencer", "Load - replayed %u journal records from %s", (unsigned)replayed, journalPath.c_str());
+    }
+
     meta = metaCopy;
+    sequence.SetRecordQuantize(meta.recordQuantize);
     saveSlot = slot;
-    sequence.SetDirty(false);
+    sequence.SetDirty(replayed > 0);
     MLOGD("Sequencer", "Loaded SD slot %u", slot);
     return true;
 }
@@ -1458,6 +1690,7 @@ bool Sequencer::Saved(uint16_t slot)
     string base = "/sequences/" + std::to_string(slot + 1) + "/";
     string dataPath = base + "sequence.data";
     string metaPath = base + "sequence.meta";
+    if (saveState != SaveState::Saving) { RecoverSlot(slot); } // A save in progress has its own files half moved
     MLOGD("Sequencer", "Saved Slot %d - %d|%d", slot, MatrixOS::FileSystem::Exists(dataPath), MatrixOS::FileSystem::Exists(metaPath));
     return MatrixOS::FileSystem::Exists(dataPath) && MatrixOS::FileSystem::Exists(metaPath);
 }
@@ -1555,6 +1788,7 @@ static void RenderPlus(Point origin, Color color)
 void Sequencer::ConfirmSaveUI()
 {
     UI confirmSaveUI("Confirm Save", meta.color, false);
+    bool saving = false;
     bool saved = false;
     bool failed = false;
     uint32_t openTime = MatrixOS::SYS::Millis();
@@ -1562,6 +1796,14 @@ void Sequencer::ConfirmSaveUI()
 
     confirmSaveUI.SetPostRenderFunc([&]() -> void
                                     {
+                                        if(saving && saveState != SaveState::Saving)
+                                        {
+                                            saving = false;
+                                            saved = saveState == SaveState::Saved;
+                                            failed = !saved;
+                                            savedTime = MatrixOS::SYS::Millis();
+                                        }
+
                                         if(saved == false)
                                         {
                                             uint8_t scale = ColorEffects::Strobe(500, openTime);
@@ -1584,6 +1826,11 @@ void Sequencer::ConfirmSaveUI()
     
     confirmSaveUI.SetKeyEventHandler([&](KeyEvent *keyEvent) -> bool
                                      {
+            if(saving)
+            {
+                return true;
+            }
+
             if((saved || failed))
             {
                 if(keyEvent->info.state == PRESSED)
@@ -1601,15 +1848,14 @@ void Sequencer::ConfirmSaveUI()
                 if (keyEvent->info.state == RELEASED && keyEvent->Hold() == false)
                 {
                     RenderDownArrow(Point(2,2), Color::White);
-                    bool success = Save(saveSlot);
-                    savedTime = MatrixOS::SYS::Millis();
-                    if(success)
+                    if(SaveInBackground(saveSlot))
                     {
-                        saved = true;
+                        saving = true;
                     }
                     else
                     {
                         failed = true;
+                        savedTime = MatrixOS::SYS::Millis();
                     }
                     return true;
                 }
@@ -1912,8 +2158,10 @@ void Sequencer::SequenceBrowser()
                         {
                             RenderPlus(Point(2, 2), Color::White);
                             MatrixOS::LED::Update();
+                            WaitForSave();
                             sequence.New(8);
                             meta.New(8);
+                            sequence.SetRecordQuantize(meta.recordQuantize);
                             saveSlot = slot;
                             if(Save(slot))
                             {
@@ -2012,11 +2260,22 @@ void Sequencer::SequenceBrowser()
 bool Sequencer::ClearSlot(uint16_t slot)
 {
     if (!MatrixOS::FileSystem::Available()) return false;
+    WaitForSave();
     std::string base = "/sequences/" + std::to_string(slot + 1) + "/";
+    if(sequence.GetClipSource() == base + "sequence.data") {
+        // The clips still on SD are about to go away, bring them all in first
+        sequence.PageInAllClips();
+        sequence.SetClipSource("");
+    }
     if(slot == saveSlot) {
         saveSlot = 0xFFFF;
         sequence.SetDirty();
+        sequence.StopJournal();
     }
+    MatrixOS::FileSystem::Remove(base + "sequence.commit");
+    MatrixOS::FileSystem::Remove(base + "sequence.data.tmp");
+    MatrixOS::FileSystem::Remove(base + "sequence.meta.tmp");
+    MatrixOS::FileSystem::Remove(base + "sequence.journal");
     bool ok1 = MatrixOS::FileSystem::Remove(base + "sequence.data");
     bool ok2 = MatrixOS::FileSystem::Remove(base + "sequence.meta");
     return ok1 || ok2;
@@ -2027,6 +2286,8 @@ bool Sequencer::CopySlot(uint16_t from, uint16_t to)
     if (from == to) return false;
     if (!MatrixOS::FileSystem::Available()) return false;
     if (!Saved(from)) return false;
+    WaitForSave();
+    AppendJournal();
 
     std::string fromBase = "/sequences/" + std::to_string(from + 1) + "/";
     std::string toBase   = "/sequences/" + std::to_string(to + 1) + "/";
@@ -2040,6 +2301,12 @@ bool Sequencer::CopySlot(uint16_t from, uint16_t to)
     MatrixOS::FileSystem::MakeDir("/sequences");
     MatrixOS::FileSystem::MakeDir(toBase);
 
+    if (sequence.GetClipSource() == toData)
+    {
+        sequence.PageInAllClips();
+        sequence.SetClipSource("");
+    }
+
     // backup existing dest
     if (!BackupSlot(to))
     {
@@ -2051,6 +2318,7 @@ bool Sequencer::CopySlot(uint16_t from, uint16_t to)
     {
         saveSlot = 0xFFFF;
         sequence.SetDirty();
+        sequence.StopJournal();
     }
 
     auto copyFile = [](const std::string& src, const std::string& dst) -> bool
@@ -2072,12 +2340,98 @@ bool Sequencer::CopySlot(uint16_t from, uint16_t to)
 
     bool ok1 = copyFile(fromData, toData);
     bool ok2 = copyFile(fromMeta, toMeta);
+    std::string fromJournal = fromBase + "sequence.journal";
+    if (ok1 && MatrixOS::FileSystem::Exists(fromJournal))
+    {
+        ok1 = copyFile(fromJournal, toBase + "sequence.journal");
+    }
 
     // TOOD: If failed, restore from the back up
     
     return ok1 && ok2;
 }
 
+// Moves the .tmp files of a finished save into place and the files they replace into prev/, then drops the commit marker.
+// Every step checks what is left to do, so running it again after a power loss picks up where it stopped.
+bool Sequencer::CommitSlot(uint16_t slot)
+{
+    std::string slotDir = "/sequences/" + std::to_string(slot + 1);
+    std::string dataPath = slotDir + "/sequence.data";
+    std::string metaPath = slotDir + "/sequence.meta";
+    std::string journalPath = slotDir + "/sequence.journal";
+    std::string prevDir = slotDir + "/prev";
+
+    if (!MatrixOS::FileSystem::Exists(prevDir) && !MatrixOS::FileSystem::MakeDir(prevDir))
+    {
+        MLOGE("Sequencer", "CommitSlot - failed to create %s", prevDir.c_str());
+        return false;
+    }
+
+    // While the new data is still pending, the live journal belongs to the old data and goes with it
+    if (MatrixOS::FileSystem::Exists(dataPath + ".tmp"))
+    {
+        if (MatrixOS::FileSystem::Exists(dataPath))
+        {
+            MatrixOS::FileSystem::Remove(prevDir + "/sequence.data");
+            if (!MatrixOS::FileSystem::Rename(dataPath, prevDir + "/sequence.data")) { MLOGE("Sequencer", "CommitSlot - failed to backup data"); return false; }
+        }
+        if (MatrixOS::FileSystem::Exists(journalPath))
+        {
+            MatrixOS::FileSystem::Remove(prevDir + "/sequence.journal");
+            if (!MatrixOS::FileSystem::Rename(journalPath, prevDir + "/sequence.journal")) { MLOGE("Sequencer", "CommitSlot - failed to backup journal"); return false; }
+        }
+        if (!MatrixOS::FileSystem::Rename(dataPath + ".tmp", dataPath)) { MLOGE("Sequencer", "CommitSlot - rename data to %s failed", dataPath.c_str()); return false; }
+    }
+
+    if (MatrixOS::FileSystem::Exists(metaPath + ".tmp"))
+    {
+        if (MatrixOS::FileSystem::Exists(metaPath))
+        {
+            MatrixOS::FileSystem::Remove(prevDir + "/sequence.meta");
+            if (!MatrixOS::FileSystem::Rename(metaPath, prevDir + "/sequence.meta")) { MLOGE("Sequencer", "CommitSlot - failed to backup meta"); return false; }
+        }
+        if (!MatrixOS::FileSystem::Rename(metaPath + ".tmp", metaPath)) { MLOGE("Sequencer", "CommitSlot - rename meta to %s failed", metaPath.c_str()); return false; }
+    }
+
+    return MatrixOS::FileSystem::Remove(slotDir + "/sequence.commit");
+}
+
+// Brings a slot back to a loadable state after a save or copy was cut off
+bool Sequencer::RecoverSlot(uint16_t slot)
+{
+    std::string slotDir = "/sequences/" + std::to_string(slot + 1);
+    std::string dataPath = slotDir + "/sequence.data";
+    std::string metaPath = slotDir + "/sequence.meta";
+    std::string prevDir = slotDir + "/prev";
+
+    // Marked complete, finish moving it into place
+    if (MatrixOS::FileSystem::Exists(slotDir + "/sequence.commit"))
+    {
+        MLOGW("Sequencer", "RecoverSlot - finishing the cut off save of slot %u", slot);
+        return CommitSlot(slot);
+    }
+
+    // Never marked complete, whatever was written can't be trusted
+    MatrixOS::FileSystem::Remove(dataPath + ".tmp");
+    MatrixOS::FileSystem::Remove(metaPath + ".tmp");
+
+    // Both present is a normal slot, neither an empty or cleared one. Half a pair is no use, bring the previous one back
+    bool hasData = MatrixOS::FileSystem::Exists(dataPath);
+    bool hasMeta = MatrixOS::FileSystem::Exists(metaPath);
+    if (hasData == hasMeta) return hasData;
+    if (!MatrixOS::FileSystem::Exists(prevDir + "/sequence.data") || !MatrixOS::FileSystem::Exists(prevDir + "/sequence.meta")) return false;
+
+    MLOGW("Sequencer", "RecoverSlot - restoring slot %u from prev", slot);
+    MatrixOS::FileSystem::Remove(dataPath);
+    MatrixOS::FileSystem::Remove(metaPath);
+    MatrixOS::FileSystem::Remove(slotDir + "/sequence.journal");
+    if (MatrixOS::FileSystem::Exists(prevDir + "/sequence.journal"))
+    {
+        MatrixOS::FileSystem::Rename(prevDir + "/sequence.journal", slotDir + "/sequence.journal");
+    }
+    return MatrixOS::FileSystem::Rename(prevDir + "/sequence.data", dataPath) && MatrixOS::FileSystem::Rename(prevDir + "/sequence.meta", metaPath);
+}
+
 bool Sequencer::BackupSlot(uint16_t slot)
 {
     std::string slotDir = "/sequences/" + std::to_string(slot + 1);
@@ -2086,6 +2440,8 @@ bool Sequencer::BackupSlot(uint16_t slot)
     std::string prevDir = slotDir + "/prev";
     std::string prevData = prevDir + "/sequence.data";
     std::string prevMeta = prevDir + "/sequence.meta";
+    std::string journalPath = slotDir + "/sequence.journal";
+    std::string prevJournal = prevDir + "/sequence.journal";
 
     if (!MatrixOS::FileSystem::Exists(prevDir))
     {
@@ -2106,6 +2462,14 @@ bool Sequencer::BackupSlot(uint16_t slot)
             return false;
         }
         MLOGD("Sequencer", "BackupSlot - backed up data to %s", prevData.c_str());
+
+        // The journal only means something next to the data it was written against
+        MatrixOS::FileSystem::Remove(prevJournal);
+        if (MatrixOS::FileSystem::Exists(journalPath) && !MatrixOS::FileSystem::Rename(journalPath, prevJournal))
+        {
+            MLOGE("Sequencer", "BackupSlot - failed to backup journal to %s", prevJournal.c_str());
+            return false;
+        }
     }
 
     if (MatrixOS::FileSystem::Exists(metaPath))
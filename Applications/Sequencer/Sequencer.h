@@ -3,10 +3,16 @@
 #include "MatrixOS.h"
 #include "Application.h"
 #include <set>
+#include <atomic>
 
 #include "Sequence.h"
 #include "SequenceMeta.h"
 
+#define SEQUENCER_IDLE_INTERVAL 5 // ms, longest the tick task sleeps without a pulse
+#define SEQUENCER_SAVE_STACK_SIZE 8192 // Background save task, holds a FatFS file object
+#define SEQUENCER_JOURNAL_INTERVAL 500 // ms between journal appends while there are unsaved edits
+#define SEQUENCER_JOURNAL_COMPACT_SIZE (16 * 1024) // Journal size that gets folded into a full save
+
 enum class SequencerMessage
 {
     NONE,
@@ -25,6 +31,8 @@ enum class SequencerMessage
     RESUME,
     UNDO,
     UNDONE,
+    REDO,
+    REDONE,
     OCTAVE_PLUS,
     OCTAVE_PLUS_DONE,
     OCTAVE_MINUS,
@@ -84,6 +92,17 @@ class Sequencer : public Application {
   Sequence sequence;
   TaskHandle_t tickTaskHandle = nullptr;
 
+  enum class SaveState : uint8_t
+  {
+    Idle,
+    Saving,
+    Saved,
+    Failed
+  };
+  std::atomic<SaveState> saveState{SaveState::Idle};
+  uint32_t journalTime = 0;
+  size_t journalSize = 0;
+
   uint8_t track = 0;
 
   // UI state
@@ -149,6 +168,10 @@ class Sequencer : public Application {
   static constexpr uint8_t SD_SLOT_MAX = 48;
   bool Load(uint16_t slot);
   bool Save(uint16_t slot);
+  bool SaveInBackground(uint16_t slot); // Snapshots now and writes from a low priority task, poll saveState
+  void WaitForSave();
+  uint16_t PrepareSaveSlot(uint16_t slot); // Picks a free slot for 0xFFFF and creates its directory, 0xFFFF on failure
+  bool WriteSlot(uint16_t slot, const SequenceData& data, const SequenceMeta& meta, const string& clipSource); // clipSource holds the clips that are not resident
   bool Saved(uint16_t slot);
   CreateSavedVar("Sequencer", saveSlot, uint16_t, 0xFFFF);
 
@@ -157,6 +180,11 @@ class Sequencer : public Application {
   bool ClearSlot(uint16_t slot);
   bool CopySlot(uint16_t from, uint16_t to);
   bool BackupSlot(uint16_t slot);
+  bool CommitSlot(uint16_t slot);  // Moves a finished save's .tmp files into place, safe to run again
+  bool RecoverSlot(uint16_t slot); // Finishes a cut off save or falls back to prev/, true if the slot has both files
+  bool AppendJournal(); // Journals edits to the current slot now
+  void JournalLoop();   // Appends every SEQUENCER_JOURNAL_INTERVAL and compacts once the journal grows
   
   static void SequenceTask(void* ctx);
+  static void SaveTask(void* ctx);
 };
@@ -30,6 +30,13 @@ namespace Device
 
   uint64_t Micros();
 
+  namespace Timer // One shot microsecond alarm for the clock service
+  {
+    typedef bool (*AlarmCallback)(void); // Runs in ISR, returns true if it woke a higher priority task
+    bool Init(AlarmCallback callback);
+    void Alarm(uint64_t time); // Fire at Micros() == time, right away if that already passed
+  }
+
   void DeviceSettings();
 
   void Log(string &format, va_list &valst);
@@ -7,28 +7,78 @@ using std::queue;
 #define TAG "BLE-MIDI"
 
 #define BLE_MIDI_PORT_ID 2
+#define BLE_MIDI_RX_QUEUE_SIZE 64
+#define BLE_MIDI_SEND_TIMEOUT 100 // ms a notification may wait out congestion before it is dropped
+#define BLE_MIDI_TASK_POLL 100 // ms the port tasks block before checking if they should stop
 
 namespace Device
 {
   namespace BLEMIDI
   {
     bool started = false;
+    volatile bool stopping = false; // Port tasks exit on their own when set, Stop waits for them
     string name;
     MidiPort midiPortInstance;
     MidiPort* midiPort = nullptr;
     TaskHandle_t portTaskHandle = NULL;
+    TaskHandle_t rxTaskHandle = NULL;
+    SemaphoreHandle_t bleMidiMutex = NULL;
+    QueueHandle_t rxQueue = NULL;
 
-    void Callback(uint8_t blemidi_port, uint16_t timestamp, uint8_t midi_status, uint8_t* remaining_message, size_t len,
-                  size_t continued_sysex_pos) {
-      // MLOGD(TAG, "CALLBACK blemidi_port=%d, timestamp=%d, midi_status=0x%02x, len=%d,
-      // continued_sysex_pos=%d, remaining_message:", blemidi_port, timestamp, midi_status, len, continued_sysex_pos);
-      // MLOGD(TAG, "Received 0x%02x 0x%02x 0x%02x", midi_status, remaining_message[0],
-      // remaining_message[1]);
-      if (len == 2 && midiPort != nullptr)
+    BLEMidiDecoder decoder;
+    BLEMidiEncoder encoder;
+    BLEMidiJitterBuffer jitterBuffer;
+
+    // Runs on the Bluetooth stack task, only decodes and queues
+    void Callback(uint8_t blemidi_port, uint8_t* packet, size_t len) {
+      static BLEMidiEvent events[BLEMIDI_PACKET_MAX + 1];
+      if (rxQueue == NULL)
+      { return; }
+
+      uint32_t truncated = decoder.truncated;
+      uint16_t count = decoder.Decode(span<const uint8_t>(packet, len), events);
+      if (decoder.truncated != truncated)
+      { ESP_LOGW(TAG, "%zu byte packet only partly decoded, %" PRIu32 " bytes dropped so far", len, decoder.truncated); }
+      for (uint16_t i = 0; i < count; i++)
       {
-        midiPort->Send(MidiPacket((EMidiStatus)(midi_status & 0xF0), midi_status, remaining_message[0],
-                                  remaining_message[1]));
+        if (xQueueSend(rxQueue, &events[i], 0) != pdTRUE)
+        {
+          ESP_LOGW(TAG, "RX queue full, dropped");
+          break;
+        }
+      }
+    }
+
+    // Releases received events on the sender's timeline
+    void rxTask(void* param) {
+      BLEMidiEvent event;
+      MidiPacket packet;
+      jitterBuffer.Reset();
+      while (!stopping)
+      {
+        int32_t wait = jitterBuffer.TimeToNext((uint32_t)MatrixOS::SYS::Millis());
+        if (wait < 0 || wait > BLE_MIDI_TASK_POLL)
+        { wait = BLE_MIDI_TASK_POLL; }
+        if (xQueueReceive(rxQueue, &event, pdMS_TO_TICKS(wait)) == pdTRUE)
+        {
+          // Buffer full, release the oldest early to make room so nothing overtakes it
+          if (!jitterBuffer.Push(event, (uint32_t)MatrixOS::SYS::Millis()))
+          {
+            if (jitterBuffer.PopOldest(&packet) && midiPort != nullptr)
+            { midiPort->Send(packet); }
+            jitterBuffer.Push(event, (uint32_t)MatrixOS::SYS::Millis());
+          }
+        }
+
+        uint32_t now = (uint32_t)MatrixOS::SYS::Millis();
+        while (jitterBuffer.Pop(now, &packet))
+        {
+          if (midiPort != nullptr)
+          { midiPort->Send(packet); }
+        }
       }
+      rxTaskHandle = NULL;
+      vTaskDelete(NULL);
     }
 
     void Toggle() {
@@ -42,13 +92,64 @@ namespace Device
       BLEMIDI::name = name;
     }
 
+    // Caller holds bleMidiMutex. Retries while the link is congested until deadline (SYS::Millis()), false if it was dropped
+    bool Flush(uint64_t deadline) {
+      if (encoder.Empty())
+      { return true; }
+      span<const uint8_t> packet = encoder.Packet();
+      esp_err_t status = blemidi_send_packet(midiPort->id % 0x100, (uint8_t*)packet.data(), packet.size());
+      while (status == ESP_FAIL && MatrixOS::SYS::Millis() < deadline)
+      {
+        vTaskDelay(1); // Congestion clears as connection events drain the stack's queue
+        status = blemidi_send_packet(midiPort->id % 0x100, (uint8_t*)packet.data(), packet.size());
+      }
+      if (status != ESP_OK)
+      { ESP_LOGW(TAG, "Notification of %zu bytes dropped: %s", packet.size(), esp_err_to_name(status)); }
+      encoder.Clear();
+      return status == ESP_OK;
+    }
+
     void portTask(void* param) {
       MidiPacket packet;
-      while (true)
+      while (!stopping)
       {
-        if (midiPort != nullptr && midiPort->Get(&packet, portMAX_DELAY))
-        { blemidi_send_message(midiPort->id % 0x100, packet.data, 3); }
+        if (midiPort != nullptr && midiPort->Get(&packet, BLE_MIDI_TASK_POLL))
+        {
+          // Pack everything already queued into as few notifications as the MTU allows
+          xSemaphoreTake(bleMidiMutex, portMAX_DELAY);
+          encoder.SetMTU(blemidi_get_mtu());
+          do
+          {
+            uint16_t timestamp = MatrixOS::SYS::Millis() & BLEMIDI_TIMESTAMP_MASK;
+            if (!encoder.Push(packet, timestamp))
+            {
+              Flush(MatrixOS::SYS::Millis() + BLE_MIDI_SEND_TIMEOUT);
+              encoder.Push(packet, timestamp);
+            }
+          } while (midiPort->Get(&packet, 0));
+          Flush(MatrixOS::SYS::Millis() + BLE_MIDI_SEND_TIMEOUT);
+          xSemaphoreGive(bleMidiMutex);
+        }
       }
+      portTaskHandle = NULL;
+      vTaskDelete(NULL);
+    }
+
+    bool WriteSysEx(MidiPort* port, span<const uint8_t> data, uint32_t timeout_ms) {
+      uint64_t deadline = MatrixOS::SYS::Millis() + timeout_ms;
+      if (xSemaphoreTake(bleMidiMutex, pdMS_TO_TICKS(timeout_ms)) != pdTRUE)
+      { return false; }
+      // Fill each notification up to the MTU, continuation packets carry on without a timestamp
+      encoder.SetMTU(blemidi_get_mtu());
+      bool sent = true;
+      size_t offset = 0;
+      while (sent && offset < data.size())
+      {
+        offset += encoder.PushSysEx(data.subspan(offset), MatrixOS::SYS::Millis() & BLEMIDI_TIMESTAMP_MASK);
+        sent = Flush(deadline);
+      }
+      xSemaphoreGive(bleMidiMutex);
+      return sent;
     }
 
     void Start() {
@@ -58,14 +159,24 @@ namespace Device
       else
       {
         ESP_LOGI(TAG, "BLE MIDI Driver initialized successfully");
+        if (bleMidiMutex == NULL)
+        { bleMidiMutex = xSemaphoreCreateMutex(); }
+        if (rxQueue == NULL)
+        { rxQueue = xQueueCreate(BLE_MIDI_RX_QUEUE_SIZE, sizeof(BLEMidiEvent)); }
+        decoder.Reset();
+        encoder.Clear();
         if (midiPort == nullptr)
         {
           midiPort = &midiPortInstance;
+          midiPort->sysExWriter = WriteSysEx;
           midiPort->SetName("Bluetooth");
           midiPort->Open(MIDI_PORT_BLUETOOTH);
         }
+        stopping = false;
         xTaskCreate(portTask, "Bluetooth Midi Port", configMINIMAL_STACK_SIZE * 2, NULL, configMAX_PRIORITIES - 2,
                     &portTaskHandle);
+        xTaskCreate(rxTask, "Bluetooth Midi RX", configMINIMAL_STACK_SIZE * 2, NULL, configMAX_PRIORITIES - 2,
+                    &rxTaskHandle);
         started = true;
       }
     }
@@ -77,11 +188,10 @@ namespace Device
       else
       {
         ESP_LOGI(TAG, "BLE MIDI Driver deinitialized successfully");
-        if (portTaskHandle != NULL)
-        {
-          vTaskDelete(portTaskHandle);
-          portTaskHandle = NULL;
-        }
+        // Let the tasks finish what they hold (bleMidiMutex, a port send) and exit themselves
+        stopping = true;
+        while (portTaskHandle != NULL || rxTaskHandle != NULL)
+        { vTaskDelay(pdMS_TO_TICKS(10)); }
         if (midiPort != nullptr)
         {
           midiPort->Close();
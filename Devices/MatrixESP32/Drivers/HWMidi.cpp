@@ -1,6 +1,13 @@
 #include "Device.h"
 #include "driver/uart.h"
 
+#define HWMIDI_BATCH_SIZE 8 // Keep a batch short (~8ms on the wire) so the next clock isn't held back for long
+#define HWMIDI_RUNNING_STATUS_TIMEOUT 1000 // Drop running status after idle so a receiver plugged in mid-stream can resync
+#define HWMIDI_RX_CHUNK_SIZE 32
+#define HWMIDI_RX_EVENT_QUEUE_SIZE 16
+
+#define TAG "HWMidi"
+
 namespace Device
 {
     namespace HWMidi
@@ -8,15 +15,93 @@ namespace Device
         MidiPort* midiPort;
         TaskHandle_t portTaskHandle = NULL;
         uart_port_t uartChannel = UART_NUM_2;
+        TaskHandle_t rxTaskHandle = NULL;
+        QueueHandle_t uartEventQueue = NULL;
+        SemaphoreHandle_t txMutex = NULL;
+        MidiSerializer serializer;
+
+        bool WriteSysEx(MidiPort* port, span<const uint8_t> data, uint32_t timeout_ms) {
+            if (xSemaphoreTake(txMutex, pdMS_TO_TICKS(timeout_ms)) != pdTRUE)
+            { return false; }
+            serializer.Reset(); // SysEx cancels running status
+            int written = uart_write_bytes(uartChannel, data.data(), data.size()); // Blocks at wire speed, that's our flow control
+            xSemaphoreGive(txMutex);
+            return written == (int)data.size();
+        }
 
         void portTask(void* param) {
             MidiPort port = MidiPort("Midi Port", MIDI_PORT_PHYSICAL);
+            port.sysExWriter = WriteSysEx;
             midiPort = &port;
-            MidiPacket packet;
+            MidiPacket packets[HWMIDI_BATCH_SIZE];
+            uint8_t stream[HWMIDI_BATCH_SIZE * 3];
+            while (true)
+            {
+                if (!port.Get(&packets[0], HWMIDI_RUNNING_STATUS_TIMEOUT))
+                {
+                    xSemaphoreTake(txMutex, portMAX_DELAY);
+                    serializer.Reset();
+                    xSemaphoreGive(txMutex);
+                    continue;
+                }
+
+                uint8_t count = 1;
+                while (count < HWMIDI_BATCH_SIZE && port.Get(&packets[count], 0))
+                { count++; }
+
+                xSemaphoreTake(txMutex, portMAX_DELAY);
+                uint16_t length = serializer.Serialize(span<const MidiPacket>(packets, count), stream);
+                uart_write_bytes(uartChannel, stream, length);
+                xSemaphoreGive(txMutex);
+            }
+        }
+
+        void rxTask(void* param) {
+            MidiParser parser;
+            uart_event_t event;
+            uint8_t bytes[HWMIDI_RX_CHUNK_SIZE];
+            MidiPacket packets[HWMIDI_RX_CHUNK_SIZE + 1]; // A byte yields at most one packet, plus one when a status byte cuts a SysEx short
             while (true)
             {
-                if (port.Get(&packet, portMAX_DELAY))
-                { uart_write_bytes(uartChannel, packet.data, 3); }
+                if (xQueueReceive(uartEventQueue, &event, portMAX_DELAY) != pdTRUE)
+                { continue; }
+
+                switch (event.type)
+                {
+                    case UART_DATA:
+                    {
+                        size_t buffered = 0;
+                        uart_get_buffered_data_len(uartChannel, &buffered);
+                        while (buffered > 0)
+                        {
+                            int length = uart_read_bytes(uartChannel, bytes, std::min(buffered, (size_t)HWMIDI_RX_CHUNK_SIZE), 0);
+                            if (length <= 0)
+                            { break; }
+                            buffered -= length;
+
+                            uint16_t count = 0;
+                            for (int i = 0; i < length; i++)
+                            { count += parser.Parse(bytes[i], &packets[count]); }
+
+                            if (count > 0 && midiPort != nullptr)
+                            { midiPort->Send(span<MidiPacket>(packets, count)); }
+                        }
+                        break;
+                    }
+                    case UART_FIFO_OVF:
+                    case UART_BUFFER_FULL:
+                        ESP_LOGW(TAG, "RX overflow, flushing input");
+                        uart_flush_input(uartChannel);
+                        xQueueReset(uartEventQueue);
+                        parser.Reset();
+                        break;
+                    case UART_FRAME_ERR:
+                    case UART_PARITY_ERR:
+                        parser.Reset();
+                        break;
+                    default:
+                        break;
+                }
             }
         }
 
@@ -38,10 +123,24 @@ namespace Device
                 rx_buffer_size = 129; // Must be larger than 128, even though we don't use it
             }
 
-            ESP_ERROR_CHECK(uart_driver_install(uartChannel, rx_buffer_size, 0, 0, NULL, 0));
+            if(rx_gpio == GPIO_NUM_NC)
+            {
+                ESP_ERROR_CHECK(uart_driver_install(uartChannel, rx_buffer_size, 0, 0, NULL, 0));
+            }
+            else
+            {
+                ESP_ERROR_CHECK(uart_driver_install(uartChannel, rx_buffer_size, 0, HWMIDI_RX_EVENT_QUEUE_SIZE, &uartEventQueue, 0));
+            }
             ESP_ERROR_CHECK(uart_param_config(uartChannel, &uart_config));
             ESP_ERROR_CHECK(uart_set_pin(uartChannel, tx_gpio, rx_gpio, GPIO_NUM_NC, GPIO_NUM_NC));
+            txMutex = xSemaphoreCreateMutex();
             xTaskCreate(portTask, "Hardware Midi Port", configMINIMAL_STACK_SIZE * 2, NULL, configMAX_PRIORITIES - 2,&portTaskHandle);
+
+            if(rx_gpio != GPIO_NUM_NC)
+            {
+                uart_set_rx_timeout(uartChannel, 1); // Wake on every byte gap instead of waiting ~10 byte times
+                xTaskCreate(rxTask, "Hardware Midi RX", configMINIMAL_STACK_SIZE * 3, NULL, configMAX_PRIORITIES - 2, &rxTaskHandle);
+            }
         }
     }
 }
\ No newline at end of file
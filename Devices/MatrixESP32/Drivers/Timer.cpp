@@ -0,0 +1,60 @@
+#include "Device.h"
+#include "driver/gptimer.h"
+
+#define TIMER_MIN_DELAY 2 // us, anything closer is fired right away
+
+#define TAG "Timer"
+
+namespace Device::Timer
+{
+  gptimer_handle_t gptimer = NULL;
+  AlarmCallback alarmCallback = NULL;
+
+  static bool IRAM_ATTR OnAlarm(gptimer_handle_t timer, const gptimer_alarm_event_data_t* event, void* context) {
+    return alarmCallback();
+  }
+
+  bool Init(AlarmCallback callback) {
+    if (gptimer != NULL)
+    { return false; }
+
+    // Free running 1MHz counter, alarms are set relative to it
+    gptimer_config_t config = {
+        .clk_src = GPTIMER_CLK_SRC_DEFAULT,
+        .direction = GPTIMER_COUNT_UP,
+        .resolution_hz = 1000000,
+    };
+    if (gptimer_new_timer(&config, &gptimer) != ESP_OK)
+    {
+      ESP_LOGE(TAG, "No hardware timer available");
+      gptimer = NULL;
+      return false;
+    }
+
+    alarmCallback = callback;
+    gptimer_event_callbacks_t callbacks = {
+        .on_alarm = OnAlarm,
+    };
+    ESP_ERROR_CHECK(gptimer_register_event_callbacks(gptimer, &callbacks, NULL));
+    ESP_ERROR_CHECK(gptimer_enable(gptimer));
+    ESP_ERROR_CHECK(gptimer_start(gptimer));
+    return true;
+  }
+
+  void Alarm(uint64_t time) {
+    if (gptimer == NULL)
+    { return; }
+
+    uint64_t now = Device::Micros();
+    uint64_t delay = time > now + TIMER_MIN_DELAY ? time - now : TIMER_MIN_DELAY;
+    uint64_t count;
+    gptimer_get_raw_count(gptimer, &count);
+
+    gptimer_alarm_config_t alarm = {
+        .alarm_count = count + delay,
+        .reload_count = 0,
+        .flags = {.auto_reload_on_alarm = false},
+    };
+    gptimer_set_alarm_action(gptimer, &alarm);
+  }
+}
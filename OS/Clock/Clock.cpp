@@ -0,0 +1,499 @@
+#include "MatrixOS.h"
+#include "Clock.h"
+#include "../MIDI/MIDI.h"
+
+namespace MatrixOS::Clock
+{
+  ClockSource source = CLOCK_SOURCE_INTERNAL;
+  float bpm = 120;
+  ClockFollower follower(60000000.0f / (CLOCK_BPM_MAX * 24), 60000000.0f / (CLOCK_BPM_MIN * 24));
+
+  // Position runs linearly from the anchor at quarterLength (us * 256 per quarter note)
+  uint64_t anchorTime = 0;
+  uint64_t anchorPosition = 0;
+  uint32_t quarterLength = 0;
+
+  // External clock state
+  uint64_t limitPosition = 0; // Don't run past the next expected pulse
+  uint32_t pulse = 0; // Position of the next incoming pulse, in pulses
+  uint64_t lastPulseTime = 0;
+  bool running = true;
+  bool holding = false; // Position frozen until the next pulse (Start, Stop, Song Position)
+
+  uint32_t generation = 0; // Bumped on every rewind so a dispatch in progress stops
+  int8_t outputHandle = -1;
+
+  static uint32_t QuarterLength(float bpm) {
+    return (uint32_t)(60000000.0f * 256 / bpm);
+  }
+
+  // Length in position units of a span of us
+  static uint64_t Distance(uint64_t duration) {
+    uint64_t scaled = duration << 8;
+    return ((scaled / quarterLength) << 32) + (((scaled % quarterLength) << 32) / quarterLength);
+  }
+
+  // Length in us of a span of position units, rounded up so a tick never fires early
+  static uint64_t Duration(uint64_t distance) {
+    uint64_t scaled = (distance >> 32) * quarterLength + (((distance & 0xFFFFFFFF) * quarterLength + 0xFFFFFFFF) >> 32);
+    return (scaled + 255) >> 8;
+  }
+
+  static uint64_t PositionAt(uint64_t time) {
+    if (holding)
+    { return anchorPosition; }
+
+    uint64_t position;
+    if (time >= anchorTime)
+    { position = anchorPosition + Distance(time - anchorTime); }
+    else
+    {
+      uint64_t distance = Distance(anchorTime - time);
+      position = anchorPosition > distance ? anchorPosition - distance : 0;
+    }
+
+    if (source == CLOCK_SOURCE_EXTERNAL && position > limitPosition)
+    { position = limitPosition; }
+    return position;
+  }
+
+  static uint64_t TimeAt(uint64_t position) {
+    if (position >= anchorPosition)
+    { return anchorTime + Duration(position - anchorPosition); }
+
+    uint64_t duration = Duration(anchorPosition - position);
+    return anchorTime > duration ? anchorTime - duration : 0;
+  }
+
+  // Offset of a tick from the start of the swing pattern, in 1/65536 ticks
+  static uint64_t SwingUnits(const Subscriber& subscriber, uint32_t tick) {
+    if (subscriber.swingStep == 0 || subscriber.swing == 0)
+    { return (uint64_t)tick << 16; }
+
+    uint32_t pair = subscriber.swingStep * 2;
+    uint32_t within = tick % pair;
+    uint64_t units = (uint64_t)(tick - within) << 16;
+    if (within <= subscriber.swingStep)
+    { return units + (uint64_t)within * (65536 + subscriber.swing); }
+    return units + (uint64_t)subscriber.swingStep * (65536 + subscriber.swing) + (uint64_t)(within - subscriber.swingStep) * (65536 - subscriber.swing);
+  }
+
+  // Inverse of SwingUnits, the last tick at or before units
+  static uint32_t SwingTick(const Subscriber& subscriber, uint64_t units) {
+    if (subscriber.swingStep == 0 || subscriber.swing == 0)
+    { return (uint32_t)(units >> 16); }
+
+    uint64_t pairUnits = (uint64_t)subscriber.swingStep << 17;
+    uint64_t rest = units % pairUnits;
+    uint64_t onBeat = (uint64_t)subscriber.swingStep * (65536 + subscriber.swing);
+    uint32_t within = rest < onBeat ? rest / (65536 + subscriber.swing) : subscriber.swingStep + (rest - onBeat) / (65536 - subscriber.swing);
+    return (uint32_t)(units / pairUnits) * subscriber.swingStep * 2 + within;
+  }
+
+  static uint64_t TickPosition(const Subscriber& subscriber, uint32_t tick) {
+    uint64_t units = SwingUnits(subscriber, tick + subscriber.phase) - SwingUnits(subscriber, subscriber.phase);
+    uint64_t quarter = (uint64_t)subscriber.ppqn << 16;
+    return subscriber.origin + ((units / quarter) << 32) + (((units % quarter) << 16) + subscriber.ppqn - 1) / subscriber.ppqn;
+  }
+
+  // Last tick at or before position, position must not be before the origin
+  static uint32_t LastTick(const Subscriber& subscriber, uint64_t position) {
+    uint64_t distance = position - subscriber.origin;
+    uint64_t units = (((distance >> 32) * subscriber.ppqn) << 16) + (((distance & 0xFFFFFFFF) * subscriber.ppqn) >> 16);
+    uint32_t tick = SwingTick(subscriber, units + SwingUnits(subscriber, subscriber.phase)) - subscriber.phase;
+
+    // Both directions round, settle on the exact tick
+    while (tick > 0 && TickPosition(subscriber, tick) > position)
+    { tick--; }
+    while (TickPosition(subscriber, tick + 1) <= position)
+    { tick++; }
+    return tick;
+  }
+
+  // First tick at or after position
+  static uint32_t FirstTick(const Subscriber& subscriber, uint64_t position) {
+    if (position <= subscriber.origin)
+    { return 0; }
+
+    uint32_t tick = LastTick(subscriber, position);
+    if (TickPosition(subscriber, tick) < position)
+    { tick++; }
+    return tick;
+  }
+
+  // Re-anchor at now so tempo changes take effect from here on, and the elapsed time never grows large
+  static void Advance(uint64_t now) {
+    anchorPosition = PositionAt(now);
+    anchorTime = now;
+  }
+
+  static void Rewind(uint64_t position) {
+    anchorPosition = position;
+    limitPosition = position;
+    generation++;
+    for (Subscriber& subscriber : subscribers)
+    {
+      if (subscriber.active)
+      {
+        subscriber.origin = std::min(subscriber.origin, position);
+        subscriber.next = FirstTick(subscriber, position);
+      }
+    }
+  }
+
+  static void Dispatch(Subscriber& subscriber, uint64_t now) {
+    uint64_t position = subscriber.lead ? PositionAt(now + subscriber.lead) : anchorPosition;
+    if (position < subscriber.origin)
+    { return; }
+
+    uint32_t last = LastTick(subscriber, position);
+    if ((int32_t)(last - subscriber.next) < 0)
+    { return; }
+
+    // Fell behind by more than a quarter note (clock jumped, task starved). Subscribers that opted in skip ahead
+    // instead of bursting it all out, everyone else gets every tick so their counts stay aligned.
+    if (subscriber.skipLate && last - subscriber.next >= subscriber.ppqn)
+    { subscriber.next = last; }
+
+    uint32_t currentGeneration = generation;
+    while (subscriber.active && generation == currentGeneration && (int32_t)(last - subscriber.next) >= 0)
+    {
+      uint32_t tick = subscriber.next++;
+      uint64_t tickTime = std::min(TimeAt(TickPosition(subscriber, tick)), now + subscriber.lead);
+      subscriber.lastTickTime = tickTime;
+      subscriber.pending++;
+      if (subscriber.callback != nullptr)
+      { subscriber.callback(tick, tickTime, subscriber.context); }
+    }
+  }
+
+  static void SendClock(uint32_t tick, uint64_t time, void* context) {
+    MatrixOS::MIDI::Send(MidiPacket::Clock(), MIDI_PORT_ALL);
+  }
+
+  static void Wake() {
+    if (clockTask) {
+      xTaskNotifyGive(clockTask);
+    }
+  }
+
+  static bool OnAlarm(void) {
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(clockTask, &woken);
+    return woken == pdTRUE;
+  }
+
+  void Init(void) {
+    if (!clockMutex) {
+      clockMutex = xSemaphoreCreateRecursiveMutex();
+      quarterLength = QuarterLength(bpm);
+      anchorTime = MatrixOS::SYS::Micros();
+    }
+
+    // Pick up clock messages the moment they arrive, before they queue up behind other traffic
+    if (MatrixOS::MIDI::osPort) {
+      MatrixOS::MIDI::osPort->clockListener = Receive;
+    }
+
+    if (!clockTask && xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED) {
+      xTaskCreate(ClockTask, "Clock", configMINIMAL_STACK_SIZE * 4, NULL, configMAX_PRIORITIES - 2, &clockTask);
+      timerAvailable = Device::Timer::Init(OnAlarm);
+      if (!timerAvailable) {
+        MLOGW("Clock", "No hardware timer, ticks fall back to the RTOS tick");
+      }
+    }
+  }
+
+  // Fire everything that is due by now, returns when the next tick is due (UINT64_MAX for none)
+  static uint64_t Process(uint64_t now) {
+    if (source == CLOCK_SOURCE_EXTERNAL && follower.Locked() && now - lastPulseTime > CLOCK_EXTERNAL_TIMEOUT * 1000) {
+      MLOGD("Clock", "External clock lost");
+      follower.Reset();
+    }
+
+    Advance(now);
+
+    uint64_t due = UINT64_MAX;
+    for (Subscriber& subscriber : subscribers) {
+      if (!subscriber.active) continue;
+      Dispatch(subscriber, now);
+      if (!subscriber.active || holding) continue;
+
+      uint64_t position = TickPosition(subscriber, subscriber.next);
+      if (source == CLOCK_SOURCE_EXTERNAL && position > limitPosition) continue; // Wait for the pulse
+      uint64_t time = TimeAt(position);
+      due = std::min(due, time > subscriber.lead ? time - subscriber.lead : 0);
+    }
+    return due;
+  }
+
+  void ClockTask(void* parameters) {
+    while (true) {
+      xSemaphoreTakeRecursive(clockMutex, portMAX_DELAY);
+      uint64_t now = MatrixOS::SYS::Micros();
+      uint64_t due = Process(now);
+      bool following = Locked();
+      xSemaphoreGiveRecursive(clockMutex);
+
+      // Sleep till the next tick, any change of tempo, source or subscribers wakes us up early
+      TickType_t timeout = following ? pdMS_TO_TICKS(CLOCK_EXTERNAL_TIMEOUT) : portMAX_DELAY;
+      if (due != UINT64_MAX) {
+        if (timerAvailable) {
+          Device::Timer::Alarm(due);
+        }
+        else {
+          timeout = std::min(timeout, std::max((TickType_t)1, (TickType_t)pdMS_TO_TICKS((due - now + 999) / 1000)));
+        }
+      }
+      ulTaskNotifyTake(pdTRUE, timeout);
+    }
+  }
+
+  void Receive(const MidiPacket& packet) {
+    uint64_t now = MatrixOS::SYS::Micros();
+    if (!clockMutex || source != CLOCK_SOURCE_EXTERNAL) return;
+
+    xSemaphoreTakeRecursive(clockMutex, portMAX_DELAY);
+    switch (packet.status) {
+      case EMidiStatus::Clock:
+        lastPulseTime = now;
+        follower.Update(now);
+        if (!running) break; // Keep tracking tempo, but the position stays put
+
+        if (follower.Locked()) {
+          // Run smoothly along the filtered grid up to where the next pulse is expected
+          anchorTime = follower.PulseTime();
+          quarterLength = (uint32_t)(follower.Period() * 24 * 256);
+          limitPosition = (uint64_t)(pulse + 1) * CLOCK_PULSE;
+        }
+        else {
+          anchorTime = now;
+          limitPosition = (uint64_t)pulse * CLOCK_PULSE;
+        }
+        anchorPosition = (uint64_t)pulse * CLOCK_PULSE;
+        holding = false;
+        pulse++;
+        break;
+      case EMidiStatus::Start:
+        // The first clock after Start is position 0
+        running = true;
+        holding = true;
+        pulse = 0;
+        anchorTime = now;
+        Rewind(0);
+        break;
+      case EMidiStatus::Continue:
+        running = true;
+        break;
+      case EMidiStatus::Stop:
+        Advance(now);
+        running = false;
+        holding = true;
+        break;
+      case EMidiStatus::SongPosition:
+        // Song position is in 16th notes, 6 clocks each
+        pulse = packet.Value() * 6;
+        holding = true;
+        anchorTime = now;
+        Rewind((uint64_t)pulse * CLOCK_PULSE);
+        break;
+      default:
+        break;
+    }
+    xSemaphoreGiveRecursive(clockMutex);
+    Wake();
+  }
+
+  void SetSource(ClockSource newSource) {
+    if (!clockMutex) return;
+
+    xSemaphoreTakeRecursive(clockMutex, portMAX_DELAY);
+    if (newSource != source) {
+      Advance(MatrixOS::SYS::Micros());
+      source = newSource;
+      follower.Reset();
+      running = true;
+      if (source == CLOCK_SOURCE_EXTERNAL) {
+        // Carry on from the next pulse boundary once clock comes in
+        pulse = (anchorPosition + CLOCK_PULSE - 1) / CLOCK_PULSE;
+        holding = true;
+      }
+      else {
+        quarterLength = QuarterLength(bpm);
+        holding = false;
+      }
+    }
+    xSemaphoreGiveRecursive(clockMutex);
+    Wake();
+  }
+
+  ClockSource GetSource() {
+    return source;
+  }
+
+  void SetBPM(float newBPM) {
+    if (!clockMutex) return;
+
+    newBPM = std::min(std::max(newBPM, (float)CLOCK_BPM_MIN), (float)CLOCK_BPM_MAX);
+    xSemaphoreTakeRecursive(clockMutex, portMAX_DELAY);
+    bpm = newBPM;
+    if (source == CLOCK_SOURCE_INTERNAL) {
+      Advance(MatrixOS::SYS::Micros());
+      quarterLength = QuarterLength(bpm);
+    }
+    xSemaphoreGiveRecursive(clockMutex);
+    Wake();
+  }
+
+  float GetBPM() {
+    if (source == CLOCK_SOURCE_EXTERNAL && follower.Locked())
+    { return 60000000.0f / (follower.Period() * 24); }
+    return bpm;
+  }
+
+  bool Locked() {
+    return source == CLOCK_SOURCE_EXTERNAL && follower.Locked();
+  }
+
+  bool Running() {
+    return source == CLOCK_SOURCE_INTERNAL || running;
+  }
+
+  void Reset() {
+    if (!clockMutex) return;
+
+    xSemaphoreTakeRecursive(clockMutex, portMAX_DELAY);
+    anchorTime = MatrixOS::SYS::Micros();
+    pulse = 0;
+    Rewind(0);
+    xSemaphoreGiveRecursive(clockMutex);
+    Wake();
+  }
+
+  uint64_t Position() {
+    if (!clockMutex) return 0;
+
+    xSemaphoreTakeRecursive(clockMutex, portMAX_DELAY);
+    uint64_t position = PositionAt(MatrixOS::SYS::Micros());
+    xSemaphoreGiveRecursive(clockMutex);
+    return position;
+  }
+
+  void EnableOutput(bool enable) {
+    if (enable == (outputHandle >= 0)) return;
+
+    if (enable) {
+      outputHandle = Subscribe(24, SendClock);
+    }
+    else {
+      Unsubscribe(outputHandle);
+      outputHandle = -1;
+    }
+  }
+
+  bool OutputEnabled() {
+    return outputHandle >= 0;
+  }
+
+  int8_t Subscribe(uint16_t ppqn, TickCallback callback, void* context) {
+    if (!clockMutex || ppqn == 0) return -1;
+
+    int8_t handle = -1;
+    xSemaphoreTakeRecursive(clockMutex, portMAX_DELAY);
+    for (uint8_t i = 0; i < CLOCK_SUBSCRIBER_COUNT; i++) {
+      if (subscribers[i].active) continue;
+
+      Advance(MatrixOS::SYS::Micros());
+      subscribers[i].ppqn = ppqn;
+      subscribers[i].origin = 0;
+      subscribers[i].phase = 0;
+      subscribers[i].swingStep = 0;
+      subscribers[i].swing = 0;
+      subscribers[i].lead = 0;
+      subscribers[i].skipLate = false;
+      subscribers[i].next = FirstTick(subscribers[i], anchorPosition);
+      subscribers[i].pending = 0;
+      subscribers[i].lastTickTime = 0;
+      subscribers[i].callback = callback;
+      subscribers[i].context = context;
+      subscribers[i].active = true;
+      handle = i;
+      break;
+    }
+    xSemaphoreGiveRecursive(clockMutex);
+
+    if (handle < 0) {
+      MLOGW("Clock", "No subscriber slot left");
+      return -1;
+    }
+    Wake();
+    return handle;
+  }
+
+  void Unsubscribe(int8_t handle) {
+    if (!clockMutex || handle < 0 || handle >= CLOCK_SUBSCRIBER_COUNT) return;
+
+    // Taking the lock also waits out a callback in flight, so the context can be freed right after
+    xSemaphoreTakeRecursive(clockMutex, portMAX_DELAY);
+    subscribers[handle].active = false;
+    subscribers[handle].callback = nullptr;
+    subscribers[handle].context = nullptr;
+    xSemaphoreGiveRecursive(clockMutex);
+  }
+
+  uint32_t Ticks(int8_t handle, uint64_t* lastTickTime) {
+    if (!clockMutex || handle < 0 || handle >= CLOCK_SUBSCRIBER_COUNT) return 0;
+
+    xSemaphoreTakeRecursive(clockMutex, portMAX_DELAY);
+    uint32_t ticks = subscribers[handle].pending;
+    subscribers[handle].pending = 0;
+    if (lastTickTime != nullptr) {
+      *lastTickTime = subscribers[handle].lastTickTime;
+    }
+    xSemaphoreGiveRecursive(clockMutex);
+    return ticks;
+  }
+
+  void SetSwing(int8_t handle, uint16_t stepTicks, float swing) {
+    if (!clockMutex || handle < 0 || handle >= CLOCK_SUBSCRIBER_COUNT) return;
+
+    // Tick numbering stays, ticks that moved into the past fire right away
+    swing = std::min(std::max(swing, -0.49f), 0.49f);
+    xSemaphoreTakeRecursive(clockMutex, portMAX_DELAY);
+    subscribers[handle].swingStep = stepTicks;
+    subscribers[handle].swing = (int32_t)(swing * 65536);
+    xSemaphoreGiveRecursive(clockMutex);
+    Wake();
+  }
+
+  void Restart(int8_t handle, uint64_t position, uint32_t phase) {
+    if (!clockMutex || handle < 0 || handle >= CLOCK_SUBSCRIBER_COUNT) return;
+
+    xSemaphoreTakeRecursive(clockMutex, portMAX_DELAY);
+    Advance(MatrixOS::SYS::Micros());
+    Subscriber& subscriber = subscribers[handle];
+    subscriber.origin = position;
+    subscriber.phase = phase;
+    subscriber.next = FirstTick(subscriber, anchorPosition);
+    subscriber.pending = 0;
+    xSemaphoreGiveRecursive(clockMutex);
+    Wake();
+  }
+
+  void SetLead(int8_t handle, uint32_t lead_us) {
+    if (!clockMutex || handle < 0 || handle >= CLOCK_SUBSCRIBER_COUNT) return;
+
+    xSemaphoreTakeRecursive(clockMutex, portMAX_DELAY);
+    subscribers[handle].lead = lead_us;
+    xSemaphoreGiveRecursive(clockMutex);
+    Wake();
+  }
+
+  void SetSkipLate(int8_t handle, bool skip) {
+    if (!clockMutex || handle < 0 || handle >= CLOCK_SUBSCRIBER_COUNT) return;
+
+    xSemaphoreTakeRecursive(clockMutex, portMAX_DELAY);
+    subscribers[handle].skipLate = skip;
+    xSemaphoreGiveRecursive(clockMutex);
+  }
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "MatrixOS.h"
+
+#define CLOCK_QUARTER (1ULL << 32) // One quarter note in position units
+#define CLOCK_PULSE (CLOCK_QUARTER / 24) // One incoming MIDI clock
+
+namespace MatrixOS::Clock
+{
+  struct Subscriber {
+    bool active = false;
+    uint16_t ppqn = 0;
+    uint32_t next = 0; // Next tick to fire
+    uint64_t origin = 0; // Position of tick 0
+    uint32_t phase = 0; // Ticks into the swing pattern at tick 0
+    uint16_t swingStep = 0; // Ticks per swung step, 0 for a straight grid
+    int32_t swing = 0; // How much longer the on-beat step runs, in 1/65536 of a tick per tick
+    uint32_t lead = 0; // Fire this many us ahead of the tick
+    bool skipLate = false; // Drop ticks more than a quarter note late instead of firing them all
+    uint32_t pending = 0; // Fired but not yet collected by Ticks()
+    uint64_t lastTickTime = 0;
+    TickCallback callback = nullptr;
+    void* context = nullptr;
+  };
+
+  inline SemaphoreHandle_t clockMutex = nullptr; // Recursive, callbacks run while it is held and may call back in
+  inline TaskHandle_t clockTask = nullptr;
+  inline bool timerAvailable = false;
+  inline Subscriber subscribers[CLOCK_SUBSCRIBER_COUNT];
+
+  void Init(void);
+  void ClockTask(void* parameters);
+  void Receive(const MidiPacket& packet); // Listener on the OS MIDI port, runs on the sending task
+}
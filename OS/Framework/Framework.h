@@ -17,12 +17,18 @@
 
 //Helper Classes 
 #include "Timer.h" 
+#include "ClockFollower.h"
 #include "Utilts.h"
 #include "Hash.h"
 #include "ColorEffects.h"
 
 //OS Component
+#include "MidiRing.h"
 #include "MidiPort.h"
+#include "MidiSerializer.h"
+#include "MidiParser.h"
+#include "BLEMidiCodec.h"
+#include "UMP.h"
 #include "SavedVar.h"
 
 // Device Component
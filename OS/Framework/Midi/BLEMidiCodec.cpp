@@ -0,0 +1,228 @@
+#include <algorithm>
+#include <cstring>
+#include "BLEMidiCodec.h"
+
+// Decoder
+
+uint16_t BLEMidiDecoder::Decode(span<const uint8_t> packet, span<BLEMidiEvent> dest) {
+  if (packet.size() < 2 || !(packet[0] & 0x80) || (packet[0] & 0x40))
+  { return 0; } // Not a BLE-MIDI packet
+
+  uint16_t high = (packet[0] & 0x3F) << 7;
+  uint16_t timestamp = high;
+  uint8_t lastLow = 0;
+  bool afterTimestamp = false;
+  uint16_t count = 0;
+  MidiPacket parsed[2];
+
+  for (size_t i = 1; i < packet.size(); i++)
+  {
+    uint8_t byte = packet[i];
+
+    // A byte with the top bit set is a timestamp, unless it directly follows one, then it's a status
+    if ((byte & 0x80) && !afterTimestamp)
+    {
+      uint8_t low = byte & 0x7F;
+      if (low < lastLow) // Low part wrapped within this packet
+      { high = (high + 0x80) & BLEMIDI_TIMESTAMP_MASK; }
+      lastLow = low;
+      timestamp = high | low;
+      afterTimestamp = true;
+      continue;
+    }
+    afterTimestamp = false;
+
+    if (count + 2 > dest.size())
+    {
+      truncated += packet.size() - i;
+      break;
+    }
+
+    uint8_t parsedCount = parser.Parse(byte, parsed);
+    for (uint8_t j = 0; j < parsedCount; j++)
+    { dest[count++] = {timestamp, parsed[j]}; }
+  }
+  return count;
+}
+
+void BLEMidiDecoder::Reset() {
+  parser.Reset();
+}
+
+// Encoder
+
+void BLEMidiEncoder::SetMTU(uint16_t mtu) {
+  this->mtu = std::max((uint16_t)8, std::min(mtu, (uint16_t)BLEMIDI_PACKET_MAX)); // 8 fits any single message or SysEx packet
+}
+
+bool BLEMidiEncoder::Push(const MidiPacket& packet, uint16_t timestamp) {
+  uint8_t packetLength = packet.Length();
+  if (packetLength == 0)
+  { return true; }
+
+  if (packet.SysEx())
+  {
+    // Keep a SysEx packet whole, worst case every byte is a status needing a timestamp
+    if (length + 1 + packetLength * 2 > mtu)
+    { return false; }
+    return PushSysEx(span<const uint8_t>(packet.data, packetLength), timestamp) == packetLength;
+  }
+
+  uint8_t status = packet.data[0];
+  timestamp &= BLEMIDI_TIMESTAMP_MASK;
+
+  // Realtime can go anywhere, including between SysEx bytes, and leaves running status alone
+  if (MIDIv1_IS_REALTIME(status))
+  {
+    if (length + 3 > mtu || !Begin(timestamp))
+    { return false; }
+    buffer[length++] = 0x80 | (timestamp & 0x7F);
+    buffer[length++] = status;
+    timestampLow = timestamp & 0x7F;
+    return true;
+  }
+
+  bool running = MIDIv1_IS_VOICE(status) && status == runningStatus && length > 0;
+  bool sameTime = running && SameTimestamp(timestamp);
+  uint8_t needed = (packetLength - 1) + (sameTime ? 0 : 1) + (running ? 0 : 1) + (length == 0 ? 1 : 0);
+  if (length + needed > mtu || !Begin(timestamp))
+  { return false; }
+
+  if (!sameTime)
+  { buffer[length++] = 0x80 | (timestamp & 0x7F); }
+  if (!running)
+  { buffer[length++] = status; }
+  memcpy(buffer + length, packet.data + 1, packetLength - 1);
+  length += packetLength - 1;
+
+  timestampLow = timestamp & 0x7F;
+  runningStatus = MIDIv1_IS_VOICE(status) ? status : 0;
+  return true;
+}
+
+size_t BLEMidiEncoder::PushSysEx(span<const uint8_t> data, uint16_t timestamp) {
+  timestamp &= BLEMIDI_TIMESTAMP_MASK;
+  size_t taken = 0;
+  for (uint8_t byte : data)
+  {
+    bool status = byte & 0x80;
+    if (length + (length == 0 ? 1 : 0) + (status ? 2 : 1) > mtu || !Begin(timestamp))
+    { break; }
+
+    if (status)
+    {
+      buffer[length++] = 0x80 | (timestamp & 0x7F);
+      timestampLow = timestamp & 0x7F;
+    }
+    buffer[length++] = byte;
+    taken++;
+  }
+  runningStatus = 0;
+  return taken;
+}
+
+span<const uint8_t> BLEMidiEncoder::Packet() const {
+  return span<const uint8_t>(buffer, length);
+}
+
+bool BLEMidiEncoder::Empty() const {
+  return length == 0;
+}
+
+void BLEMidiEncoder::Clear() {
+  length = 0;
+  runningStatus = 0; // Receivers may not carry running status across packets
+}
+
+bool BLEMidiEncoder::Begin(uint16_t timestamp) {
+  uint8_t high = (timestamp >> 7) & 0x3F;
+  uint8_t low = timestamp & 0x7F;
+  if (length == 0)
+  {
+    buffer[length++] = 0x80 | high;
+    timestampHigh = high;
+    timestampLow = low;
+    return true;
+  }
+
+  // Receiver rebuilds the high part from the header and bumps it when the low part goes backwards
+  if (high == timestampHigh && low >= timestampLow)
+  { return true; }
+  if (high == ((timestampHigh + 1) & 0x3F) && low < timestampLow)
+  {
+    timestampHigh = high;
+    return true;
+  }
+  return false;
+}
+
+bool BLEMidiEncoder::SameTimestamp(uint16_t timestamp) const {
+  return ((timestamp >> 7) & 0x3F) == timestampHigh && (timestamp & 0x7F) == timestampLow;
+}
+
+// Jitter buffer
+
+bool BLEMidiJitterBuffer::Push(const BLEMidiEvent& event, uint32_t now) {
+  if (count == BLEMIDI_JITTER_BUFFER_SIZE)
+  { return false; }
+
+  // Transit plus clock difference, modulo the 13 bit timestamp range
+  uint16_t transit = (now - event.timestamp) & BLEMIDI_TIMESTAMP_MASK;
+  if (!synced)
+  {
+    synced = true;
+    offset = transit;
+    windowOffset = transit;
+    windowStart = now;
+  }
+
+  // Keep the fastest transit seen. Re-measure every window so clock drift can't pin us to a stale best case
+  if (((transit - offset) & BLEMIDI_TIMESTAMP_MASK) > (BLEMIDI_TIMESTAMP_MASK >> 1))
+  { offset = transit; }
+  if (((transit - windowOffset) & BLEMIDI_TIMESTAMP_MASK) > (BLEMIDI_TIMESTAMP_MASK >> 1))
+  { windowOffset = transit; }
+  if (now - windowStart >= BLEMIDI_JITTER_WINDOW)
+  {
+    offset = windowOffset;
+    windowOffset = transit;
+    windowStart = now;
+  }
+
+  uint16_t late = (transit - offset) & BLEMIDI_TIMESTAMP_MASK;
+  uint32_t hold = late >= latency ? 0 : latency - late;
+
+  Slot& slot = slots[(head + count) % BLEMIDI_JITTER_BUFFER_SIZE];
+  slot.due = now + hold;
+  slot.packet = event.packet;
+  count++;
+  return true;
+}
+
+bool BLEMidiJitterBuffer::Pop(uint32_t now, MidiPacket* dest) {
+  if (count == 0 || (int32_t)(now - slots[head].due) < 0)
+  { return false; }
+  return PopOldest(dest);
+}
+
+bool BLEMidiJitterBuffer::PopOldest(MidiPacket* dest) {
+  if (count == 0)
+  { return false; }
+
+  *dest = slots[head].packet;
+  head = (head + 1) % BLEMIDI_JITTER_BUFFER_SIZE;
+  count--;
+  return true;
+}
+
+int32_t BLEMidiJitterBuffer::TimeToNext(uint32_t now) const {
+  if (count == 0)
+  { return -1; }
+  int32_t wait = (int32_t)(slots[head].due - now);
+  return wait < 0 ? 0 : wait;
+}
+
+void BLEMidiJitterBuffer::Reset() {
+  head = 0;
+  count = 0;
+  synced = false;
+}
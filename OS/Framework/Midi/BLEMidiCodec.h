@@ -0,0 +1,80 @@
+#pragma once
+
+#include <span>
+#include "MidiPacket.h"
+#include "MidiParser.h"
+
+using std::span;
+
+// BLE-MIDI packet format (MIDI over Bluetooth Low Energy 1.0)
+// Packet: [header: 10hhhhhh] then messages, each full message led by a [timestamp: 1lllllll] byte.
+// Running status messages may skip status and timestamp, SysEx may continue over several packets.
+// Pure byte handling, no BLE stack dependency.
+
+#define BLEMIDI_PACKET_MAX 256 // Largest notification payload we build (ATT MTU - 3, capped)
+#define BLEMIDI_TIMESTAMP_MASK 0x1FFF // 13 bit millisecond timestamp
+#define BLEMIDI_JITTER_BUFFER_SIZE 64
+#define BLEMIDI_JITTER_WINDOW 1000 // ms over which the best transit time is measured
+
+struct BLEMidiEvent {
+  uint16_t timestamp; // Sender's 13 bit ms timestamp
+  MidiPacket packet;
+};
+
+class BLEMidiDecoder {
+ public:
+  uint16_t Decode(span<const uint8_t> packet, span<BLEMidiEvent> dest); // dest should hold packet.size() + 1 events. Returns events written.
+  void Reset();
+
+  uint32_t truncated = 0; // Bytes dropped because dest was full
+
+ private:
+  MidiParser parser; // Keeps running status and SysEx state across packets
+};
+
+class BLEMidiEncoder {
+ public:
+  void SetMTU(uint16_t mtu); // Usable payload of one notification
+  bool Push(const MidiPacket& packet, uint16_t timestamp); // False if it doesn't fit, flush the packet and push again
+  size_t PushSysEx(span<const uint8_t> data, uint16_t timestamp); // Raw SysEx bytes, returns how many fit. Flush and push the rest.
+  span<const uint8_t> Packet() const;
+  bool Empty() const;
+  void Clear(); // Call after the packet has been sent
+
+ private:
+  uint8_t buffer[BLEMIDI_PACKET_MAX];
+  uint16_t length = 0;
+  uint16_t mtu = 20;
+  uint8_t runningStatus = 0;
+  uint8_t timestampHigh = 0;
+  uint8_t timestampLow = 0;
+
+  bool Begin(uint16_t timestamp); // Writes header if needed, false if timestamp can't be expressed in this packet
+  bool SameTimestamp(uint16_t timestamp) const;
+};
+
+// Holds incoming events and releases them on the sender's timeline, trading a fixed latency for steady timing
+class BLEMidiJitterBuffer {
+ public:
+  uint16_t latency = 10; // ms an event that arrived on the fastest observed path is held back
+
+  bool Push(const BLEMidiEvent& event, uint32_t now); // False when full
+  bool Pop(uint32_t now, MidiPacket* dest); // Next due packet, if any
+  bool PopOldest(MidiPacket* dest); // Head even if it isn't due yet, to make room when full
+  int32_t TimeToNext(uint32_t now) const; // ms until the head is due, -1 when empty
+  void Reset();
+
+ private:
+  struct Slot {
+    uint32_t due;
+    MidiPacket packet;
+  };
+  Slot slots[BLEMIDI_JITTER_BUFFER_SIZE];
+  uint8_t head = 0;
+  uint8_t count = 0;
+
+  bool synced = false;
+  uint16_t offset = 0; // Smallest (local - remote) seen in the last window
+  uint16_t windowOffset = 0;
+  uint32_t windowStart = 0;
+};
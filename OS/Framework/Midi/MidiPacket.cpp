@@ -1,12 +1,6 @@
 #include "MidiPacket.h"
 
 // Constructor implementations
-MidiPacket::MidiPacket()  // Place Holder data
-{
-   this->port = MIDI_PORT_INVALID;
-   this->status = EMidiStatus::None;
-}
-
 MidiPacket::MidiPacket(EMidiStatus status, ...) {
   this->port = MIDI_PORT_INVALID;
   this->status = status;
@@ -71,99 +65,6 @@ MidiPacket::MidiPacket(EMidiStatus status, ...) {
   va_end(valst);
 }
 
-// Static factory methods for channel messages
-MidiPacket MidiPacket::NoteOn(uint8_t channel, uint8_t note, uint8_t velocity)
-{
-  return MidiPacket(EMidiStatus::NoteOn, channel, note, velocity);
-}
-
-MidiPacket MidiPacket::NoteOff(uint8_t channel, uint8_t note, uint8_t velocity)
-{
-  return MidiPacket(EMidiStatus::NoteOff, channel, note, velocity);
-}
-
-MidiPacket MidiPacket::AfterTouch(uint8_t channel, uint8_t note, uint8_t pressure)
-{
-  return MidiPacket(EMidiStatus::AfterTouch, channel, note, pressure);
-}
-
-MidiPacket MidiPacket::ControlChange(uint8_t channel, uint8_t controller, uint8_t value)
-{
-  return MidiPacket(EMidiStatus::ControlChange, channel, controller, value);
-}
-
-MidiPacket MidiPacket::ProgramChange(uint8_t channel, uint8_t program)
-{
-  return MidiPacket(EMidiStatus::ProgramChange, channel, program);
-}
-
-MidiPacket MidiPacket::ChannelPressure(uint8_t channel, uint8_t pressure)
-{
-  return MidiPacket(EMidiStatus::ChannelPressure, channel, pressure);
-}
-
-MidiPacket MidiPacket::PitchBend(uint8_t channel, uint16_t value)
-{
-  return MidiPacket(EMidiStatus::PitchChange, channel, value);
-}
-
-// Static factory methods for system messages
-MidiPacket MidiPacket::MTCQuarterFrame(uint8_t value)
-{
-  return MidiPacket(EMidiStatus::MTCQuarterFrame, value);
-}
-
-MidiPacket MidiPacket::SongPosition(uint16_t position)
-{
-  return MidiPacket(EMidiStatus::SongPosition, position);
-}
-
-MidiPacket MidiPacket::SongSelect(uint8_t song)
-{
-  return MidiPacket(EMidiStatus::SongSelect, song);
-}
-
-MidiPacket MidiPacket::TuneRequest()
-{
-  return MidiPacket(EMidiStatus::TuneRequest);
-}
-
-// Static factory methods for real-time messages
-MidiPacket MidiPacket::Clock()
-{
-  return MidiPacket(EMidiStatus::Clock);
-}
-
-MidiPacket MidiPacket::Tick()
-{
-  return MidiPacket(EMidiStatus::Tick);
-}
-
-MidiPacket MidiPacket::Start()
-{
-  return MidiPacket(EMidiStatus::Start);
-}
-
-MidiPacket MidiPacket::Continue()
-{
-  return MidiPacket(EMidiStatus::Continue);
-}
-
-MidiPacket MidiPacket::Stop()
-{
-  return MidiPacket(EMidiStatus::Stop);
-}
-
-MidiPacket MidiPacket::ActiveSense()
-{
-  return MidiPacket(EMidiStatus::ActiveSense);
-}
-
-MidiPacket MidiPacket::Reset()
-{
-  return MidiPacket(EMidiStatus::Reset);
-}
-
 // Status methods
 EMidiStatus MidiPacket::Status() const {
   if((uint8_t)status < EMidiStatus::SysExData)
@@ -391,6 +292,7 @@ uint8_t MidiPacket::Length() const {
       return 3;
     case EMidiStatus::ProgramChange:
     case EMidiStatus::ChannelPressure:
+    case EMidiStatus::MTCQuarterFrame:
     case EMidiStatus::SongSelect:
       return 2;
     case EMidiStatus::TuneRequest:
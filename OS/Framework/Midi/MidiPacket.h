@@ -1,6 +1,7 @@
 #pragma once
 
 #include <stdarg.h>
+#include <type_traits>
 #include "MidiSpecs.h"
 
 enum EMidiStatus : uint8_t {
@@ -48,32 +49,46 @@ struct MidiPacket {
   uint8_t data[3] = {0, 0, 0};
 
   // Constructors
-  MidiPacket();  // Place Holder data
-  MidiPacket(EMidiStatus status, ...);
+  constexpr MidiPacket() = default;  // Place Holder data
+  MidiPacket(EMidiStatus status, ...); // Runtime arity, for bindings. Prefer the typed factories below
+
+  // Typed factories, no varargs and no branching. Usable at compile time
+  static constexpr MidiPacket Raw(EMidiStatus status, uint8_t data0, uint8_t data1 = 0, uint8_t data2 = 0) {
+    MidiPacket packet;
+    packet.status = status;
+    packet.data[0] = data0;
+    packet.data[1] = data1;
+    packet.data[2] = data2;
+    return packet;
+  }
 
   // Static factory methods for channel messages
-  static MidiPacket NoteOn(uint8_t channel, uint8_t note, uint8_t velocity = 127);
-  static MidiPacket NoteOff(uint8_t channel, uint8_t note, uint8_t velocity = 0);
-  static MidiPacket AfterTouch(uint8_t channel, uint8_t note, uint8_t pressure);
-  static MidiPacket ControlChange(uint8_t channel, uint8_t controller, uint8_t value);
-  static MidiPacket ProgramChange(uint8_t channel, uint8_t program);
-  static MidiPacket ChannelPressure(uint8_t channel, uint8_t pressure);
-  static MidiPacket PitchBend(uint8_t channel, uint16_t value);
+  static constexpr MidiPacket NoteOn(uint8_t channel, uint8_t note, uint8_t velocity = 127) { return Raw(EMidiStatus::NoteOn, MIDIv1_NOTE_ON | (channel & 0x0F), note, velocity); }
+  static constexpr MidiPacket NoteOff(uint8_t channel, uint8_t note, uint8_t velocity = 0) { return Raw(EMidiStatus::NoteOff, MIDIv1_NOTE_OFF | (channel & 0x0F), note, velocity); }
+  static constexpr MidiPacket AfterTouch(uint8_t channel, uint8_t note, uint8_t pressure) { return Raw(EMidiStatus::AfterTouch, MIDIv1_AFTER_TOUCH | (channel & 0x0F), note, pressure); }
+  static constexpr MidiPacket ControlChange(uint8_t channel, uint8_t controller, uint8_t value) { return Raw(EMidiStatus::ControlChange, MIDIv1_CONTROL_CHANGE | (channel & 0x0F), controller, value); }
+  static constexpr MidiPacket ProgramChange(uint8_t channel, uint8_t program) { return Raw(EMidiStatus::ProgramChange, MIDIv1_PROGRAM_CHANGE | (channel & 0x0F), program); }
+  static constexpr MidiPacket ChannelPressure(uint8_t channel, uint8_t pressure) { return Raw(EMidiStatus::ChannelPressure, MIDIv1_CHANNEL_PRESSURE | (channel & 0x0F), pressure); }
+  static constexpr MidiPacket PitchBend(uint8_t channel, uint16_t value) { return Raw(EMidiStatus::PitchChange, MIDIv1_PITCH_WHEEL | (channel & 0x0F), value & 0x7F, (value >> 7) & 0x7F); }
 
   // Static factory methods for system messages
-  static MidiPacket MTCQuarterFrame(uint8_t value);
-  static MidiPacket SongPosition(uint16_t position);
-  static MidiPacket SongSelect(uint8_t song);
-  static MidiPacket TuneRequest();
+  static constexpr MidiPacket MTCQuarterFrame(uint8_t value) { return Raw(EMidiStatus::MTCQuarterFrame, MIDIv1_MTC_QUARTER_FRAME, value); }
+  static constexpr MidiPacket SongPosition(uint16_t position) { return Raw(EMidiStatus::SongPosition, MIDIv1_SONG_POSITION_PTR, position & 0x7F, (position >> 7) & 0x7F); }
+  static constexpr MidiPacket SongSelect(uint8_t song) { return Raw(EMidiStatus::SongSelect, MIDIv1_SONG_SELECT, song); }
+  static constexpr MidiPacket TuneRequest() { return Raw(EMidiStatus::TuneRequest, MIDIv1_TUNE_REQUEST); }
 
   // Static factory methods for real-time messages
-  static MidiPacket Clock();
-  static MidiPacket Tick();
-  static MidiPacket Start();
-  static MidiPacket Continue();
-  static MidiPacket Stop();
-  static MidiPacket ActiveSense();
-  static MidiPacket Reset();
+  static constexpr MidiPacket Clock() { return Raw(EMidiStatus::Clock, MIDIv1_CLOCK); }
+  static constexpr MidiPacket Tick() { return Raw(EMidiStatus::Tick, MIDIv1_TICK); }
+  static constexpr MidiPacket Start() { return Raw(EMidiStatus::Start, MIDIv1_START); }
+  static constexpr MidiPacket Continue() { return Raw(EMidiStatus::Continue, MIDIv1_CONTINUE); }
+  static constexpr MidiPacket Stop() { return Raw(EMidiStatus::Stop, MIDIv1_STOP); }
+  static constexpr MidiPacket ActiveSense() { return Raw(EMidiStatus::ActiveSense, MIDIv1_ACTIVE_SENSE); }
+  static constexpr MidiPacket Reset() { return Raw(EMidiStatus::Reset, MIDIv1_RESET); }
+
+  // Static factory methods for SysEx transfer, bytes as they go on the wire
+  static constexpr MidiPacket SysExData(uint8_t data0, uint8_t data1, uint8_t data2) { return Raw(EMidiStatus::SysExData, data0, data1, data2); }
+  static constexpr MidiPacket SysExEnd(uint8_t data0, uint8_t data1 = 0, uint8_t data2 = 0) { return Raw(EMidiStatus::SysExEnd, data0, data1, data2); }
 
   // Status methods
   EMidiStatus Status() const;
@@ -107,4 +122,8 @@ struct MidiPacket {
   uint8_t Length() const;
   bool SysEx() const; // Checks if packet is part of SysEx transfer - Terrible name
   bool SysExStart() const; // Checks if packet is start of SysEx transfer - Terrible name as well
-};
\ No newline at end of file
+};
+
+// 2 byte port + status + 3 data bytes, safe to memcpy through queues
+static_assert(sizeof(MidiPacket) == 6, "MidiPacket layout changed");
+static_assert(std::is_trivially_copyable_v<MidiPacket>, "MidiPacket must stay trivially copyable");
@@ -0,0 +1,136 @@
+#include <cstring>
+#include "MidiParser.h"
+
+uint8_t MidiParser::Parse(uint8_t byte, MidiPacket* dest) {
+  // Realtime can show up anywhere, even mid-message, and doesn't touch any state
+  if (MIDIv1_IS_REALTIME(byte))
+  {
+    if (byte == 0xFD) // Undefined
+    { return 0; }
+    Emit(dest, (EMidiStatus)byte, &byte, 1);
+    return 1;
+  }
+
+  if (MIDIv1_IS_STATUS(byte))
+  {
+    uint8_t written = 0;
+
+    // Any status byte ends a SysEx transfer. Close it so the receiver doesn't wait forever
+    if (sysEx)
+    {
+      written = EndSysEx(dest);
+      if (byte == MIDIv1_SYSEX_END)
+      { return written; }
+      dest += written;
+    }
+
+    if (byte == MIDIv1_SYSEX_START)
+    {
+      runningStatus = 0;
+      sysEx = true;
+      message[0] = byte;
+      index = 1;
+      return written;
+    }
+
+    uint8_t length = MessageLength(byte);
+    if (length == 0) // Undefined system common or stray SysEx end
+    {
+      runningStatus = 0;
+      index = 0;
+      expected = 0;
+      return written;
+    }
+
+    runningStatus = MIDIv1_IS_VOICE(byte) ? byte : 0;
+    message[0] = byte;
+    index = 1;
+    expected = length;
+
+    if (length == 1) // Tune Request
+    {
+      Emit(dest, (EMidiStatus)byte, message, 1);
+      index = 0;
+      expected = 0;
+      written++;
+    }
+    return written;
+  }
+
+  // Data byte
+  if (sysEx)
+  {
+    message[index++] = byte;
+    if (index == 3)
+    {
+      Emit(dest, EMidiStatus::SysExData, message, 3);
+      index = 0;
+      return 1;
+    }
+    return 0;
+  }
+
+  if (index == 0)
+  {
+    // Running status, or a stray data byte we have no status for
+    if (runningStatus == 0)
+    { return 0; }
+    message[0] = runningStatus;
+    index = 1;
+    expected = MessageLength(runningStatus);
+  }
+
+  message[index++] = byte;
+  if (index < expected)
+  { return 0; }
+
+  EMidiStatus status = MIDIv1_IS_VOICE(message[0]) ? (EMidiStatus)MIDIv1_VOICE_COMMAND(message[0]) : (EMidiStatus)message[0];
+  Emit(dest, status, message, expected);
+  index = 0;
+  if (runningStatus == 0) // System common doesn't repeat
+  { expected = 0; }
+  return 1;
+}
+
+void MidiParser::Reset() {
+  runningStatus = 0;
+  index = 0;
+  expected = 0;
+  sysEx = false;
+}
+
+uint8_t MidiParser::EndSysEx(MidiPacket* dest) {
+  message[index++] = MIDIv1_SYSEX_END;
+  Emit(dest, EMidiStatus::SysExEnd, message, index);
+  index = 0;
+  expected = 0;
+  sysEx = false;
+  return 1;
+}
+
+uint8_t MidiParser::MessageLength(uint8_t status) {
+  if (MIDIv1_IS_VOICE(status))
+  {
+    uint8_t command = MIDIv1_VOICE_COMMAND(status);
+    return (command == MIDIv1_PROGRAM_CHANGE || command == MIDIv1_CHANNEL_PRESSURE) ? 2 : 3;
+  }
+
+  switch (status)
+  {
+    case MIDIv1_MTC_QUARTER_FRAME:
+    case MIDIv1_SONG_SELECT:
+      return 2;
+    case MIDIv1_SONG_POSITION_PTR:
+      return 3;
+    case MIDIv1_TUNE_REQUEST:
+      return 1;
+    default:
+      return 0;
+  }
+}
+
+void MidiParser::Emit(MidiPacket* dest, EMidiStatus status, const uint8_t* data, uint8_t length) {
+  *dest = MidiPacket();
+  dest->status = status;
+  memcpy(dest->data, data, length);
+}
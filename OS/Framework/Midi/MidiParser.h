@@ -0,0 +1,23 @@
+#pragma once
+
+#include "MidiPacket.h"
+
+// Turns a MIDI 1.0 byte stream (DIN / UART) back into MidiPackets, one byte at a time
+// Handles running status, realtime bytes interleaved anywhere and streams SysEx out as SysExData / SysExEnd packets.
+// No allocation, safe to feed straight from a driver task.
+class MidiParser {
+ public:
+  uint8_t Parse(uint8_t byte, MidiPacket* dest); // dest needs room for 2 packets. Returns packets written.
+  void Reset(); // Drop partial message and running status (e.g. after a framing error or overflow)
+
+ private:
+  uint8_t runningStatus = 0;
+  uint8_t message[3];
+  uint8_t index = 0;
+  uint8_t expected = 0; // Total bytes of the message in progress, including status
+  bool sysEx = false;
+
+  uint8_t EndSysEx(MidiPacket* dest);
+  static uint8_t MessageLength(uint8_t status);
+  static void Emit(MidiPacket* dest, EMidiStatus status, const uint8_t* data, uint8_t length);
+};
@@ -19,7 +19,7 @@ uint16_t MidiPort::Open(uint16_t id, uint16_t queue_size, uint16_t id_range) {
   }
   if (this->id == MIDI_PORT_INVALID)  // Check if registered
   { return MIDI_PORT_INVALID; }
-  midi_queue = xQueueCreate(queue_size, sizeof(MidiPacket));
+  ring = new MidiRing(queue_size);
   return this->id;
 }
 
@@ -28,9 +28,9 @@ void MidiPort::Close() {
     MidiPort::CloseMidiPort(id);
     this->id = MIDI_PORT_INVALID;
   }
-  if (midi_queue != nullptr) {
-    vQueueDelete(midi_queue);
-    midi_queue = nullptr;
+  if (ring != nullptr) {
+    delete ring;
+    ring = nullptr;
   }
 }
 
@@ -38,8 +38,10 @@ void MidiPort::SetName(string name) {
   this->name = name;
 }
 
-bool MidiPort::Get(MidiPacket* midipacket_dest, uint32_t timeout_ms) {
-  return xQueueReceive(midi_queue, (void*)midipacket_dest, pdMS_TO_TICKS(timeout_ms)) == pdTRUE;
+bool MidiPort::Get(MidiPacket* midipacket_dest, uint32_t timeout_ms, uint32_t* arrival) {
+  if (ring == nullptr)
+    return false;
+  return ring->Wait(midipacket_dest, timeout_ms, arrival);
 }
 
 bool MidiPort::Send(MidiPacket midipacket, uint16_t targetPort, uint32_t timeout_ms) {
@@ -47,22 +49,92 @@ bool MidiPort::Send(MidiPacket midipacket, uint16_t targetPort, uint32_t timeout
   return MidiPort::RouteMidiPacket(midipacket, targetPort, timeout_ms);
 }
 
+bool MidiPort::Send(span<MidiPacket> midipackets, uint16_t targetPort, uint32_t timeout_ms) {
+  if (midipackets.empty())
+    return false;
+
+  for (MidiPacket& midipacket : midipackets)
+  { midipacket.port = this->id; }
+  return MidiPort::RouteMidiPackets(midipackets, targetPort, timeout_ms);
+}
+
 bool MidiPort::Receive(MidiPacket midipacket, uint32_t timeout_ms) {
-  if (midi_queue == nullptr)
+  return Receive(span<const MidiPacket>(&midipacket, 1), timeout_ms);
+}
+
+bool MidiPort::Receive(span<const MidiPacket> midipackets, uint32_t timeout_ms) {
+  if (ring == nullptr)
+    return false;
+
+  // Never block the sender, a full ring drops the newest packet and counts it
+  bool received = true;
+  for (const MidiPacket& midipacket : midipackets)
+  {
+    if (clockListener != nullptr)
+    {
+      switch (midipacket.status)
+      {
+        case EMidiStatus::Clock:
+        case EMidiStatus::Start:
+        case EMidiStatus::Continue:
+        case EMidiStatus::Stop:
+        case EMidiStatus::SongPosition:
+          clockListener(midipacket);
+          break;
+        default:
+          break;
+      }
+    }
+
+    MidiRing* target = (sysExRing != nullptr && midipacket.SysEx()) ? sysExRing : ring;
+    if (!target->Push(midipacket))
+    {
+      std::atomic_ref<uint32_t>(dropped).fetch_add(1, std::memory_order_relaxed);
+      received = false;
+    }
+  }
+  return received;
+}
+
+bool MidiPort::SendSysEx(span<const uint8_t> data, uint16_t targetPort, uint32_t timeout_ms) {
+  return MidiPort::RouteSysEx(this->id, data, targetPort, timeout_ms);
+}
+
+bool MidiPort::ReceiveSysEx(uint16_t sourcePort, span<const uint8_t> data, uint32_t timeout_ms) {
+  if (sysExWriter != nullptr)
+  { return sysExWriter(this, data, timeout_ms); }
+
+  if (ring == nullptr)
     return false;
 
-  if (uxQueueSpacesAvailable(midi_queue) == 0)
+  // No direct path, hand it over as packets. Wait on a full ring so the consumer paces us instead of losing the middle of the message
+  MidiRing* target = sysExRing != nullptr ? sysExRing : ring;
+  uint64_t start = MatrixOS::SYS::Millis();
+  for (size_t index = 0; index < data.size(); index += 3)
   {
-    // Drop oldest packet to make room for new one (FIFO overflow behavior)
-    MidiPacket discarded;
-    xQueueReceive(midi_queue, &discarded, 0);
+    uint8_t length = std::min(data.size() - index, (size_t)3);
+    MidiPacket packet;
+    packet.port = sourcePort;
+    packet.status = (index + length == data.size()) ? EMidiStatus::SysExEnd : EMidiStatus::SysExData;
+    memcpy(packet.data, data.data() + index, length);
+    while (!target->Push(packet))
+    {
+      if (MatrixOS::SYS::Millis() - start >= timeout_ms)
+      {
+        std::atomic_ref<uint32_t>(dropped).fetch_add(1, std::memory_order_relaxed);
+        return false;
+      }
+      vTaskDelay(1);
+    }
   }
-  xQueueSend(midi_queue, &midipacket, pdMS_TO_TICKS(timeout_ms));
   return true;
 }
 
+uint32_t MidiPort::Dropped() {
+  return std::atomic_ref<uint32_t>(dropped).load(std::memory_order_relaxed);
+}
+
 MidiPort::MidiPort() {
-  midi_queue = nullptr;
 }
 
 MidiPort::MidiPort(string name, uint16_t id, uint16_t queue_size) {
@@ -96,8 +168,11 @@ void MidiPort::CloseMidiPort(uint16_t port_id) {
 }
 
 bool MidiPort::RouteMidiPacket(MidiPacket midiPacket, uint16_t targetPort, uint16_t timeout_ms) {
-    uint16_t sourcePort = midiPacket.port; // Where the packet came from
-    
+  return RouteMidiPackets(span<const MidiPacket>(&midiPacket, 1), targetPort, timeout_ms);
+}
+
+template <typename Deliver>
+bool MidiPort::RouteTo(uint16_t sourcePort, uint16_t targetPort, Deliver deliver) {
     if (targetPort == MIDI_PORT_EACH_CLASS)
     {
       uint16_t targetClass = MIDI_PORT_USB;
@@ -108,7 +183,7 @@ bool MidiPort::RouteMidiPacket(MidiPacket midiPacket, uint16_t targetPort, uint1
         { return send; }
         if (port->first >= targetClass && port->first != sourcePort)
         {
-          send |= port->second->Receive(midiPacket, timeout_ms);
+          send |= deliver(port->second);
           targetClass = (port->first / 0x100 + 1) * 0x100;
         }
       }
@@ -122,7 +197,7 @@ bool MidiPort::RouteMidiPacket(MidiPacket midiPacket, uint16_t targetPort, uint1
         // Don't send back to source port
         if (port->first != sourcePort)
         {
-          send |= port->second->Receive(midiPacket, timeout_ms);
+          send |= deliver(port->second);
         }
       }
       return send;
@@ -135,9 +210,24 @@ bool MidiPort::RouteMidiPacket(MidiPacket midiPacket, uint16_t targetPort, uint1
         // Don't send back to source port
         if (port->first != sourcePort)
         {
-          return port->second->Receive(midiPacket, timeout_ms); 
+          return deliver(port->second); 
         }
       }
     }
     return false;
-}
\ No newline at end of file
+}
+
+bool MidiPort::RouteMidiPackets(span<const MidiPacket> midiPackets, uint16_t targetPort, uint16_t timeout_ms) {
+    if (midiPackets.empty())
+    { return false; }
+
+    uint16_t sourcePort = midiPackets[0].port; // Where the packets came from
+    return RouteTo(sourcePort, targetPort, [&](MidiPort* port) { return port->Receive(midiPackets, timeout_ms); });
+}
+
+bool MidiPort::RouteSysEx(uint16_t sourcePort, span<const uint8_t> data, uint16_t targetPort, uint32_t timeout_ms) {
+    if (data.empty())
+    { return false; }
+
+    return RouteTo(sourcePort, targetPort, [&](MidiPort* port) { return port->ReceiveSysEx(sourcePort, data, timeout_ms); });
+}
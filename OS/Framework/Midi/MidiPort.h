@@ -1,24 +1,40 @@
 #pragma once
 
 #include "FreeRTOS.h"
-#include "queue.h"
 #include <map>
+#include "MidiRing.h"
+
+class MidiPort;
+typedef void (*ClockListener)(const MidiPacket& packet);
+typedef bool (*SysExWriter)(MidiPort* port, span<const uint8_t> data, uint32_t timeout_ms); // Writes a whole F0 ... F7 message, blocks until the transport took all of it
 
 class MidiPort {
  private:
   static std::map<uint16_t, MidiPort*> midiPortMap;
 
+  template <typename Deliver>
+  static bool RouteTo(uint16_t sourcePort, uint16_t targetPort, Deliver deliver);
+
  public:
   string name;
   uint16_t id = MIDI_PORT_INVALID;
-  QueueHandle_t midi_queue;
+  MidiRing* ring = nullptr;
+  MidiRing* sysExRing = nullptr; // When set, incoming SysEx packets go here instead of the main ring
+  uint32_t dropped = 0; // Packets lost to a full ring
+  ClockListener clockListener = nullptr; // Sees Clock, Start, Continue, Stop and Song Position as they arrive, on the sending task
+  SysExWriter sysExWriter = nullptr; // Set by transports that can take a contiguous SysEx buffer, others get it as packets
 
   uint16_t Open(uint16_t id, uint16_t queue_size = 64, uint16_t id_range = 1);
   void Close();
   void SetName(string name);
-  bool Get(MidiPacket* midipacket_dest, uint32_t timeout_ms = 0);
+  bool Get(MidiPacket* midipacket_dest, uint32_t timeout_ms = 0, uint32_t* arrival = nullptr); // arrival is SYS::Micros() when the packet reached the port
   bool Send(MidiPacket midipacket, uint16_t targetPort = MIDI_PORT_OS, uint32_t timeout_ms = 0);
+  bool Send(span<MidiPacket> midipackets, uint16_t targetPort = MIDI_PORT_OS, uint32_t timeout_ms = 0); // Route a whole burst at once
   bool Receive(MidiPacket midipacket, uint32_t timeout_ms = 0);
+  bool Receive(span<const MidiPacket> midipackets, uint32_t timeout_ms = 0);
+  bool SendSysEx(span<const uint8_t> data, uint16_t targetPort = MIDI_PORT_OS, uint32_t timeout_ms = 0); // data is a full F0 ... F7 message
+  bool ReceiveSysEx(uint16_t sourcePort, span<const uint8_t> data, uint32_t timeout_ms = 0); // Waits for ring space instead of dropping
+  uint32_t Dropped();
 
   MidiPort();
   MidiPort(string name, uint16_t id, uint16_t queue_size = 64);
@@ -29,4 +45,6 @@ class MidiPort {
   static bool OpenMidiPort(uint16_t port_id, MidiPort* midiPort);
   static void CloseMidiPort(uint16_t port_id);
   static bool RouteMidiPacket(MidiPacket midiPacket, uint16_t targetPort, uint16_t timeout_ms);
+  static bool RouteMidiPackets(span<const MidiPacket> midiPackets, uint16_t targetPort, uint16_t timeout_ms); // All packets must share the same source port
+  static bool RouteSysEx(uint16_t sourcePort, span<const uint8_t> data, uint16_t targetPort, uint32_t timeout_ms);
 };
@@ -0,0 +1,103 @@
+#include "MatrixOS.h"
+#include "MidiRing.h"
+
+#if configTASK_NOTIFICATION_ARRAY_ENTRIES <= MIDI_RING_NOTIFY_INDEX
+#error "MidiRing needs CONFIG_FREERTOS_TASK_NOTIFICATION_ARRAY_ENTRIES > MIDI_RING_NOTIFY_INDEX"
+#endif
+
+MidiRing::MidiRing(uint16_t capacity) {
+  uint32_t size = 1;
+  while (size < capacity)
+  { size <<= 1; }
+
+  slots = new Slot[size];
+  mask = size - 1;
+  for (uint32_t i = 0; i < size; i++)
+  { slots[i].sequence.store(i, std::memory_order_relaxed); }
+}
+
+MidiRing::~MidiRing() {
+  delete[] slots;
+}
+
+bool MidiRing::Push(const MidiPacket& packet) {
+  // Stamp before anything can stall us, this is as close to the transport as the packet gets
+  uint32_t time = (uint32_t)MatrixOS::SYS::Micros();
+
+  // Each slot's sequence tells whose turn it is: == pos free for this lap, == pos + 1 filled, behind means full
+  uint32_t pos = head.load(std::memory_order_relaxed);
+  Slot* slot;
+  while (true)
+  {
+    slot = &slots[pos & mask];
+    uint32_t sequence = slot->sequence.load(std::memory_order_acquire);
+    int32_t diff = (int32_t)(sequence - pos);
+    if (diff == 0)
+    {
+      if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+      { break; }
+    }
+    else if (diff < 0)
+    { return false; }
+    else
+    { pos = head.load(std::memory_order_relaxed); }
+  }
+
+  slot->packet = packet;
+  slot->time = time;
+  slot->sequence.store(pos + 1, std::memory_order_release);
+
+  // Store sequence then load waiter, mirrored in Wait. Without a full fence both sides can read the stale value
+  // and the consumer sleeps on a packet nobody wakes it for.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  TaskHandle_t task = waiter.load(std::memory_order_relaxed);
+  if (task != nullptr)
+  { xTaskNotifyGiveIndexed(task, MIDI_RING_NOTIFY_INDEX); }
+  return true;
+}
+
+bool MidiRing::Pop(MidiPacket* dest, uint32_t* time) {
+  uint32_t pos = tail.load(std::memory_order_relaxed);
+  Slot& slot = slots[pos & mask];
+  if ((int32_t)(slot.sequence.load(std::memory_order_acquire) - (pos + 1)) < 0)
+  { return false; }
+
+  *dest = slot.packet;
+  if (time != nullptr)
+  { *time = slot.time; }
+  slot.sequence.store(pos + mask + 1, std::memory_order_release);
+  tail.store(pos + 1, std::memory_order_relaxed);
+  return true;
+}
+
+bool MidiRing::Wait(MidiPacket* dest, uint32_t timeout_ms, uint32_t* time) {
+  if (Pop(dest, time))
+  { return true; }
+  if (timeout_ms == 0)
+  { return false; }
+
+  // Publish ourselves first, then re-check, so a push racing with us either sees the waiter or gets popped here
+  waiter.store(xTaskGetCurrentTaskHandle(), std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  bool forever = timeout_ms == portMAX_DELAY;
+  TickType_t ticks = forever ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+  TickType_t start = xTaskGetTickCount();
+  bool received;
+  while (!(received = Pop(dest, time)))
+  {
+    TickType_t elapsed = xTaskGetTickCount() - start;
+    if (!forever && elapsed >= ticks)
+    { break; }
+    ulTaskNotifyTakeIndexed(MIDI_RING_NOTIFY_INDEX, pdTRUE, forever ? portMAX_DELAY : ticks - elapsed);
+  }
+  waiter.store(nullptr, std::memory_order_relaxed);
+  return received;
+}
+
+uint16_t MidiRing::Count() const {
+  return head.load(std::memory_order_relaxed) - tail.load(std::memory_order_relaxed);
+}
+
+uint16_t MidiRing::Capacity() const {
+  return mask + 1;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include <atomic>
+#include "MidiPacket.h"
+
+#define MIDI_RING_NOTIFY_INDEX 1 // Task notification slot Wait sleeps on, kept off the default slot other xTaskNotifyGive users share
+
+// Bounded lock-free multi producer / single consumer ring of MidiPackets
+// Any task may Push. One task at a time may Pop / Wait, it sleeps on its task notification until data arrives.
+// Not for ISR producers (wake up uses xTaskNotifyGiveIndexed).
+class MidiRing {
+ public:
+  MidiRing(uint16_t capacity); // Rounded up to a power of two
+  ~MidiRing();
+  MidiRing(const MidiRing&) = delete;
+  MidiRing& operator=(const MidiRing&) = delete;
+
+  bool Push(const MidiPacket& packet); // False when full, the packet is not queued. Stamped with SYS::Micros() on the way in
+  bool Pop(MidiPacket* dest, uint32_t* time = nullptr); // time gets the stamp from Push
+  bool Wait(MidiPacket* dest, uint32_t timeout_ms, uint32_t* time = nullptr); // Pop, blocking up to timeout_ms (portMAX_DELAY for forever)
+  uint16_t Count() const;
+  uint16_t Capacity() const;
+
+ private:
+  struct Slot {
+    std::atomic<uint32_t> sequence;
+    MidiPacket packet;
+    uint32_t time; // Lower 32 bits of SYS::Micros() when pushed
+  };
+
+  Slot* slots;
+  uint32_t mask;
+  std::atomic<uint32_t> head{0}; // Next position producers claim
+  std::atomic<uint32_t> tail{0}; // Next position the consumer reads, only written by the consumer
+  std::atomic<TaskHandle_t> waiter{nullptr};
+};
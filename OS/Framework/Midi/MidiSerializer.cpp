@@ -0,0 +1,65 @@
+#include "MatrixOS.h"
+#include "MidiSerializer.h"
+
+uint8_t MidiSerializer::Serialize(const MidiPacket& packet, uint8_t* dest) {
+  uint8_t length = packet.Length();
+  if (length == 0)
+  { return 0; }
+
+  // SysEx and system common cancel running status
+  if (packet.SysEx() || MIDIv1_IS_SYSCOMMON(packet.data[0]))
+  {
+    runningStatus = 0;
+    memcpy(dest, packet.data, length);
+    return length;
+  }
+
+  // Realtime does not touch running status
+  if (MIDIv1_IS_REALTIME(packet.data[0]))
+  {
+    dest[0] = packet.data[0];
+    return 1;
+  }
+
+  uint8_t status = packet.data[0];
+  if (noteOffAsNoteOn && MIDIv1_VOICE_COMMAND(status) == MIDIv1_NOTE_OFF && packet.data[2] == 0)
+  { status = MIDIv1_NOTE_ON | MIDIv1_VOICE_CHANNEL(status); }
+
+  uint8_t written = 0;
+  if (status != runningStatus)
+  {
+    dest[written++] = status;
+    runningStatus = status;
+  }
+  dest[written++] = packet.data[1];
+  if (length == 3)
+  { dest[written++] = packet.data[2]; }
+  return written;
+}
+
+uint16_t MidiSerializer::Serialize(span<const MidiPacket> packets, uint8_t* dest) {
+  uint16_t length = 0;
+
+  // Timing clock first so it never waits behind a burst of notes. Start/Continue/Stop and everything else
+  // keep their order, moving them past an SPP or a note would change what the receiver does.
+  for (const MidiPacket& packet : packets)
+  {
+    if (IsTimingClock(packet))
+    { dest[length++] = packet.data[0]; }
+  }
+
+  for (const MidiPacket& packet : packets)
+  {
+    if (!IsTimingClock(packet))
+    { length += Serialize(packet, dest + length); }
+  }
+  return length;
+}
+
+void MidiSerializer::Reset() {
+  runningStatus = 0;
+}
+
+bool MidiSerializer::IsTimingClock(const MidiPacket& packet) {
+  return !packet.SysEx() && packet.Length() == 1 && packet.data[0] == MIDIv1_CLOCK;
+}
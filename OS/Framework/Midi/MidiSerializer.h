@@ -0,0 +1,20 @@
+#pragma once
+
+#include "MidiPacket.h"
+
+// Turns MidiPackets into a MIDI 1.0 byte stream (DIN / UART)
+// Uses running status for channel voice messages and only emits Length() bytes per packet.
+// Realtime bytes are transparent to running status, so they can be placed anywhere in the stream.
+class MidiSerializer {
+ public:
+  bool noteOffAsNoteOn = true; // Send velocity 0 Note Off as Note On so it can share the Note On running status
+
+  uint8_t Serialize(const MidiPacket& packet, uint8_t* dest); // dest needs room for 3 bytes. Returns bytes written.
+  uint16_t Serialize(span<const MidiPacket> packets, uint8_t* dest); // dest needs room for packets.size() * 3 bytes. Timing clock is moved to the front, everything else stays in order.
+  void Reset(); // Forget running status, next voice message will carry its status byte
+
+ private:
+  uint8_t runningStatus = 0;
+
+  static bool IsTimingClock(const MidiPacket& packet);
+};
@@ -0,0 +1,295 @@
+#include "MatrixOS.h"
+#include "UMP.h"
+
+uint8_t UMP::WordCount() const {
+  switch (Type())
+  {
+    case UMP_UTILITY:
+    case UMP_SYSTEM:
+    case UMP_MIDI1_CHANNEL_VOICE:
+    case 0x6:
+    case 0x7:
+      return 1;
+    case UMP_DATA64:
+    case UMP_MIDI2_CHANNEL_VOICE:
+    case 0x8:
+    case 0x9:
+    case 0xA:
+      return 2;
+    case 0xB:
+    case 0xC:
+      return 3;
+    default:
+      return 4;
+  }
+}
+
+static UMP MIDI2ChannelVoice(uint8_t group, uint8_t status, uint8_t channel, uint8_t byte3, uint8_t byte4, uint32_t data) {
+  UMP ump;
+  ump.words[0] = ((uint32_t)UMP_MIDI2_CHANNEL_VOICE << 28) | ((uint32_t)(group & 0x0F) << 24) | ((uint32_t)(status | (channel & 0x0F)) << 16) |
+                 ((uint32_t)(byte3 & 0x7F) << 8) | byte4;
+  ump.words[1] = data;
+  return ump;
+}
+
+UMP UMP::NoteOn(uint8_t group, uint8_t channel, uint8_t note, uint16_t velocity, uint8_t attributeType, uint16_t attribute) {
+  return MIDI2ChannelVoice(group, MIDIv1_NOTE_ON, channel, note, attributeType, ((uint32_t)velocity << 16) | attribute);
+}
+
+UMP UMP::NoteOff(uint8_t group, uint8_t channel, uint8_t note, uint16_t velocity, uint8_t attributeType, uint16_t attribute) {
+  return MIDI2ChannelVoice(group, MIDIv1_NOTE_OFF, channel, note, attributeType, ((uint32_t)velocity << 16) | attribute);
+}
+
+UMP UMP::PolyPressure(uint8_t group, uint8_t channel, uint8_t note, uint32_t pressure) {
+  return MIDI2ChannelVoice(group, MIDIv1_AFTER_TOUCH, channel, note, 0, pressure);
+}
+
+UMP UMP::ControlChange(uint8_t group, uint8_t channel, uint8_t controller, uint32_t value) {
+  return MIDI2ChannelVoice(group, MIDIv1_CONTROL_CHANGE, channel, controller, 0, value);
+}
+
+UMP UMP::PerNoteController(uint8_t group, uint8_t channel, uint8_t note, uint8_t controller, uint32_t value, bool registered) {
+  uint8_t status = (registered ? UMP_MIDI2_REGISTERED_PER_NOTE_CONTROLLER : UMP_MIDI2_ASSIGNABLE_PER_NOTE_CONTROLLER) << 4;
+  return MIDI2ChannelVoice(group, status, channel, note, controller, value);
+}
+
+UMP UMP::ChannelPressure(uint8_t group, uint8_t channel, uint32_t pressure) {
+  return MIDI2ChannelVoice(group, MIDIv1_CHANNEL_PRESSURE, channel, 0, 0, pressure);
+}
+
+UMP UMP::PitchBend(uint8_t group, uint8_t channel, uint32_t value) {
+  return MIDI2ChannelVoice(group, MIDIv1_PITCH_WHEEL, channel, 0, 0, value);
+}
+
+UMP UMP::ProgramChange(uint8_t group, uint8_t channel, uint8_t program) {
+  return MIDI2ChannelVoice(group, MIDIv1_PROGRAM_CHANGE, channel, 0, 0, (uint32_t)(program & 0x7F) << 24);
+}
+
+uint32_t UMP::Scale(uint32_t value, uint8_t srcBits, uint8_t dstBits) {
+  if (srcBits >= dstBits)
+  { return value >> (srcBits - dstBits); }
+  if (value == 0)
+  { return 0; }
+
+  // Below center: plain shift. Above: repeat the lower bits so max maps to max
+  uint8_t scaleBits = dstBits - srcBits;
+  uint32_t shifted = value << scaleBits;
+  uint32_t center = 1 << (srcBits - 1);
+  if (value <= center)
+  { return shifted; }
+
+  uint8_t repeatBits = srcBits - 1;
+  uint32_t repeatValue = value & ((1 << repeatBits) - 1);
+  if (scaleBits > repeatBits)
+  { repeatValue <<= scaleBits - repeatBits; }
+  else
+  { repeatValue >>= repeatBits - scaleBits; }
+
+  while (repeatValue != 0)
+  {
+    shifted |= repeatValue;
+    repeatValue >>= repeatBits;
+  }
+  return shifted;
+}
+
+uint8_t UMPTranslator::ToUMP(const MidiPacket& packet, UMP* dest) {
+  if (packet.SysEx())
+  {
+    uint8_t written = 0;
+    uint8_t length = packet.Length();
+    for (uint8_t i = 0; i < length; i++)
+    {
+      uint8_t byte = packet.data[i];
+      if (byte == MIDIv1_SYSEX_START)
+      {
+        sysExLength = 0;
+        sysExStarted = false;
+        continue;
+      }
+      if (byte == MIDIv1_SYSEX_END)
+      {
+        dest[written++] = SysEx7(sysExStarted ? UMP_SYSEX7_END : UMP_SYSEX7_COMPLETE);
+        sysExStarted = false;
+        continue;
+      }
+
+      // A full SysEx7 packet is only sent once the next byte shows it isn't the last one
+      if (sysExLength == 6)
+      {
+        dest[written++] = SysEx7(sysExStarted ? UMP_SYSEX7_CONTINUE : UMP_SYSEX7_START);
+        sysExStarted = true;
+      }
+      sysEx[sysExLength++] = byte;
+    }
+    return written;
+  }
+
+  uint8_t length = packet.Length();
+  if (length == 0)
+  { return 0; }
+
+  *dest = UMP();
+  uint8_t status = packet.data[0];
+  uint8_t data1 = length > 1 ? packet.data[1] : 0;
+  uint8_t data2 = length > 2 ? packet.data[2] : 0;
+
+  if (!MIDIv1_IS_VOICE(status))
+  {
+    dest->words[0] = ((uint32_t)UMP_SYSTEM << 28) | ((uint32_t)group << 24) | ((uint32_t)status << 16) | ((uint32_t)data1 << 8) | data2;
+    return 1;
+  }
+
+  if (!midi2)
+  {
+    dest->words[0] = ((uint32_t)UMP_MIDI1_CHANNEL_VOICE << 28) | ((uint32_t)group << 24) | ((uint32_t)status << 16) | ((uint32_t)data1 << 8) | data2;
+    return 1;
+  }
+
+  uint8_t channel = MIDIv1_VOICE_CHANNEL(status);
+  switch (MIDIv1_VOICE_COMMAND(status))
+  {
+    case MIDIv1_NOTE_ON:
+      if (data2 == 0) // Velocity 0 Note On is a Note Off in MIDI 2.0
+      {
+        *dest = UMP::NoteOff(group, channel, data1, 0x8000);
+        return 1;
+      }
+      *dest = UMP::NoteOn(group, channel, data1, UMP::Scale(data2, 7, 16));
+      return 1;
+    case MIDIv1_NOTE_OFF:
+      *dest = UMP::NoteOff(group, channel, data1, UMP::Scale(data2, 7, 16));
+      return 1;
+    case MIDIv1_AFTER_TOUCH:
+      *dest = UMP::PolyPressure(group, channel, data1, UMP::Scale(data2, 7, 32));
+      return 1;
+    case MIDIv1_CONTROL_CHANGE:
+      *dest = UMP::ControlChange(group, channel, data1, UMP::Scale(data2, 7, 32));
+      return 1;
+    case MIDIv1_PROGRAM_CHANGE:
+      *dest = UMP::ProgramChange(group, channel, data1);
+      return 1;
+    case MIDIv1_CHANNEL_PRESSURE:
+      *dest = UMP::ChannelPressure(group, channel, UMP::Scale(data1, 7, 32));
+      return 1;
+    case MIDIv1_PITCH_WHEEL:
+      *dest = UMP::PitchBend(group, channel, UMP::Scale(data1 | (data2 << 7), 14, 32));
+      return 1;
+  }
+  return 0;
+}
+
+uint8_t UMPTranslator::FromUMP(const UMP& ump, MidiPacket* dest) {
+  uint32_t word0 = ump.words[0];
+  uint8_t status = ump.Status();
+  uint8_t byte3 = (word0 >> 8) & 0x7F;
+  uint8_t byte4 = word0 & 0xFF;
+
+  switch (ump.Type())
+  {
+    case UMP_SYSTEM:
+    case UMP_MIDI1_CHANNEL_VOICE:
+    {
+      // Same bytes as MIDI 1.0
+      MidiPacket packet;
+      packet.status = MIDIv1_IS_VOICE(status) ? (EMidiStatus)MIDIv1_VOICE_COMMAND(status) : (EMidiStatus)status;
+      packet.data[0] = status;
+      packet.data[1] = byte3;
+      packet.data[2] = byte4 & 0x7F;
+      if (!MIDIv1_IS_STATUS(status) || packet.SysEx() || packet.Length() == 0)
+      { return 0; }
+      uint8_t length = packet.Length();
+      for (uint8_t i = length; i < 3; i++)
+      { packet.data[i] = 0; }
+      dest[0] = packet;
+      return 1;
+    }
+    case UMP_DATA64:
+    {
+      uint8_t sysExStatus = status >> 4;
+      uint8_t count = std::min<uint8_t>(status & 0x0F, 6);
+      uint8_t bytes[6] = {(uint8_t)(byte3), (uint8_t)(byte4 & 0x7F), (uint8_t)(ump.words[1] >> 24), (uint8_t)(ump.words[1] >> 16),
+                          (uint8_t)(ump.words[1] >> 8), (uint8_t)ump.words[1]};
+      uint8_t written = 0;
+      if (sysExStatus == UMP_SYSEX7_COMPLETE || sysExStatus == UMP_SYSEX7_START)
+      { written += parser.Parse(MIDIv1_SYSEX_START, dest + written); }
+      for (uint8_t i = 0; i < count; i++)
+      { written += parser.Parse(bytes[i] & 0x7F, dest + written); }
+      if (sysExStatus == UMP_SYSEX7_COMPLETE || sysExStatus == UMP_SYSEX7_END)
+      { written += parser.Parse(MIDIv1_SYSEX_END, dest + written); }
+      return written;
+    }
+    case UMP_MIDI2_CHANNEL_VOICE:
+    {
+      uint8_t channel = ump.Channel();
+      uint32_t data = ump.words[1];
+      switch (status & 0xF0)
+      {
+        case MIDIv1_NOTE_ON:
+        {
+          uint8_t velocity = UMP::Scale(data >> 16, 16, 7);
+          dest[0] = MidiPacket::NoteOn(channel, byte3, velocity == 0 ? 1 : velocity); // Velocity 0 would turn it into a Note Off
+          return 1;
+        }
+        case MIDIv1_NOTE_OFF:
+          dest[0] = MidiPacket::NoteOff(channel, byte3, UMP::Scale(data >> 16, 16, 7));
+          return 1;
+        case MIDIv1_AFTER_TOUCH:
+          dest[0] = MidiPacket::AfterTouch(channel, byte3, UMP::Scale(data, 32, 7));
+          return 1;
+        case MIDIv1_CONTROL_CHANGE:
+          dest[0] = MidiPacket::ControlChange(channel, byte3, UMP::Scale(data, 32, 7));
+          return 1;
+        case MIDIv1_PROGRAM_CHANGE:
+        {
+          uint8_t written = 0;
+          if (byte4 & 0x01) // Bank valid
+          {
+            dest[written++] = MidiPacket::ControlChange(channel, 0, (data >> 8) & 0x7F);
+            dest[written++] = MidiPacket::ControlChange(channel, 32, data & 0x7F);
+          }
+          dest[written++] = MidiPacket::ProgramChange(channel, (data >> 24) & 0x7F);
+          return written;
+        }
+        case MIDIv1_CHANNEL_PRESSURE:
+          dest[0] = MidiPacket::ChannelPressure(channel, UMP::Scale(data, 32, 7));
+          return 1;
+        case MIDIv1_PITCH_WHEEL:
+          dest[0] = MidiPacket::PitchBend(channel, UMP::Scale(data, 32, 14));
+          return 1;
+        case UMP_MIDI2_REGISTERED_CONTROLLER << 4:
+        case UMP_MIDI2_ASSIGNABLE_CONTROLLER << 4:
+        {
+          // RPN / NRPN: parameter number then 14 bit data entry
+          uint8_t base = (status & 0xF0) == (UMP_MIDI2_REGISTERED_CONTROLLER << 4) ? 101 : 99;
+          uint16_t value = UMP::Scale(data, 32, 14);
+          dest[0] = MidiPacket::ControlChange(channel, base, byte3);
+          dest[1] = MidiPacket::ControlChange(channel, base - 1, byte4 & 0x7F);
+          dest[2] = MidiPacket::ControlChange(channel, 6, value >> 7);
+          dest[3] = MidiPacket::ControlChange(channel, 38, value & 0x7F);
+          return 4;
+        }
+      }
+      return 0; // Per note controllers, per note pitch bend and management have no MIDI 1.0 form
+    }
+    default:
+      return 0;
+  }
+}
+
+void UMPTranslator::Reset() {
+  sysExLength = 0;
+  sysExStarted = false;
+  parser.Reset();
+}
+
+UMP UMPTranslator::SysEx7(uint8_t status) {
+  UMP ump;
+  uint8_t bytes[6] = {0, 0, 0, 0, 0, 0};
+  memcpy(bytes, sysEx, sysExLength);
+  ump.words[0] = ((uint32_t)UMP_DATA64 << 28) | ((uint32_t)group << 24) | ((uint32_t)status << 20) | ((uint32_t)sysExLength << 16) |
+                 ((uint32_t)bytes[0] << 8) | bytes[1];
+  ump.words[1] = ((uint32_t)bytes[2] << 24) | ((uint32_t)bytes[3] << 16) | ((uint32_t)bytes[4] << 8) | bytes[5];
+  sysExLength = 0;
+  return ump;
+}
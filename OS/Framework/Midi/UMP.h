@@ -0,0 +1,70 @@
+#pragma once
+
+#include "MidiPacket.h"
+#include "MidiParser.h"
+
+// Universal MIDI Packet (MIDI 2.0). 32, 64 or 128 bit depending on message type.
+enum EUMPType : uint8_t {
+  UMP_UTILITY = 0x0,
+  UMP_SYSTEM = 0x1,           // 32 bit, system common and realtime
+  UMP_MIDI1_CHANNEL_VOICE = 0x2, // 32 bit, MIDI 1.0 protocol
+  UMP_DATA64 = 0x3,           // 64 bit, SysEx7
+  UMP_MIDI2_CHANNEL_VOICE = 0x4, // 64 bit, MIDI 2.0 protocol
+  UMP_DATA128 = 0x5,          // 128 bit, SysEx8 and mixed data set
+};
+
+// MIDI 2.0 channel voice status nibbles that don't exist in MIDI 1.0
+#define UMP_MIDI2_REGISTERED_PER_NOTE_CONTROLLER 0x0
+#define UMP_MIDI2_ASSIGNABLE_PER_NOTE_CONTROLLER 0x1
+#define UMP_MIDI2_REGISTERED_CONTROLLER 0x2
+#define UMP_MIDI2_ASSIGNABLE_CONTROLLER 0x3
+#define UMP_MIDI2_PER_NOTE_PITCH_BEND 0x6
+#define UMP_MIDI2_PER_NOTE_MANAGEMENT 0xF
+
+// SysEx7 status nibbles
+#define UMP_SYSEX7_COMPLETE 0x0
+#define UMP_SYSEX7_START 0x1
+#define UMP_SYSEX7_CONTINUE 0x2
+#define UMP_SYSEX7_END 0x3
+
+struct UMP {
+  uint32_t words[4] = {0, 0, 0, 0};
+
+  EUMPType Type() const { return (EUMPType)(words[0] >> 28); }
+  uint8_t Group() const { return (words[0] >> 24) & 0x0F; }
+  uint8_t Status() const { return (words[0] >> 16) & 0xFF; } // Status byte with channel
+  uint8_t Channel() const { return (words[0] >> 16) & 0x0F; }
+  uint8_t WordCount() const;
+
+  // MIDI 2.0 protocol channel voice
+  static UMP NoteOn(uint8_t group, uint8_t channel, uint8_t note, uint16_t velocity, uint8_t attributeType = 0, uint16_t attribute = 0);
+  static UMP NoteOff(uint8_t group, uint8_t channel, uint8_t note, uint16_t velocity, uint8_t attributeType = 0, uint16_t attribute = 0);
+  static UMP PolyPressure(uint8_t group, uint8_t channel, uint8_t note, uint32_t pressure);
+  static UMP ControlChange(uint8_t group, uint8_t channel, uint8_t controller, uint32_t value);
+  static UMP PerNoteController(uint8_t group, uint8_t channel, uint8_t note, uint8_t controller, uint32_t value, bool registered = false);
+  static UMP ChannelPressure(uint8_t group, uint8_t channel, uint32_t pressure);
+  static UMP PitchBend(uint8_t group, uint8_t channel, uint32_t value); // 0x80000000 is center
+  static UMP ProgramChange(uint8_t group, uint8_t channel, uint8_t program);
+
+  static uint32_t Scale(uint32_t value, uint8_t srcBits, uint8_t dstBits); // Min-center-max scaling from the MIDI 2.0 spec
+};
+
+// Converts between MidiPacket (MIDI 1.0 byte messages) and UMP at port edges.
+// Stateful only for SysEx, which is regrouped from 3 byte packets into 6 byte SysEx7 packets and back.
+class UMPTranslator {
+ public:
+  uint8_t group = 0;
+  bool midi2 = true; // Produce MIDI 2.0 protocol channel voice, otherwise MIDI 1.0 protocol (type 2)
+
+  uint8_t ToUMP(const MidiPacket& packet, UMP* dest); // dest needs room for 2. Returns UMPs written.
+  uint8_t FromUMP(const UMP& ump, MidiPacket* dest); // dest needs room for 4. Returns packets written, 0 if not representable in MIDI 1.0
+  void Reset();
+
+ private:
+  uint8_t sysEx[6];
+  uint8_t sysExLength = 0;
+  bool sysExStarted = false;
+  MidiParser parser;
+
+  UMP SysEx7(uint8_t status);
+};
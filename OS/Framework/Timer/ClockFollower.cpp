@@ -0,0 +1,71 @@
+#include "ClockFollower.h"
+#include <cmath>
+#include <algorithm>
+
+ClockFollower::ClockFollower(float minPeriod, float maxPeriod) {
+  this->minPeriod = minPeriod;
+  this->maxPeriod = maxPeriod;
+}
+
+void ClockFollower::Reset() {
+  pulses = 0;
+  outliers = 0;
+  filteredTime = 0;
+  period = 0;
+}
+
+bool ClockFollower::Update(uint64_t time) {
+  if (pulses == 0)
+  {
+    filteredTime = time;
+    pulses = 1;
+    return true;
+  }
+
+  if (pulses == 1)
+  {
+    // Seed the period with the first interval, start over if it can't be a clock
+    float interval = (float)(time - filteredTime);
+    filteredTime = time;
+    if (interval < minPeriod || interval > maxPeriod)
+    { return false; }
+    period = interval;
+    pulses = 2;
+    return true;
+  }
+
+  float error = (float)(int64_t)(time - filteredTime) - period;
+  if (std::fabs(error) > period / 2)
+  {
+    // Dropped, doubled or badly late pulse. Keep the grid going, a run of them means the tempo jumped
+    if (++outliers >= CLOCK_FOLLOWER_OUTLIER_LIMIT)
+    {
+      Reset();
+      Update(time);
+      return false;
+    }
+    filteredTime += (uint64_t)period;
+    return false;
+  }
+  outliers = 0;
+
+  // Critically damped loop: b = sqrt(2) * w, c = w^2
+  float omega = 2 * (float)M_PI * (pulses < CLOCK_FOLLOWER_LOCK_PULSES ? CLOCK_FOLLOWER_BANDWIDTH_WIDE : CLOCK_FOLLOWER_BANDWIDTH_NARROW);
+  filteredTime += (int64_t)std::lround(period + (float)M_SQRT2 * omega * error);
+  period = std::min(std::max(period + omega * omega * error, minPeriod), maxPeriod);
+  if (pulses < UINT32_MAX)
+  { pulses++; }
+  return true;
+}
+
+bool ClockFollower::Locked() {
+  return pulses >= 2;
+}
+
+uint64_t ClockFollower::PulseTime() {
+  return filteredTime;
+}
+
+float ClockFollower::Period() {
+  return period;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stdint.h>
+
+#define CLOCK_FOLLOWER_LOCK_PULSES 24 // Pulses tracked with the wide loop before narrowing down to reject jitter
+#define CLOCK_FOLLOWER_BANDWIDTH_WIDE 0.05f // Loop bandwidth while locking, in cycles per pulse
+#define CLOCK_FOLLOWER_BANDWIDTH_NARROW 0.01f // Loop bandwidth once locked
+#define CLOCK_FOLLOWER_OUTLIER_LIMIT 3 // Consecutive pulses off by more than half a period that count as a tempo jump
+
+// Second order delay locked loop, turns jittery pulse timestamps into a smooth pulse grid.
+// Pure math on caller supplied timestamps (us) so it can be driven by a virtual clock.
+class ClockFollower {
+ public:
+  ClockFollower(float minPeriod, float maxPeriod); // Accepted pulse period range in us
+  void Reset();
+  bool Update(uint64_t time); // Feed the arrival time of a pulse, false if it was rejected as an outlier
+  bool Locked(); // Has a period estimate
+  uint64_t PulseTime(); // Filtered time of the latest pulse
+  float Period(); // Filtered us per pulse
+
+ private:
+  float minPeriod;
+  float maxPeriod;
+  uint32_t pulses = 0; // Pulses taken into the loop since Reset
+  uint8_t outliers = 0;
+  uint64_t filteredTime = 0;
+  float period = 0;
+};
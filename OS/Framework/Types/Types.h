@@ -6,6 +6,7 @@
 #include <list>
 #include <map>
 #include <set>
+#include <span>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -25,6 +26,7 @@ using std::multiset;
 using std::priority_queue;
 using std::queue;
 using std::set;
+using std::span;
 using std::stack;
 using std::unordered_map;
 using std::unordered_multimap;
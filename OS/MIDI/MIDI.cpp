@@ -12,11 +12,19 @@ namespace MatrixOS::MIDI
       osPort = new MidiPort("MatrixOS", MIDI_PORT_OS, MIDI_QUEUE_SIZE);
     }
 
-    // Create the application queue if it doesn't exist
-    if (!appQueue) {
-      appQueue = xQueueCreate(MIDI_QUEUE_SIZE, sizeof(MidiPacket));
+    // Divert SysEx to the system, the rest of the traffic goes straight to the application
+    if (!sysExRing) {
+      sysExRing = new MidiRing(MIDI_QUEUE_SIZE);
+      osPort->sysExRing = sysExRing;
     }
 
+    if (!umpMutex) {
+      umpMutex = xSemaphoreCreateMutex();
+    }
+
+    for (SysExContext& context : sysExContexts)
+    { context.buffer.reserve(SYSEX_BUFFER_SIZE); }
+
     // Create the receive task if it doesn't exist
     // Only create task if scheduler is already running (ESP32) or will be started later
     if (!receiveTask && xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED) {
@@ -24,9 +32,9 @@ namespace MatrixOS::MIDI
     }
   }
 
-  bool Get(MidiPacket* midiPacketDest, uint16_t timeout_ms) {
-    if (!appQueue) return false;
-    return xQueueReceive(appQueue, (void*)midiPacketDest, pdMS_TO_TICKS(timeout_ms)) == pdTRUE;
+  bool Get(MidiPacket* midiPacketDest, uint16_t timeout_ms, uint32_t* arrival) {
+    if (!osPort) return false;
+    return osPort->Get(midiPacketDest, timeout_ms, arrival);
   }
 
   bool Send(MidiPacket midiPacket, uint16_t targetPort, uint16_t timeout_ms) {
@@ -34,115 +42,138 @@ namespace MatrixOS::MIDI
     return osPort->Send(midiPacket, targetPort, timeout_ms);
   }
 
-  void ReceiveTask(void* parameters) {
+  bool SendBatch(span<MidiPacket> midiPackets, uint16_t targetPort, uint16_t timeout_ms) {
+    if (!osPort) return false;
+    return osPort->Send(midiPackets, targetPort, timeout_ms);
+  }
 
-    static vector<uint8_t> sysExBuffer;
-    static uint16_t activeSysExPort = MIDI_PORT_INVALID;
-    static SysExState currentSysExState = SysExState::SYSEX_IDLE;
+  bool GetUMP(UMP* umpDest, uint16_t timeout_ms, uint32_t* arrival) {
+    if (!osPort) return false;
 
+    MidiPacket packet;
+    while (umpPendingIndex == umpPendingCount)
+    {
+      if (!osPort->Get(&packet, timeout_ms, arrival))
+      { return false; }
+      umpPendingCount = umpReceive.ToUMP(packet, umpPending);
+      umpPendingIndex = 0;
+      timeout_ms = 0; // SysEx bytes still buffering for the next SysEx7 only wait once
+    }
+    *umpDest = umpPending[umpPendingIndex++];
+    return true;
+  }
+
+  bool SendUMP(const UMP& ump, uint16_t targetPort, uint16_t timeout_ms) {
+    if (!osPort || !umpMutex) return false;
+
+    MidiPacket packets[4];
+    xSemaphoreTake(umpMutex, portMAX_DELAY);
+    uint8_t count = umpSend.FromUMP(ump, packets);
+    xSemaphoreGive(umpMutex);
+
+    if (count == 0)
+    { return ump.Type() == UMP_DATA64; } // SysEx7 bytes wait in the parser for the rest of the message
+    return osPort->Send(span<MidiPacket>(packets, count), targetPort, timeout_ms);
+  }
+
+  void ReceiveTask(void* parameters) {
     MidiPacket packet;
     
     while (true) {
-      // Blocking get from OS port
-      if (osPort && osPort->Get(&packet, portMAX_DELAY)) {
+      // Only SysEx reaches this task, blocking get from the SysEx ring
+      if (sysExRing && sysExRing->Wait(&packet, portMAX_DELAY)) {
         // Process the packet (moved from old Receive function)
         bool shouldForwardToApp = true;
         
-        // Handle SysEx
-        if (packet.SysEx())
+        // Each source port reassembles into its own context so transfers can interleave
+        SysExContext* context = GetSysExContext(packet.port, packet.SysExStart());
+        if (context == nullptr)
         {
-          // Concurrent SysEx, drop the later one -- TODO: Handle this better
-          if (activeSysExPort != MIDI_PORT_INVALID && packet.port != activeSysExPort)
-          {
-            continue; // Skip this packet
-          }
+          continue; // Skip this packet, no transfer in progress on this port or no context left
+        }
+
+        context->lastActivity = MatrixOS::SYS::Millis();
+
+        if(packet.SysExStart())
+        {
+          context->buffer.clear();
+          context->state = SysExState::SYSEX_PENDING;
+        }
 
-          if(packet.SysExStart())
+        if (context->state == SysExState::SYSEX_INVALID)
+        {
+          shouldForwardToApp = false; // Skip this packet
+        }
+        else if (context->state != SysExState::SYSEX_RELEASE)
+        {
+          if (context->buffer.size() + 3 > SYSEX_BUFFER_SIZE)
           {
-            sysExBuffer.reserve(12);
-            sysExBuffer.clear();
-            activeSysExPort = packet.port;
+            MLOGW("MIDI", "SysEx from port %d exceeds %d bytes, dropped", packet.port, SYSEX_BUFFER_SIZE);
+            context->state = SysExState::SYSEX_INVALID;
           }
-          else if (currentSysExState == SysExState::SYSEX_INVALID)
-          {
-            continue; // Skip this packet
-          } 
-
-          if (currentSysExState != SysExState::SYSEX_RELEASE)
+          else
           {
-            sysExBuffer.insert(sysExBuffer.end(), packet.data, packet.data + 3);
-            currentSysExState = ProcessSysEx(packet.port, sysExBuffer, packet.status == SysExEnd); 
-
-            if(packet.status == SysExEnd)
-            {
-              activeSysExPort = MIDI_PORT_INVALID;
-              currentSysExState = SysExState::SYSEX_IDLE;
-            }
-            shouldForwardToApp = false; // System handled this packet
+            context->buffer.insert(context->buffer.end(), packet.data, packet.data + 3);
+            context->state = ProcessSysEx(packet.port, context->buffer, packet.status == SysExEnd);
           }
+          shouldForwardToApp = false; // System handled this packet
         }
 
-        // If current SysEx is the SysexEnd, free up the sysex lock for more sysex.
+        // SysexEnd frees up the context for the next transfer
         if(packet.status == SysExEnd)
         {
-          currentSysExState = SysExState::SYSEX_IDLE;
-          activeSysExPort = MIDI_PORT_INVALID;
+          context->port = MIDI_PORT_INVALID;
+          context->state = SysExState::SYSEX_IDLE;
         }
 
-        // Forward to application queue if not handled by system
-        if (shouldForwardToApp && appQueue) {
-          // Try to send to app queue, drop if full
-          xQueueSend(appQueue, &packet, 0);
+        // Release to the application if not handled by system, counted as a drop if its ring is full
+        if (shouldForwardToApp && !osPort->ring->Push(packet)) {
+          std::atomic_ref<uint32_t>(osPort->dropped).fetch_add(1, std::memory_order_relaxed);
         }
       }
     }
   }
 
-  bool SendSysEx(uint16_t port, uint16_t length, uint8_t* data, bool includeMeta) {
-    if(includeMeta)
+  SysExContext* GetSysExContext(uint16_t port, bool start) {
+    SysExContext* available = nullptr;
+    uint64_t now = MatrixOS::SYS::Millis();
+    for (SysExContext& context : sysExContexts)
     {
-      uint8_t header[6] = {MIDIv1_SYSEX_START, SYSEX_MFG_ID[0], SYSEX_MFG_ID[1], SYSEX_MFG_ID[2], SYSEX_FAMILY_ID[0], SYSEX_FAMILY_ID[1]};
-      if(!Send(MidiPacket(EMidiStatus::SysExData, header[0], header[1], header[2]), port, 5))
-      { return false; }
+      if (context.port == port)
+      { return &context; }
 
-      if(!Send(MidiPacket(EMidiStatus::SysExData, header[3], header[4], header[5]), port, 5))
-      { return false; }
+      if (available == nullptr && (context.port == MIDI_PORT_INVALID || now - context.lastActivity > SYSEX_TIMEOUT))
+      { available = &context; }
     }
 
-    for (uint8_t index = 0; index < length - 3 - !includeMeta; index += 3)
+    if (!start)
+    { return nullptr; }
+
+    if (available == nullptr)
     {
-      if(!Send(MidiPacket(EMidiStatus::SysExData, data[index], data[index+1], data[index+2]), port, 5))
-      { return false; }
+      MLOGW("MIDI", "No SysEx context left for port %d, dropped", port);
+      return nullptr;
     }
 
-    // Send End
-    if(includeMeta)
-    {
-      uint16_t start_ptr = length - length % 3;
-      uint8_t footer[3] = {0, 0, 0};
-      for (uint16_t i = start_ptr; i < length; i++)
-      {
-        footer[i] = data[start_ptr + i];
-      }
-      footer[length % 3] = MIDIv1_SYSEX_END;
+    available->port = port;
+    available->state = SysExState::SYSEX_IDLE;
+    available->buffer.clear();
+    return available;
+  }
 
-      if(!Send(MidiPacket(EMidiStatus::SysExEnd, footer[0], footer[1], footer[2]), port, 5))
-      { return false;}
-     }
-    else
-    {
-      uint8_t end_frame_length = ((length - 1) % 3 + 1);
-      uint16_t start_ptr = length - end_frame_length;
-      uint8_t footer[3] = {0, 0, 0};
-      for (uint16_t i = 0; i < end_frame_length; i++)
-      {
-        footer[i] = data[start_ptr + i];
-      }
+  bool SendSysEx(uint16_t port, uint16_t length, uint8_t* data, bool includeMeta) {
+    if (!osPort) return false;
 
-      if(!Send(MidiPacket(EMidiStatus::SysExEnd, footer[0], footer[1], footer[2]), port, 5))
-      { return false; }
-    }
-    return true;
+    // Whole message goes to the transports in one piece, they stream it out as fast as the link allows
+    if (!includeMeta)
+    { return osPort->SendSysEx(span<const uint8_t>(data, length), port, SYSEX_SEND_TIMEOUT); }
+
+    vector<uint8_t> message;
+    message.reserve(length + 7);
+    message.insert(message.end(), {MIDIv1_SYSEX_START, SYSEX_MFG_ID[0], SYSEX_MFG_ID[1], SYSEX_MFG_ID[2], SYSEX_FAMILY_ID[0], SYSEX_FAMILY_ID[1]});
+    message.insert(message.end(), data, data + length);
+    message.push_back(MIDIv1_SYSEX_END);
+    return osPort->SendSysEx(message, port, SYSEX_SEND_TIMEOUT);
   }
 
 
@@ -1,7 +1,9 @@
 #include "MidiPort.h"
 #include "MidiPacket.h"
+#include "UMP.h"
 #include "FreeRTOS.h"
 #include "queue.h"
+#include "semphr.h"
 #include "task.h"
 
 // TODO Put this in device layer
@@ -17,18 +19,38 @@ enum SysExState : uint8_t {
   SYSEX_INVALID   // This is our SysEx, don't release, just destroy it
 };
 
+struct SysExContext {
+  uint16_t port = MIDI_PORT_INVALID; // Source port that owns this context, MIDI_PORT_INVALID when free
+  SysExState state = SysExState::SYSEX_IDLE;
+  uint64_t lastActivity = 0;
+  vector<uint8_t> buffer; // Reserved to SYSEX_BUFFER_SIZE once, never grows past it
+};
+
 namespace MatrixOS::MIDI
   {
     inline MidiPort* osPort = nullptr;
-    inline QueueHandle_t appQueue = nullptr;
+    inline MidiRing* sysExRing = nullptr; // SysEx goes through ReceiveTask, everything else lands in osPort's ring for the app directly
     inline TaskHandle_t receiveTask = nullptr;
+    inline SysExContext sysExContexts[SYSEX_CONTEXT_COUNT];
+
+    // Every transport is MIDI 1.0, so UMP is translated here at the OS port edge
+    inline UMPTranslator umpSend; // Shared by every sending task, under umpMutex
+    inline SemaphoreHandle_t umpMutex = nullptr;
+    inline UMPTranslator umpReceive; // Only the application task reads the OS port
+    inline UMP umpPending[2]; // A SysEx packet can complete two SysEx7 packets at once
+    inline uint8_t umpPendingCount = 0;
+    inline uint8_t umpPendingIndex = 0;
 
     void Init(void);
     void ReceiveTask(void* parameters);
+    SysExContext* GetSysExContext(uint16_t port, bool start); // Find the context of a port, or claim a free / timed out one on SysEx start
 
-    bool Get(MidiPacket* midiPacketDest, uint16_t timeout_ms);
+    bool Get(MidiPacket* midiPacketDest, uint16_t timeout_ms, uint32_t* arrival);
     bool Send(MidiPacket midiPacket, uint16_t targetPort, uint16_t timeout_ms);
+    bool SendBatch(span<MidiPacket> midiPackets, uint16_t targetPort, uint16_t timeout_ms);
     bool SendSysEx(uint16_t port, uint16_t length, uint8_t* data, bool includeMeta);  // If include meta, it will send the correct header and ending;
+    bool GetUMP(UMP* umpDest, uint16_t timeout_ms, uint32_t* arrival);
+    bool SendUMP(const UMP& ump, uint16_t targetPort, uint16_t timeout_ms);
     void HandleMatrixOSSysEx(uint16_t port, vector<uint8_t>& sysExBuffer);
     SysExState ProcessSysEx(uint16_t port, vector<uint8_t>& sysExBuffer, bool complete);
   }
\ No newline at end of file
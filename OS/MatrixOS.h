@@ -98,9 +98,37 @@ namespace MatrixOS
 
   namespace MIDI
   {
-    bool Get(MidiPacket* midiPacketDest, uint16_t timeout_ms = 0);
+    bool Get(MidiPacket* midiPacketDest, uint16_t timeout_ms = 0, uint32_t* arrival = nullptr); // arrival gets SYS::Micros() (lower 32 bits) from when the packet reached the OS
     bool Send(MidiPacket midiPacket, uint16_t targetPort = MIDI_PORT_EACH_CLASS, uint16_t timeout_ms = 0);
+    bool SendBatch(span<MidiPacket> midiPackets, uint16_t targetPort = MIDI_PORT_EACH_CLASS, uint16_t timeout_ms = 0); // Route a burst (chords, downbeats) in one pass
     bool SendSysEx(uint16_t port, uint16_t length, uint8_t* data, bool includeMeta = true);  // If include meta, it will send the correct header and ending;
+    bool GetUMP(UMP* umpDest, uint16_t timeout_ms = 0, uint32_t* arrival = nullptr); // Incoming MIDI 1.0 as MIDI 2.0 protocol UMP
+    bool SendUMP(const UMP& ump, uint16_t targetPort = MIDI_PORT_EACH_CLASS, uint16_t timeout_ms = 0); // Scaled down to MIDI 1.0 for the transports, false if it has no MIDI 1.0 form
+  }
+
+  namespace Clock
+  {
+    enum ClockSource : uint8_t { CLOCK_SOURCE_INTERNAL, CLOCK_SOURCE_EXTERNAL };
+    typedef void (*TickCallback)(uint32_t tick, uint64_t time, void* context); // Runs on the clock task at the tick's time (us), keep it short
+
+    void SetSource(ClockSource source);
+    ClockSource GetSource();
+    void SetBPM(float bpm); // Internal tempo
+    float GetBPM(); // Current tempo, the smoothed estimate while following an external clock
+    bool Locked(); // Following an external clock right now
+    bool Running(); // False after an external Stop, until Start or Continue
+    void Reset(); // Back to position 0, every subscriber restarts from tick 0
+    uint64_t Position(); // Quarter notes since position 0, 32.32 fixed point
+    void EnableOutput(bool enable); // Send 24 PPQN MIDI clock to all ports
+    bool OutputEnabled();
+
+    int8_t Subscribe(uint16_t ppqn, TickCallback callback = nullptr, void* context = nullptr); // Returns a handle, -1 if no slot is left
+    void Unsubscribe(int8_t handle);
+    uint32_t Ticks(int8_t handle, uint64_t* lastTickTime = nullptr); // Ticks since the last call, for apps polling from their own loop
+    void SetSwing(int8_t handle, uint16_t stepTicks, float swing); // Every other step of stepTicks ticks runs long by swing (-0.5 to 0.5), the one after short by as much
+    void Restart(int8_t handle, uint64_t position, uint32_t phase = 0); // Tick 0 fires at position and none before it, swing carries on as if phase ticks had passed
+    void SetLead(int8_t handle, uint32_t lead_us); // Fire ticks lead_us early, for work that has to be ready by the tick. The callback still gets the tick's own time
+    void SetSkipLate(int8_t handle, bool skip); // Drop ticks that fell more than a quarter note behind instead of firing them back to back. Off by default, pulse counters need every tick
   }
 
   namespace HID
@@ -37,6 +37,14 @@
 
 #define KEYEVENT_QUEUE_SIZE 16
 #define MIDI_QUEUE_SIZE 128
+#define SYSEX_CONTEXT_COUNT 4 // SysEx transfers that can be reassembled at the same time, one per source port
+#define SYSEX_BUFFER_SIZE 256 // Longest SysEx the system will buffer for parsing
+#define SYSEX_TIMEOUT 1000 // A stalled SysEx gives up its context after this many ms
+#define SYSEX_SEND_TIMEOUT 100 // How long an outgoing SysEx may wait on a transport without making progress
+#define CLOCK_SUBSCRIBER_COUNT 8 // Tick subscriptions the clock service can hold, MIDI clock output takes one
+#define CLOCK_BPM_MIN 20
+#define CLOCK_BPM_MAX 300
+#define CLOCK_EXTERNAL_TIMEOUT 500 // ms without an incoming clock before the follower lets go
 
 inline const uint16_t hold_threshold = 400;
 
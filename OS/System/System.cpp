@@ -9,6 +9,7 @@
 #include "../FileSystem/File.h"
 #include "../FileSystem/FileSystem.h"
 #include "../MIDI/MIDI.h"
+#include "../Clock/Clock.h"
 #include "task.h"
 
 extern std::unordered_map<uint32_t, Application_Info*> applications;
@@ -162,6 +163,7 @@ namespace MatrixOS::SYS
 #endif
     MatrixOS::USB::SetMode(USB_MODE_NORMAL);
     MatrixOS::MIDI::Init();
+    MatrixOS::Clock::Init();
     MatrixOS::HID::Init();
   }
 
@@ -19,17 +19,80 @@ namespace MatrixOS::USB::MIDI
   void portTask(void* param) {
     uint8_t itf = (uint8_t)(uintptr_t)param;
     MidiPacket packet;
+    uint8_t stream[USB_MIDI_BATCH_SIZE * 3];
     while (true)
     {
       if (ports[itf].Get(&packet, portMAX_DELAY))
       { 
+        // Drain whatever else is already queued so a burst goes out under one lock and one flush
+        uint16_t length = 0;
+        uint8_t count = 0;
+        do
+        {
+          uint8_t packetLength = packet.Length();
+          memcpy(stream + length, packet.data, packetLength);
+          length += packetLength;
+          count++;
+        } while (count < USB_MIDI_BATCH_SIZE && ports[itf].Get(&packet, 0));
+
+        // The endpoint FIFO may take only part of the batch, keep feeding it until the host drains the rest
+        uint8_t cable = ports[itf].id % 0x100;
+        uint16_t written = 0;
+        uint64_t lastProgress = MatrixOS::SYS::Millis();
         if (usbMidiMutex) { xSemaphoreTake(usbMidiMutex, portMAX_DELAY); }
-        tud_midi_stream_write(ports[itf].id % 0x100, packet.data, packet.Length()); 
+        while (written < length && tud_mounted())
+        {
+          uint32_t sent = tud_midi_stream_write(cable, stream + written, length - written);
+          if (sent > 0)
+          {
+            written += sent;
+            lastProgress = MatrixOS::SYS::Millis();
+          }
+          else if (MatrixOS::SYS::Millis() - lastProgress > USB_MIDI_WRITE_TIMEOUT)
+          { break; } // Host isn't reading, drop the rest rather than stall every port
+          else
+          { vTaskDelay(1); } // FIFO full, let the host drain it
+        }
         if (usbMidiMutex) { xSemaphoreGive(usbMidiMutex); }
       }
     }
   }
 
+  bool WriteSysEx(MidiPort* port, span<const uint8_t> data, uint32_t timeout_ms) {
+    if (!tud_mounted())
+    { return false; }
+
+    // TinyUSB packs the byte stream into 4 byte CIN SysEx packets and fills the endpoint FIFO in bulk.
+    // Hold the lock for the whole message so no other packet lands in the middle of it.
+    uint8_t cable = port->id % 0x100;
+    uint32_t written = 0;
+    if (usbMidiMutex && xSemaphoreTake(usbMidiMutex, pdMS_TO_TICKS(timeout_ms)) != pdTRUE)
+    { return false; }
+    uint64_t lastProgress = MatrixOS::SYS::Millis();
+    while (written < data.size())
+    {
+      uint32_t count = tud_midi_stream_write(cable, data.data() + written, data.size() - written);
+      if (count > 0)
+      {
+        written += count;
+        lastProgress = MatrixOS::SYS::Millis();
+      }
+      else if (MatrixOS::SYS::Millis() - lastProgress > timeout_ms)
+      { break; }
+      else
+      { vTaskDelay(1); } // FIFO full, let the host drain it
+    }
+
+    if (written < data.size())
+    {
+      // Gave up part way, terminate the message so the host's parser doesn't stay stuck in SysEx
+      uint8_t end = MIDIv1_SYSEX_END;
+      tud_midi_stream_write(cable, &end, 1);
+    }
+    if (usbMidiMutex) { xSemaphoreGive(usbMidiMutex); }
+    return written == data.size();
+  }
+
   void Init() {
     for (TaskHandle_t portTask : portTasks)
     {
@@ -52,6 +115,7 @@ namespace MatrixOS::USB::MIDI
     {
       string portname = "USB MIDI " + std::to_string(i + 1);
       ports.emplace_back(portname, MIDI_PORT_USB + i);
+      ports.back().sysExWriter = WriteSysEx;
 
       portTasks.push_back(NULL);
       portTaskNames.push_back(portname);
@@ -66,7 +130,7 @@ void tud_midi_rx_cb(uint8_t itf) {
   while (tud_midi_n_packet_read(itf, raw_packet))
   {
     uint16_t port = MIDI_PORT_USB + (raw_packet[0] >> 4);
-    MidiPacket packet = MidiPacket(EMidiStatus::None);
+    MidiPacket packet;
     raw_packet[0] &= 0x0F;
     switch (raw_packet[0])
     {
@@ -137,12 +201,12 @@ void tud_midi_rx_cb(uint8_t itf) {
         }
         break;
       case CIN_SYSEX:
-        packet = MidiPacket(EMidiStatus::SysExData, raw_packet[1], raw_packet[2], raw_packet[3]);
+        packet = MidiPacket::SysExData(raw_packet[1], raw_packet[2], raw_packet[3]);
         break;
       case CIN_SYSEX_ENDS_IN_1:
       case CIN_SYSEX_ENDS_IN_2:
       case CIN_SYSEX_ENDS_IN_3:
-        packet = MidiPacket(EMidiStatus::SysExEnd, raw_packet[1], raw_packet[2], raw_packet[3]);
+        packet = MidiPacket::SysExEnd(raw_packet[1], raw_packet[2], raw_packet[3]);
         break;
       default: 
         return;
@@ -3,6 +3,8 @@
 #include <stdint.h>
 
 #define USB_MIDI_COUNT 2
+#define USB_MIDI_BATCH_SIZE 16 // Max packets drained from a port queue into a single USB write
+#define USB_MIDI_WRITE_TIMEOUT 100 // ms a batch may wait on a full endpoint FIFO before the rest is dropped
 
 // USB mode definitions
 enum USB_MODE {
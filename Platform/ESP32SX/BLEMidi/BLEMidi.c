@@ -83,8 +83,6 @@ static uint8_t blemidi_outbuffer[BLEMIDI_NUM_PORTS][GATTS_MIDI_CHAR_VAL_LEN_MAX]
 static uint16_t blemidi_outbuffer_len[BLEMIDI_NUM_PORTS];
 static uint16_t blemidi_outbuffer_timestamp_last_flush = 0;
 
-// to handled continued SysEx
-static size_t blemidi_continued_sysex_pos[BLEMIDI_NUM_PORTS];
 
 /* Attributes State Machine */
 enum {
@@ -204,9 +202,10 @@ static StaticTimer_t tickTimer;
 static TimerHandle_t tickTimerHandle;
 
 static bool blemidi_connected = false;
+// set by the stack while its notification queue for the link is full
+static volatile bool blemidi_congested = false;
 
-void (*blemidi_callback_midi_message_received)(uint8_t blemidi_port, uint16_t timestamp, uint8_t midi_status,
-                                               uint8_t* remaining_message, size_t len, size_t continued_sysex_pos);
+void (*blemidi_callback_packet_received)(uint8_t blemidi_port, uint8_t* packet, size_t len);
 
 /*
 From ESP-IDF examples/bluetooth/bluedroid/ble/gatt_security_server/main/example_ble_sec_gatts_demo.c
@@ -396,79 +395,39 @@ int32_t blemidi_send_message(uint8_t blemidi_port, uint8_t* stream, size_t len)
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-// For internal usage only: receives a BLE MIDI packet and calls the specified callback function.
-// The user will specify this callback while calling blemidi_init()
+// Sends an already formatted BLE MIDI packet (header, timestamps and messages) as one notification
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-static int32_t blemidi_receive_packet(uint8_t blemidi_port, uint8_t* stream, size_t len,
-                                      void* _callback_midi_message_received) {
-  void (*callback_midi_message_received)(uint8_t blemidi_port, uint16_t timestamp, uint8_t midi_status,
-                                         uint8_t * remaining_message, size_t len, size_t continued_sysex_pos) =
-      _callback_midi_message_received;
-
-  if (len < 3)
-  {
-    ESP_LOGD(BLEMIDI_TAG, "Invalid packet (len < 3)");
-    return -1;
-  }
-
-  if ((!(stream[0] & 0b10000000)) || (!(stream[1] & 0b10000000)))
-  {
-    ESP_LOGD(BLEMIDI_TAG, "Invalid packet");
-    return -1;
-  }
-
-  uint8_t currentTimestamp = ((stream[0] & 0b111111) << 7);
-
-  uint8_t* ptr = &stream[1];
+esp_err_t blemidi_send_packet(uint8_t blemidi_port, uint8_t* packet, size_t len) {
+  if (!blemidi_connected)
+    return ESP_ERR_INVALID_STATE;
 
-  uint8_t runningStatus = 0;
+  if (blemidi_port >= BLEMIDI_NUM_PORTS || len > blemidi_mtu)
+    return ESP_ERR_INVALID_ARG;
 
-  while (ptr - stream < len)
-  {
-    if (ptr[0] & 0b10000000)
-    {
-      currentTimestamp = (currentTimestamp & 0b1111110000000) | (ptr[0] & 0b1111111);
-      ptr++;
-    }
+  // the stack would drop it, let the caller hold on to it until the link drains
+  if (blemidi_congested)
+    return ESP_FAIL;
 
-    if (ptr[0] & 0b10000000)
-    {  // Full midi message
-      runningStatus = *ptr;
-      ptr++;
-    }
+  // keep ordering with anything still waiting in the output buffer
+  blemidi_outbuffer_flush(blemidi_port);
 
-    uint8_t command = runningStatus >> 4;
-    // uint8_t channel = runningStatus & 0b1111;
+  return esp_ble_gatts_send_indicate(midi_profile_tab[PROFILE_APP_IDX].gatts_if, midi_profile_tab[PROFILE_APP_IDX].conn_id,
+                                     midi_handle_table[IDX_CHAR_VAL_A], len, packet, false);
+}
 
-    if (command == 0)
-    {
-      ESP_LOGD(BLEMIDI_TAG, "Invalid packet : a running status message must be preceded by a full midi message");
-      return -1;
-    }
-    else if (command == 0b11111111)
-    {
-      ESP_LOGD(BLEMIDI_TAG, "System common message, not implemented yet");
-      return -1;
-    }
-    else
-    {
-      callback_midi_message_received(0, currentTimestamp, runningStatus, ptr, 2, 0);
-      ptr += 2;
-    }
-  }
-  return 0;  // no error
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Returns the usable payload size of a notification
+////////////////////////////////////////////////////////////////////////////////////////////////////
+size_t blemidi_get_mtu(void) {
+  return blemidi_mtu;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // Dummy callback for demo and debugging purposes
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-void blemidi_receive_packet_callback_for_debugging(uint8_t blemidi_port, uint16_t timestamp, uint8_t midi_status,
-                                                   uint8_t* remaining_message, size_t len, size_t continued_sysex_pos) {
-  ESP_LOGI(BLEMIDI_TAG,
-           "receive_packet CALLBACK blemidi_port=%d, timestamp=%d, midi_status=0x%02x, len=%d, continued_sysex_pos=%d, "
-           "remaining_message:",
-           blemidi_port, timestamp, midi_status, len, continued_sysex_pos);
-  esp_log_buffer_hex(BLEMIDI_TAG, remaining_message, len);
+void blemidi_receive_packet_callback_for_debugging(uint8_t blemidi_port, uint8_t* packet, size_t len) {
+  ESP_LOGI(BLEMIDI_TAG, "receive_packet CALLBACK blemidi_port=%d, len=%d, packet:", blemidi_port, len);
+  esp_log_buffer_hex(BLEMIDI_TAG, packet, len);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -617,7 +576,12 @@ static void blemidi_prepare_write_event_env(esp_gatt_if_t gatts_if, prepare_type
 
 static void blemidi_exec_write_event_env(prepare_type_env_t* prepare_write_env, esp_ble_gatts_cb_param_t* param) {
   if (param->exec_write.exec_write_flag == ESP_GATT_PREP_WRITE_EXEC && prepare_write_env->prepare_buf)
-  { esp_log_buffer_hex(BLEMIDI_TAG, prepare_write_env->prepare_buf, prepare_write_env->prepare_len); }
+  {
+    esp_log_buffer_hex(BLEMIDI_TAG, prepare_write_env->prepare_buf, prepare_write_env->prepare_len);
+    // a long write is one BLE MIDI packet too
+    if (blemidi_callback_packet_received)
+    { blemidi_callback_packet_received(0, prepare_write_env->prepare_buf, prepare_write_env->prepare_len); }
+  }
   else
   { ESP_LOGI(BLEMIDI_TAG, "ESP_GATT_PREP_WRITE_CANCEL"); }
   if (prepare_write_env->prepare_buf)
@@ -665,7 +629,8 @@ static void gatts_profile_event_handler(esp_gatts_cb_event_t event, esp_gatt_if_
           // the data length of gattc write  must be less than blemidi_mtu.
           // ESP_LOGI(BLEMIDI_TAG, "GATT_WRITE_EVT, handle = %d, value len = %d, value :", param->write.handle,
           // param->write.len); esp_log_buffer_hex(BLEMIDI_TAG, param->write.value, param->write.len);
-          blemidi_receive_packet(0, param->write.value, param->write.len, blemidi_callback_midi_message_received);
+          if (blemidi_callback_packet_received)
+          { blemidi_callback_packet_received(0, param->write.value, param->write.len); }
         }
       }
       else
@@ -720,12 +685,14 @@ static void gatts_profile_event_handler(esp_gatts_cb_event_t event, esp_gatt_if_
       esp_ble_gap_update_conn_params(&conn_params);
 
       blemidi_connected = true;
+      blemidi_congested = false;
       ESP_LOGI(BLEMIDI_TAG, "blemidi_connected status: %d", blemidi_connected);
       break;
     case ESP_GATTS_DISCONNECT_EVT:
       ESP_LOGI(BLEMIDI_TAG, "ESP_GATTS_DISCONNECT_EVT, reason = 0x%x", param->disconnect.reason);
       esp_ble_gap_start_advertising(&adv_params);
       blemidi_connected = false;
+      blemidi_congested = false;
       break;
     case ESP_GATTS_CREAT_ATTR_TAB_EVT:
     {
@@ -747,12 +714,15 @@ static void gatts_profile_event_handler(esp_gatts_cb_event_t event, esp_gatt_if_
       }
       break;
     }
+    case ESP_GATTS_CONGEST_EVT:
+      ESP_LOGD(BLEMIDI_TAG, "ESP_GATTS_CONGEST_EVT, congested = %d", param->congest.congested);
+      blemidi_congested = param->congest.congested;
+      break;
     case ESP_GATTS_STOP_EVT:
     case ESP_GATTS_OPEN_EVT:
     case ESP_GATTS_CANCEL_OPEN_EVT:
     case ESP_GATTS_CLOSE_EVT:
     case ESP_GATTS_LISTEN_EVT:
-    case ESP_GATTS_CONGEST_EVT:
     case ESP_GATTS_UNREG_EVT:
     case ESP_GATTS_DELETE_EVT:
     default:
@@ -821,11 +791,11 @@ static void gatts_event_handler(esp_gatts_cb_event_t event, esp_gatt_if_t gatts_
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // Initializes the BLE MIDI Server
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-int32_t blemidi_init(void* _callback_midi_message_received, const char* name) {
+int32_t blemidi_init(void* _callback_packet_received, const char* name) {
   esp_err_t ret;
 
   // callback will be installed if driver was booted successfully
-  blemidi_callback_midi_message_received = NULL;
+  blemidi_callback_packet_received = NULL;
   blemidi_name = name;
   blemidi_connected = false;
 
@@ -906,7 +876,6 @@ int32_t blemidi_init(void* _callback_midi_message_received, const char* name) {
     for (blemidi_port = 0; blemidi_port < BLEMIDI_NUM_PORTS; ++blemidi_port)
     {
       blemidi_outbuffer_len[blemidi_port] = 0;
-      blemidi_continued_sysex_pos[blemidi_port] = 0;
     }
   }
 
@@ -916,7 +885,7 @@ int32_t blemidi_init(void* _callback_midi_message_received, const char* name) {
   xTimerStart(tickTimerHandle, 0);
 
   // Finally install callback
-  blemidi_callback_midi_message_received = _callback_midi_message_received;
+  blemidi_callback_packet_received = _callback_packet_received;
 
   esp_log_level_set(BLEMIDI_TAG, ESP_LOG_NONE);  // can be changed with the "blemidi_debug on" console command
 
@@ -38,6 +38,7 @@ extern "C" {
 #endif
 
 #include <stdint.h>
+#include "esp_err.h"
 
 #ifndef BLEMIDI_DEVICE_NAME
 #define BLEMIDI_DEVICE_NAME "Matrix OS"
@@ -64,11 +65,11 @@ extern "C" {
 /**
  * @brief Initializes the BLEMIDI Server
  *
- * @param  callback_midi_message_received References the callback function which is called whenever a new MIDI message
- * has been received. API see blemidi_receive_packet_callback_for_debugging Specify NULL if no callback required in your
- * application.
+ * @param  callback_packet_received References the callback function which is called whenever a BLE MIDI packet
+ * has been received. The packet is passed on as is (header, timestamps and messages), decoding is up to the application.
+ * API see blemidi_receive_packet_callback_for_debugging Specify NULL if no callback required in your application.
  */
-extern int32_t blemidi_init(void* callback_midi_message_received, const char* name);
+extern int32_t blemidi_init(void* callback_packet_received, const char* name);
 
 /**
  * @brief Deinitializes the BLEMIDI Server
@@ -99,24 +100,34 @@ extern int32_t blemidi_send_message(uint8_t blemidi_port, uint8_t* stream, size_
  */
 extern int32_t blemidi_outbuffer_flush(uint8_t blemidi_port);
 
+/**
+ * @brief Sends an already formatted BLE MIDI packet as one notification
+ *
+ * @param  blemidi_port currently always 0 expected (we might support multiple ports in future)
+ * @param  packet       header byte, timestamps and messages
+ * @param  len          packet length, must not exceed blemidi_get_mtu()
+ *
+ * @return ESP_OK once queued, ESP_FAIL while the link is congested (retry later),
+ *         ESP_ERR_INVALID_STATE when not connected, ESP_ERR_INVALID_ARG on a bad port or length
+ *
+ */
+extern esp_err_t blemidi_send_packet(uint8_t blemidi_port, uint8_t* packet, size_t len);
+
+/**
+ * @brief Returns the usable payload size of a notification (negotiated MTU - 3)
+ */
+extern size_t blemidi_get_mtu(void);
+
 /**
  * @brief A dummy callback which demonstrates the usage.
- *        It will just print out incoming MIDI messages on the terminal.
+ *        It will just print out incoming BLE MIDI packets on the terminal.
  *        You might want to implement your own for doing something more useful!
 
  * @param  blemidi_port currently always 0 expected (we might support multiple ports in future)
- * @param  timestamp    the timestamp
- * @param  midi_status  the MIDI status byte (first byte of a MIDI message)
- * @param  remaining_message the remaining bytes
- * @param  len          size of the remaining message
- * @param  continued_sysex_pos in case the next part of a SysEx stream has been received, this variable is >0 and passes
- the position of the continued sysex stream
- *
- * @return < 0 on errors
+ * @param  packet       the raw BLE MIDI packet
+ * @param  len          size of the packet
  */
-extern void blemidi_receive_packet_callback_for_debugging(uint8_t blemidi_port, uint16_t timestamp, uint8_t midi_status,
-                                                          uint8_t* remaining_message, size_t len,
-                                                          size_t continued_sysex_pos);
+extern void blemidi_receive_packet_callback_for_debugging(uint8_t blemidi_port, uint8_t* packet, size_t len);
 
 /**
  * @brief This function should be called each mS to update the timestamp and flush the output buffer